@@ -0,0 +1,166 @@
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Onset detection and tempo / beat phase tracking for the audioreactive usermod
+ *
+ * Runs once per FFT cycle on the magnitudes already computed (no extra FFT):
+ * - onset strength: spectral flux of log compressed magnitudes, minus its running average
+ * - tempo: autocorrelation of the last few seconds of onset strength, weighted towards 120 BPM
+ *   (avoids locking to half or double tempo), a new tempo has to persist before it is taken over
+ * - beat phase: an oscillator running at the tempo, pulled towards the beat grid that best fits
+ *   the recent onsets (comb filter over the last BEAT_COMB beats)
+ * Results: bpm(), phase() (0..1, 0 = on the beat) and confidence() (0..255).
+ */
+
+#define BEAT_HISTORY   256     // onset strength history (frames, ~6s at 43 frames/s)
+#define BEAT_UPDATE    8       // frames between tempo updates
+#define BEAT_MIN_BPM   60
+#define BEAT_MAX_BPM   200
+#define BEAT_COMB      4       // beats used for phase estimation
+#define BEAT_PHASE_K   0.25f   // phase correction per update
+#define BEAT_SWITCH    3       // updates a different tempo has to persist
+#define BEAT_HARMONICS 4       // multiples of the beat period scored
+
+template<uint16_t BINS>
+class BeatTracker {
+  public:
+    // frameRate: FFT cycles per second
+    void init(float frameRate) {
+      memset(this, 0, sizeof(*this));
+      fps = frameRate;
+      minLag = floorf(60.0f * fps / BEAT_MAX_BPM);
+      maxLag = ceilf(60.0f * fps / BEAT_MIN_BPM);
+      if (maxLag >= BEAT_HISTORY / 2) maxLag = BEAT_HISTORY / 2 - 1;
+      period = 60.0f * fps / 120.0f;
+    }
+
+    // mag: magnitudes of this FFT cycle, bins from..to are used
+    void process(const float *mag, uint16_t from, uint16_t to) {
+      if (to >= BINS) to = BINS - 1;
+      float flux = 0.0f;
+      for (size_t i = from; i <= to; i++) {
+        float c = logf(1.0f + mag[i]);
+        float d = c - prev[i];
+        if (d > 0.0f) flux += d;
+        prev[i] = c;
+      }
+      fluxAvg += (flux - fluxAvg) * 0.05f;          // ~0.5s
+      float o = flux - fluxAvg;
+      onset[head] = o > 0.0f ? o : 0.0f;
+      head = (head + 1) % BEAT_HISTORY;
+      if (frames < BEAT_HISTORY) frames++;
+
+      // beat oscillator
+      beatPos += 1.0f;
+      if (beatPos >= period) beatPos -= period;
+
+      if (++sinceUpdate >= BEAT_UPDATE && frames >= 2 * maxLag) {
+        sinceUpdate = 0;
+        updateTempo();
+        updatePhase();
+      }
+    }
+
+    float   bpm() const        { return 60.0f * fps / period; }
+    float   phase() const      { return beatPos / period; }
+    uint8_t confidence() const { return conf; }
+
+  private:
+    inline float onsetAt(int age) const {           // age 0: newest
+      return onset[(head + BEAT_HISTORY - 1 - age) % BEAT_HISTORY];
+    }
+
+    // autocorrelation at a fractional lag
+    inline float acfAt(float lag) const {
+      int i = lag;
+      float f = lag - i;
+      return acf[i] + (acf[i+1] - acf[i]) * f;
+    }
+
+    void updateTempo() {
+      const int n = frames;
+      float energy = 0.0f;
+      for (int i = 0; i < n; i++) energy += onsetAt(i) * onsetAt(i);
+      if (energy <= 1e-6f) { conf = conf * 7 / 8; return; }
+      energy /= n;
+
+      const int maxAcf = n - 1 < BEAT_HARMONICS * maxLag + 1 ? n - 1 : BEAT_HARMONICS * maxLag + 1;
+      for (int lag = 0; lag <= maxAcf; lag++) {
+        float s = 0.0f;
+        for (int i = 0; i + lag < n; i++) s += onsetAt(i) * onsetAt(i + lag);
+        acf[lag] = s / float(n - lag);
+      }
+
+      // a beat period also correlates at its multiples, which gives sub-frame resolution and
+      // favours it over a period of half a beat (off-beats), half or double tempo is left to the prior
+      const float lag120 = 60.0f * fps / 120.0f;
+      float lag = 0.0f, bestScore = 0.0f, bestAcf = 0.0f;
+      for (float l = minLag; l <= maxLag; l += 0.25f) {
+        float s = 0.0f;
+        int k = 1;
+        for (; k <= BEAT_HARMONICS && k * l + 1 <= maxAcf; k++) s += acfAt(k * l);
+        s /= k - 1;
+        s += 0.5f * acfAt(0.5f * l);                 // binary subdivision (off-beats), keeps it from locking to 2/3 or 3/2 of the tempo
+        float oct = log2f(l / lag120);
+        float score = s * expf(-0.5f * oct * oct);  // tempo prior: log gaussian around 120 BPM, 1 octave
+        if (score > bestScore) { bestScore = score; lag = l; bestAcf = s; }
+      }
+      if (lag <= 0.0f) return;
+
+      // normalized autocorrelation at the beat period
+      float r = bestAcf / energy;
+      conf = r >= 1.0f ? 255 : (r <= 0.0f ? 0 : uint8_t(r * 255.0f));
+
+      if (fabsf(lag - period) < 0.05f * period) {
+        period += (lag - period) * 0.25f;            // same tempo, follow slowly
+        switchCnt = 0;
+      } else if (switchCnt && fabsf(lag - candidate) < 0.05f * candidate) {
+        if (++switchCnt >= BEAT_SWITCH) {            // new tempo confirmed
+          beatPos *= lag / period;
+          period = lag;
+          switchCnt = 0;
+        }
+      } else {
+        candidate = lag;
+        switchCnt = 1;
+      }
+    }
+
+    // pulls the oscillator towards the beat grid that matches the recent onsets best
+    void updatePhase() {
+      const int p = int(period + 0.5f);
+      if (p < 1 || BEAT_COMB * period >= frames) return;
+      int best = 0;
+      float bestScore = -1.0f;
+      for (int d = 0; d < p; d++) {                  // last beat d frames ago
+        float s = 0.0f;
+        for (int k = 0; k < BEAT_COMB; k++) s += onsetAt(d + int(k * period + 0.5f));
+        if (s > bestScore) { bestScore = s; best = d; }
+      }
+      float err = float(best) - beatPos;
+      if (err >  0.5f * period) err -= period;
+      if (err < -0.5f * period) err += period;
+      beatPos += err * BEAT_PHASE_K;
+      if (beatPos < 0.0f)    beatPos += period;
+      if (beatPos >= period) beatPos -= period;
+    }
+
+    float    prev[BINS];                             // last compressed magnitudes
+    float    onset[BEAT_HISTORY];                    // onset strength ring
+    float    acf[BEAT_HISTORY];                // autocorrelation by lag (not on the stack, FFT task stack is small)
+    float    fluxAvg;
+    float    fps;
+    float    period;                                 // frames per beat
+    float    beatPos;                                // frames since last beat
+    float    candidate;                              // tempo waiting for confirmation
+    uint16_t head;
+    uint16_t frames;
+    uint8_t  minLag, maxLag;
+    uint8_t  sinceUpdate;
+    uint8_t  switchCnt;
+    uint8_t  conf;
+};
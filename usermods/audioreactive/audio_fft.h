@@ -0,0 +1,152 @@
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Built-in spectrum engine for the audioreactive usermod (-D UM_AUDIOREACTIVE_USE_RFFT)
+ *
+ * Gives the same magnitudes as arduinoFFT DC removal + "Flat Top" windowing + compute() + complexToMagnitude(),
+ * but takes advantage of the input being real: the N samples are transformed as a complex sequence of N/2
+ * (even samples as real, odd samples as imaginary part) and separated afterwards, which is half the work.
+ * Window, twiddle factors and bit reversal order are computed once in init().
+ * ESP32-S2 and ESP32-C3 have no FPU, soft float is very slow there so these use a fixed point path
+ * (Q15 window and twiddles, 32 bit data). Define RFFT_FIXED_POINT 0 or 1 to override.
+ */
+
+#ifndef RFFT_FIXED_POINT
+  #if defined(CONFIG_IDF_TARGET_ESP32S2) || defined(CONFIG_IDF_TARGET_ESP32C3)
+    #define RFFT_FIXED_POINT 1
+  #else
+    #define RFFT_FIXED_POINT 0
+  #endif
+#endif
+
+template<uint16_t N>
+class RealFFT {
+  static_assert(N >= 16 && (N & (N - 1)) == 0, "FFT size must be a power of 2");
+  static constexpr uint16_t M = N / 2;   // complex FFT length
+
+  public:
+    void init() {
+      for (size_t i = 0; i < N/2; i++) {  // window is symmetric, only one half is stored
+        double r = double(i) / double(N - 1);
+        double w = 0.2810639 - 0.5208972 * cos(2.0 * M_PI * r) + 0.1980399 * cos(4.0 * M_PI * r);
+        #if RFFT_FIXED_POINT
+        window[i] = lround(w * 32767.0);
+        #else
+        window[i] = w;
+        #endif
+      }
+      for (size_t k = 0; k < M; k++) {    // W_N^k, W_M^j = W_N^2j
+        #if RFFT_FIXED_POINT
+        cosTab[k] = lround(cos(2.0 * M_PI * k / N) * 32767.0);
+        sinTab[k] = lround(sin(2.0 * M_PI * k / N) * 32767.0);
+        #else
+        cosTab[k] = cos(2.0 * M_PI * k / N);
+        sinTab[k] = sin(2.0 * M_PI * k / N);
+        #endif
+        uint16_t r = 0;
+        for (uint16_t b = 1, v = k; b < M; b <<= 1, v >>= 1) r = (r << 1) | (v & 1);
+        bitRev[k] = r;
+      }
+    }
+
+    // x: N samples in, N magnitudes out (upper half mirrored like arduinoFFT); scratch: N floats
+    void compute(float *x, float *scratch) {
+      #if RFFT_FIXED_POINT
+      (void)scratch;
+      int32_t *re = work, *im = work + M;
+      // DC removal, windowing and packing into bit reversed order
+      int32_t sum = 0;
+      for (size_t i = 0; i < N; i++) {
+        int32_t v = lrintf(x[i]);
+        v = v > 0x3FFFF ? 0x3FFFF : (v < -0x3FFFF ? -0x3FFFF : v); // 19 bit, leaves headroom for the FFT gain
+        q[i] = v;
+        sum += v;
+      }
+      int32_t mean = sum / int32_t(N);
+      for (size_t k = 0; k < M; k++) {
+        uint16_t j = bitRev[k];
+        re[j] = (int64_t(q[2*k]   - mean) * win(2*k))   >> 15;
+        im[j] = (int64_t(q[2*k+1] - mean) * win(2*k+1)) >> 15;
+      }
+      // radix 2 decimation in time
+      for (size_t size = 2, step = N/2; size <= M; size <<= 1, step >>= 1) {
+        size_t half = size >> 1;
+        for (size_t j = 0; j < half; j++) {
+          int32_t wr = cosTab[j*step], wi = -sinTab[j*step];
+          for (size_t a = j; a < M; a += size) {
+            size_t b = a + half;
+            int32_t tr = (int64_t(re[b]) * wr - int64_t(im[b]) * wi) >> 15;
+            int32_t ti = (int64_t(re[b]) * wi + int64_t(im[b]) * wr) >> 15;
+            re[b] = re[a] - tr; im[b] = im[a] - ti;
+            re[a] += tr;        im[a] += ti;
+          }
+        }
+      }
+      // separate even and odd part: X[k] = (Z[k] + Z*[M-k])/2 - i W_N^k (Z[k] - Z*[M-k])/2
+      x[0] = fabsf(float(re[0] + im[0]));
+      x[M] = fabsf(float(re[0] - im[0]));
+      for (size_t k = 1; k < M; k++) {
+        int32_t er = (re[k] + re[M-k]) >> 1, ei = (im[k] - im[M-k]) >> 1;
+        int32_t or_ = (im[k] + im[M-k]) >> 1, oi = (re[M-k] - re[k]) >> 1;
+        int32_t wr = cosTab[k], wi = -sinTab[k];
+        int64_t Xr = er + ((int64_t(or_) * wr - int64_t(oi) * wi) >> 15);
+        int64_t Xi = ei + ((int64_t(or_) * wi + int64_t(oi) * wr) >> 15);
+        x[k] = sqrtf(float(Xr * Xr + Xi * Xi));
+      }
+      #else
+      float *re = scratch, *im = scratch + M;
+      float mean = 0.0f;
+      for (size_t i = 0; i < N; i++) mean += x[i];
+      mean /= float(N);
+      for (size_t k = 0; k < M; k++) {
+        uint16_t j = bitRev[k];
+        re[j] = (x[2*k]   - mean) * win(2*k);
+        im[j] = (x[2*k+1] - mean) * win(2*k+1);
+      }
+      for (size_t size = 2, step = N/2; size <= M; size <<= 1, step >>= 1) {
+        size_t half = size >> 1;
+        for (size_t j = 0; j < half; j++) {
+          float wr = cosTab[j*step], wi = -sinTab[j*step];
+          for (size_t a = j; a < M; a += size) {
+            size_t b = a + half;
+            float tr = re[b] * wr - im[b] * wi;
+            float ti = re[b] * wi + im[b] * wr;
+            re[b] = re[a] - tr; im[b] = im[a] - ti;
+            re[a] += tr;        im[a] += ti;
+          }
+        }
+      }
+      x[0] = fabsf(re[0] + im[0]);
+      x[M] = fabsf(re[0] - im[0]);
+      for (size_t k = 1; k < M; k++) {
+        float er = 0.5f * (re[k] + re[M-k]), ei = 0.5f * (im[k] - im[M-k]);
+        float or_ = 0.5f * (im[k] + im[M-k]), oi = 0.5f * (re[M-k] - re[k]);
+        float wr = cosTab[k], wi = -sinTab[k];
+        float Xr = er + or_ * wr - oi * wi;
+        float Xi = ei + or_ * wi + oi * wr;
+        x[k] = sqrtf(Xr * Xr + Xi * Xi);
+      }
+      #endif
+      for (size_t k = 1; k < M; k++) x[N-k] = x[k];
+    }
+
+  private:
+    #if RFFT_FIXED_POINT
+    int16_t  window[N/2];
+    int16_t  cosTab[M];
+    int16_t  sinTab[M];
+    int32_t  q[N];          // integer samples
+    int32_t  work[N];       // complex FFT data (real parts, imaginary parts)
+    inline int32_t win(size_t i) const { return window[i < N/2 ? i : N-1-i]; }
+    #else
+    float    window[N/2];
+    float    cosTab[M];
+    float    sinTab[M];
+    inline float win(size_t i) const { return window[i < N/2 ? i : N-1-i]; }
+    #endif
+    uint16_t bitRev[M];
+};
@@ -53,6 +53,7 @@
 
 // use audio source class (ESP32 specific)
 #include "audio_source.h"
+#include "audio_sync.h"
 constexpr i2s_port_t I2S_PORT = I2S_NUM_0;       // I2S port to use (do not change !)
 constexpr int BLOCK_SIZE = 128;                  // I2S buffer size (samples)
 
@@ -140,12 +141,30 @@ static float fftResultPink[NUM_GEQ_CHANNELS] = { 1.70f, 1.71f, 1.73f, 1.78f, 1.6
 static float FFT_MajorPeak = 1.0f;              // FFT: strongest (peak) frequency
 static float FFT_Magnitude = 0.0f;              // FFT: volume (magnitude) of peak frequency
 static uint8_t fftResult[NUM_GEQ_CHANNELS]= {0};// Our calculated freq. channel result table to be used by effects
+
+// FFT task results are published as one block (seqlock). The loop task copies them into fftResult[], FFT_MajorPeak and FFT_Magnitude,
+// so all effects of a frame see the spectrum of a single FFT cycle.
+typedef struct AudioResult {
+  uint8_t  fftResult[NUM_GEQ_CHANNELS];
+  float    majorPeak;
+  float    magnitude;
+  float    bpm;                                 // tempo
+  float    beatPhase;                           // 0..1, 0 = on the beat (at capture time)
+  uint8_t  beatConfidence;                      // 0..255
+  uint64_t captured;                            // esp_timer time (us) when the sample block was complete
+} audioresult_t;
+static audioresult_t     audioResultShared;     // written by FFT task only
+static volatile uint32_t audioResultSeq = 0;    // odd while audioResultShared is being written
+static uint64_t audioCaptured = 0;              // capture time of the results used by effects
+static uint32_t audioLatency = 0;               // sample capture to LED output (us, smoothed)
+static bool     audioShowPending = false;       // new results not shown yet
 #if defined(WLED_DEBUG) || defined(SR_DEBUG)
 static uint64_t fftTime = 0;
 static uint64_t sampleTime = 0;
 #endif
 
 // FFT Task variables (filtering and post-processing)
+static uint8_t fftResultTask[NUM_GEQ_CHANNELS] = {0};                 // fftResult[] as calculated by FFT task, see publishAudioResult()
 static float   fftCalc[NUM_GEQ_CHANNELS] = {0.0f};                    // Try and normalize fftBin values to a max of 4096, so that 4096/16 = 256.
 static float   fftAvg[NUM_GEQ_CHANNELS] = {0.0f};                     // Calculated frequency channel results, with smoothing (used if dynamics limiter is ON)
 #ifdef SR_DEBUG
@@ -163,8 +182,15 @@ constexpr SRate_t SAMPLE_RATE = 22050;        // Base sample rate in Hz - 22Khz
 //#define FFT_MIN_CYCLE 46                      // minimum time before FFT task is repeated. Use with 10Khz sampling
 
 // FFT Constants
+constexpr uint16_t samplesBlock = 512;          // new samples per FFT cycle
+#ifdef UM_AUDIOREACTIVE_FFT_OVERLAP
+constexpr uint16_t samplesFFT = 1024;           // 50% overlapping windows: twice the frequency resolution (better bass separation) at the same update rate
+#define FFT_BIN_SCALE 2                         // FFT bins per bin of the 512 point FFT
+#else
 constexpr uint16_t samplesFFT = 512;            // Samples in an FFT batch - This value MUST ALWAYS be a power of 2
-constexpr uint16_t samplesFFT_2 = 256;          // meaningfull part of FFT results - only the "lower half" contains useful information.
+#define FFT_BIN_SCALE 1
+#endif
+constexpr uint16_t samplesFFT_2 = samplesFFT/2; // meaningfull part of FFT results - only the "lower half" contains useful information.
 // the following are observed values, supported by a bit of "educated guessing"
 //#define FFT_DOWNSCALE 0.65f                             // 20kHz - downscaling factor for FFT results - "Flat-Top" window @20Khz, old freq channels 
 #define FFT_DOWNSCALE 0.46f                             // downscaling factor for FFT results - for "Flat-Top" window @22Khz, new freq channels
@@ -173,6 +199,9 @@ constexpr uint16_t samplesFFT_2 = 256;          // meaningfull part of FFT resul
 // These are the input and output vectors.  Input vectors receive computed results from FFT.
 static float vReal[samplesFFT] = {0.0f};       // FFT sample inputs / freq output -  these are our raw result bins
 static float vImag[samplesFFT] = {0.0f};       // imaginary parts
+#ifdef UM_AUDIOREACTIVE_FFT_OVERLAP
+static float fftHistory[samplesFFT] = {0.0f};  // last two sample blocks
+#endif
 #ifdef UM_AUDIOREACTIVE_USE_NEW_FFT
 static float windowWeighingFactors[samplesFFT] = {0.0f};
 #endif
@@ -192,6 +221,12 @@ static float windowWeighingFactors[samplesFFT] = {0.0f};
 #endif
 
 #include <arduinoFFT.h>
+#ifdef UM_AUDIOREACTIVE_USE_RFFT
+#include "audio_fft.h"
+static RealFFT<samplesFFT> rFFT;               // built-in real input FFT (arduinoFFT is still used for majorPeak())
+#endif
+#include "audio_beat.h"
+static BeatTracker<NUM_GEQ_CHANNELS> beatTracker; // onsets, tempo and beat phase from the GEQ channels (FFT task)
 
 #ifdef UM_AUDIOREACTIVE_USE_NEW_FFT
 static ArduinoFFT<float> FFT = ArduinoFFT<float>( vReal, vImag, samplesFFT, SAMPLE_RATE, windowWeighingFactors);
@@ -206,6 +241,41 @@ static float mapf(float x, float in_min, float in_max, float out_min, float out_
   return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
 }
 
+// GEQ channel bin ranges (512 point FFT at 22050Hz) and damping
+typedef struct GeqBins {
+  uint8_t from, to;
+  float   gain;
+} geqbins_t;
+
+static const geqbins_t geqBins[NUM_GEQ_CHANNELS] = {
+                        // bins frequency  range
+  {  1,   2, 1.00f },   // 1    43 - 86   sub-bass
+  {  2,   3, 1.00f },   // 1    86 - 129  bass
+  {  3,   5, 1.00f },   // 2   129 - 216  bass
+  {  5,   7, 1.00f },   // 2   216 - 301  bass + midrange
+  {  7,  10, 1.00f },   // 3   301 - 430  midrange
+  { 10,  13, 1.00f },   // 3   430 - 560  midrange
+  { 13,  19, 1.00f },   // 5   560 - 818  midrange
+  { 19,  26, 1.00f },   // 7   818 - 1120 midrange -- 1Khz should always be the center !
+  { 26,  33, 1.00f },   // 7  1120 - 1421 midrange
+  { 33,  44, 1.00f },   // 9  1421 - 1895 midrange
+  { 44,  56, 1.00f },   // 12 1895 - 2412 midrange + high mid
+  { 56,  70, 1.00f },   // 14 2412 - 3015 high mid
+  { 70,  86, 1.00f },   // 16 3015 - 3704 high mid
+  { 86, 104, 1.00f },   // 18 3704 - 4479 high mid
+  {104, 165, 0.88f },   // 61 4479 - 7106 high mid + high  -- with slight damping
+  {165, 215, 0.70f }    // 50 7106 - 9259 high             -- with some damping. Don't use the last bins from 216 to 255. They are usually contaminated by aliasing (aka noise)
+};
+
+// with band pass filter: channels 0-3 and 15 (frequencies below 100hz are filtered)
+static const geqbins_t geqBinsBP[5] = {
+  {  3,   4, 0.80f },
+  {  4,   5, 0.90f },
+  {  5,   6, 1.00f },
+  {  6,   7, 1.00f },
+  {165, 205, 0.75f }    // 40 7106 - 8828 high             -- with some damping. Don't use the last bins from 206 to 255.
+};
+
 // compute average of several FFT resut bins
 static float fftAddAvg(int from, int to) {
   float result = 0.0f;
@@ -215,6 +285,38 @@ static float fftAddAvg(int from, int to) {
   return result / float(to - from + 1);
 }
 
+// called by FFT task once per cycle
+static void publishAudioResult(float majorPeak, float magnitude, uint64_t captured) {
+  audioResultSeq++;                             // odd: readers keep their last copy
+  __sync_synchronize();
+  memcpy(audioResultShared.fftResult, fftResultTask, sizeof(fftResultTask));
+  audioResultShared.majorPeak = majorPeak;
+  audioResultShared.magnitude = magnitude;
+  audioResultShared.bpm       = beatTracker.bpm();
+  audioResultShared.beatPhase = beatTracker.phase();
+  audioResultShared.beatConfidence = beatTracker.confidence();
+  audioResultShared.captured  = captured;
+  __sync_synchronize();
+  audioResultSeq++;
+}
+
+// consistent copy of the latest FFT task results, false if nothing new since lastSeq (or being written right now). Never waits for the FFT task.
+static bool readAudioResult(audioresult_t &dst, uint32_t &lastSeq) {
+  uint32_t seq = audioResultSeq;
+  if (seq == lastSeq || (seq & 1)) return false;
+  __sync_synchronize();
+  memcpy(&dst, &audioResultShared, sizeof(dst));
+  __sync_synchronize();
+  if (audioResultSeq != seq) return false;      // overwritten while copying, try again next time
+  lastSeq = seq;
+  return true;
+}
+
+// average of a GEQ channel's bins, independent of FFT size
+static inline float geqChannel(const geqbins_t &b) {
+  return fftAddAvg(b.from * FFT_BIN_SCALE, b.to * FFT_BIN_SCALE + FFT_BIN_SCALE - 1) * b.gain;
+}
+
 //
 // FFT main task
 //
@@ -225,6 +327,13 @@ void FFTcode(void * parameter)
   // see https://www.freertos.org/vtaskdelayuntil.html
   const TickType_t xFrequency = FFT_MIN_CYCLE * portTICK_PERIOD_MS;  
 
+  #ifdef UM_AUDIOREACTIVE_USE_RFFT
+  rFFT.init();
+  #endif
+  beatTracker.init(float(SAMPLE_RATE) / samplesBlock);
+  float majorPeak = 1.0f;     // FFT results of this cycle, published together with fftResultTask[]
+  float magnitude = 0.0f;
+
   TickType_t xLastWakeTime = xTaskGetTickCount();
   for(;;) {
     delay(1);           // DO NOT DELETE THIS LINE! It is needed to give the IDLE(0) task enough time and to keep the watchdog happy.
@@ -242,7 +351,14 @@ void FFTcode(void * parameter)
 #endif
 
     // get a fresh batch of samples from I2S
-    if (audioSource) audioSource->getSamples(vReal, samplesFFT);
+#ifdef UM_AUDIOREACTIVE_FFT_OVERLAP
+    float *newSamples = fftHistory + (samplesFFT - samplesBlock);   // previous block is kept, FFT runs over the last two blocks
+    memmove(fftHistory, newSamples, samplesBlock * sizeof(float));
+#else
+    float *newSamples = vReal;
+#endif
+    if (audioSource) audioSource->getSamples(newSamples, samplesBlock);
+    uint64_t captured = esp_timer_get_time();
 
 #if defined(WLED_DEBUG) || defined(SR_DEBUG)
     if (start < esp_timer_get_time()) { // filter out overflows
@@ -256,17 +372,18 @@ void FFTcode(void * parameter)
 
     // band pass filter - can reduce noise floor by a factor of 50
     // downside: frequencies below 100Hz will be ignored
-    if (useBandPassFilter) runMicFilter(samplesFFT, vReal);
+    if (useBandPassFilter) runMicFilter(samplesBlock, newSamples);
 
     // find highest sample in the batch
     float maxSample = 0.0f;                         // max sample from FFT batch
-    for (int i=0; i < samplesFFT; i++) {
-	    // set imaginary parts to 0
-      vImag[i] = 0;
+    for (int i=0; i < samplesBlock; i++) {
 	    // pick our  our current mic sample - we take the max value from all samples that go into FFT
-	    if ((vReal[i] <= (INT16_MAX - 1024)) && (vReal[i] >= (INT16_MIN + 1024)))  //skip extreme values - normally these are artefacts
-        if (fabsf((float)vReal[i]) > maxSample) maxSample = fabsf((float)vReal[i]);
+	    if ((newSamples[i] <= (INT16_MAX - 1024)) && (newSamples[i] >= (INT16_MIN + 1024)))  //skip extreme values - normally these are artefacts
+        if (fabsf((float)newSamples[i]) > maxSample) maxSample = fabsf((float)newSamples[i]);
     }
+#ifdef UM_AUDIOREACTIVE_FFT_OVERLAP
+    memcpy(vReal, fftHistory, sizeof(vReal));
+#endif
     // release highest sample to volume reactive effects early - not strictly necessary here - could also be done at the end of the function
     // early release allows the filters (getSample() and agcAvg()) to work with fresh values - we will have matching gain and noise gate values when we want to process the FFT results.
     micDataReal = maxSample;
@@ -278,13 +395,17 @@ void FFTcode(void * parameter)
 #endif
 
       // run FFT (takes 3-5ms on ESP32, ~12ms on ESP32-S2)
-#ifdef UM_AUDIOREACTIVE_USE_NEW_FFT
+#if defined(UM_AUDIOREACTIVE_USE_RFFT)
+      rFFT.compute(vReal, vImag);                                 // DC removal, Flat-Top window, FFT and magnitudes in one go (vImag is scratch)
+#elif defined(UM_AUDIOREACTIVE_USE_NEW_FFT)
+      memset(vImag, 0, sizeof(vImag));                            // set imaginary parts to 0
       FFT.dcRemoval();                                            // remove DC offset
       FFT.windowing( FFTWindow::Flat_top, FFTDirection::Forward); // Weigh data using "Flat Top" function - better amplitude accuracy
       //FFT.windowing(FFTWindow::Blackman_Harris, FFTDirection::Forward);  // Weigh data using "Blackman- Harris" window - sharp peaks due to excellent sideband rejection
       FFT.compute( FFTDirection::Forward );                       // Compute FFT
       FFT.complexToMagnitude();                                   // Compute magnitudes
 #else
+      memset(vImag, 0, sizeof(vImag));                            // set imaginary parts to 0
       FFT.DCRemoval(); // let FFT lib remove DC component, so we don't need to care about this in getSamples()
 
       //FFT.Windowing( FFT_WIN_TYP_HAMMING, FFT_FORWARD );        // Weigh data - standard Hamming window
@@ -296,11 +417,11 @@ void FFTcode(void * parameter)
 #endif
 
 #ifdef UM_AUDIOREACTIVE_USE_NEW_FFT
-      FFT.majorPeak(FFT_MajorPeak, FFT_Magnitude);                // let the effects know which freq was most dominant
+      FFT.majorPeak(majorPeak, magnitude);                        // let the effects know which freq was most dominant
 #else
-      FFT.MajorPeak(&FFT_MajorPeak, &FFT_Magnitude);              // let the effects know which freq was most dominant
+      FFT.MajorPeak(&majorPeak, &magnitude);                      // let the effects know which freq was most dominant
 #endif
-      FFT_MajorPeak = constrain(FFT_MajorPeak, 1.0f, 11025.0f);   // restrict value to range expected by effects
+      majorPeak = constrain(majorPeak, 1.0f, 11025.0f);           // restrict value to range expected by effects
 
 #if defined(WLED_DEBUG) || defined(SR_DEBUG)
       haveDoneFFT = true;
@@ -308,13 +429,13 @@ void FFTcode(void * parameter)
 
     } else { // noise gate closed - only clear results as FFT was skipped. MIC samples are still valid when we do this.
       memset(vReal, 0, sizeof(vReal));
-      FFT_MajorPeak = 1;
-      FFT_Magnitude = 0.001;
+      majorPeak = 1;
+      magnitude = 0.001;
     }
 
     for (int i = 0; i < samplesFFT; i++) {
       float t = fabsf(vReal[i]);                      // just to be sure - values in fft bins should be positive any way
-      vReal[i] = t / 16.0f;                           // Reduce magnitude. Want end result to be scaled linear and ~4096 max.
+      vReal[i] = t / (16.0f * FFT_BIN_SCALE);         // Reduce magnitude. Want end result to be scaled linear and ~4096 max. (longer window: larger magnitudes)
     } // for()
 
     // mapping of FFT result bins to frequency channels
@@ -346,35 +467,13 @@ void FFTcode(void * parameter)
       fftCalc[14] = fftAddAvg(147,194);   // 2940 - 3900
       fftCalc[15] = fftAddAvg(194,250);   // 3880 - 5000 // avoid the last 5 bins, which are usually inaccurate
 #else
-      /* new mapping, optimized for 22050 Hz by softhack007 */
-                                                    // bins frequency  range
+      /* new mapping, optimized for 22050 Hz by softhack007 - see geqBins[] */
+      for (int i=0; i < NUM_GEQ_CHANNELS; i++) fftCalc[i] = geqChannel(geqBins[i]);
       if (useBandPassFilter) {
         // skip frequencies below 100hz
-        fftCalc[ 0] = 0.8f * fftAddAvg(3,4);
-        fftCalc[ 1] = 0.9f * fftAddAvg(4,5);
-        fftCalc[ 2] = fftAddAvg(5,6);
-        fftCalc[ 3] = fftAddAvg(6,7);
-        // don't use the last bins from 206 to 255. 
-        fftCalc[15] = fftAddAvg(165,205) * 0.75f;   // 40 7106 - 8828 high             -- with some damping
-      } else {
-        fftCalc[ 0] = fftAddAvg(1,2);               // 1    43 - 86   sub-bass
-        fftCalc[ 1] = fftAddAvg(2,3);               // 1    86 - 129  bass
-        fftCalc[ 2] = fftAddAvg(3,5);               // 2   129 - 216  bass
-        fftCalc[ 3] = fftAddAvg(5,7);               // 2   216 - 301  bass + midrange
-        // don't use the last bins from 216 to 255. They are usually contaminated by aliasing (aka noise) 
-        fftCalc[15] = fftAddAvg(165,215) * 0.70f;   // 50 7106 - 9259 high             -- with some damping
+        for (int i=0; i < 4; i++) fftCalc[i] = geqChannel(geqBinsBP[i]);
+        fftCalc[15] = geqChannel(geqBinsBP[4]);
       }
-      fftCalc[ 4] = fftAddAvg(7,10);                // 3   301 - 430  midrange
-      fftCalc[ 5] = fftAddAvg(10,13);               // 3   430 - 560  midrange
-      fftCalc[ 6] = fftAddAvg(13,19);               // 5   560 - 818  midrange
-      fftCalc[ 7] = fftAddAvg(19,26);               // 7   818 - 1120 midrange -- 1Khz should always be the center !
-      fftCalc[ 8] = fftAddAvg(26,33);               // 7  1120 - 1421 midrange
-      fftCalc[ 9] = fftAddAvg(33,44);               // 9  1421 - 1895 midrange
-      fftCalc[10] = fftAddAvg(44,56);               // 12 1895 - 2412 midrange + high mid
-      fftCalc[11] = fftAddAvg(56,70);               // 14 2412 - 3015 high mid
-      fftCalc[12] = fftAddAvg(70,86);               // 16 3015 - 3704 high mid
-      fftCalc[13] = fftAddAvg(86,104);              // 18 3704 - 4479 high mid
-      fftCalc[14] = fftAddAvg(104,165) * 0.88f;     // 61 4479 - 7106 high mid + high  -- with slight damping
 #endif
     } else {  // noise gate closed - just decay old values
       for (int i=0; i < NUM_GEQ_CHANNELS; i++) {
@@ -383,8 +482,12 @@ void FFTcode(void * parameter)
       }
     }
 
+    // onset detection and tempo tracking on the unprocessed channels
+    beatTracker.process(fftCalc, 0, NUM_GEQ_CHANNELS-1);
+
     // post-processing of frequency channels (pink noise adjustment, AGC, smooting, scaling)
     postProcessFFTResults((fabsf(sampleAvg) > 0.25f)? true : false , NUM_GEQ_CHANNELS);
+    publishAudioResult(majorPeak, magnitude, captured);
 
 #if defined(WLED_DEBUG) || defined(SR_DEBUG)
     if (haveDoneFFT && (start < esp_timer_get_time())) { // filter out overflows
@@ -512,7 +615,7 @@ static void postProcessFFTResults(bool noiseGateOpen, int numberOfChannels) // p
         if (post_gain < 1.0f) post_gain = ((post_gain -1.0f) * 0.8f) +1.0f;
         currentResult *= post_gain;
       }
-      fftResult[i] = constrain((int)currentResult, 0, 255);
+      fftResultTask[i] = constrain((int)currentResult, 0, 255);
     }
 }
 ////////////////////
@@ -526,7 +629,7 @@ static void detectSamplePeak(void) {
   // Poor man's beat detection by seeing if sample > Average + some value.
   // This goes through ALL of the 255 bins - but ignores stupid settings
   // Then we got a peak, else we don't. The peak has to time out on its own in order to support UDP sound sync.
-  if ((sampleAvg > 1) && (maxVol > 0) && (binNum > 4) && (vReal[binNum] > maxVol) && ((millis() - timeOfPeak) > 100)) {
+  if ((sampleAvg > 1) && (maxVol > 0) && (binNum > 4) && (vReal[binNum * FFT_BIN_SCALE] > maxVol) && ((millis() - timeOfPeak) > 100)) {
     havePeak = true;
   }
 
@@ -598,6 +701,8 @@ class AudioReactive : public Usermod {
       float  FFT_MajorPeak;   //  04 Bytes
     };
 
+    // "V3" audiosync packets (sequence numbers, timestamps, compressed GEQ, tempo): see audio_sync.h
+
     // old "V1" audiosync struct - 83 Bytes - for backwards compatibility
     struct audioSyncPacket_v1 {
       char header[6];         //  06 Bytes
@@ -620,6 +725,10 @@ class AudioReactive : public Usermod {
     unsigned long lastTime = 0;   // last time of running UDP Microphone Sync
     const uint16_t delayMs = 10;  // I don't want to sample too often and overload WLED
     uint16_t audioSyncPort= 11988;// default port for UDP sound sync
+    uint8_t  audioSyncFormat = 0; // send format: 0 = V2 (0.14.x receivers), 1 = V3, 2 = V3 with compressed GEQ
+    bool     syncPending = false; // new FFT results since the last packet sent
+    AudioSyncEncoder syncEncoder;
+    AudioSyncReceiver syncReceiver;
 
     // used for AGC
     int      last_soundAgc = -1;   // used to detect AGC mode change (for resetting AGC internal error buffers)
@@ -638,10 +747,14 @@ class AudioReactive : public Usermod {
     float   volumeSmth = 0.0f;    // either sampleAvg or sampleAgc depending on soundAgc; smoothed sample
     int16_t  volumeRaw = 0;       // either sampleRaw or rawSampleAgc depending on soundAgc
     float my_magnitude =0.0f;     // FFT_Magnitude, scaled by multAgc
+    float   beatBpm = 120.0f;     // tempo estimate
+    float   beatPhase = 0.0f;     // 0..1, 0 = on the beat (now, extrapolated from the last FFT cycle)
+    uint8_t beatConfidence = 0;   // 0..255, low: no steady beat
+    float   beatPhaseAt = 0.0f;   // beat phase at capture time of the last FFT results
 
     // used to feed "Info" Page
     unsigned long last_UDPTime = 0;    // time of last valid UDP sound sync datapacket
-    int receivedFormat = 0;            // last received UDP sound sync format - 0=none, 1=v1 (0.13.x), 2=v2 (0.14.x)
+    int receivedFormat = 0;            // last received UDP sound sync format - 0=none, 1=v1 (0.13.x), 2=v2 (0.14.x), 3=v3
     float maxSample5sec = 0.0f;        // max sample (after AGC) in last 5 seconds 
     unsigned long sampleMaxTimer = 0;  // last time maxSample5sec was reset
     #define CYCLE_SAMPLEMAX 3500       // time window for merasuring
@@ -959,6 +1072,12 @@ class AudioReactive : public Usermod {
       if (!udpSyncConnected) return;
       //DEBUGSR_PRINTLN("Transmitting UDP Mic Packet");
 
+      syncPending = false;
+      if (audioSyncFormat > 0) {
+        transmitAudioData_v3();
+        return;
+      }
+
       audioSyncPacket transmitData;
       memset(reinterpret_cast<void *>(&transmitData), 0, sizeof(transmitData)); // make sure that the packet - including "invisible" padding bytes added by the compiler - is fully initialized
 
@@ -984,6 +1103,27 @@ class AudioReactive : public Usermod {
       return;
     } // transmitAudioData()
 
+    void transmitAudioData_v3()
+    {
+      audiosyncframe_t frame;
+      frame.sampleRaw      = (soundAgc) ? rawSampleAgc: sampleRaw;
+      frame.sampleSmth     = (soundAgc) ? sampleAgc   : sampleAvg;
+      frame.magnitude      = my_magnitude;
+      frame.majorPeak      = FFT_MajorPeak;
+      frame.bpm            = beatBpm;
+      frame.beatConfidence = beatConfidence;
+      frame.peak           = udpSamplePeak;
+      udpSamplePeak        = false;
+      for (int i = 0; i < NUM_GEQ_CHANNELS; i++) frame.geq[i] = (uint8_t)constrain(fftResult[i], 0, 254);
+
+      audioSyncPacket_v3 transmitData;
+      size_t len = syncEncoder.encode(transmitData, frame, beatPhase, millis(), audioSyncFormat == 2);
+      if (fftUdp.beginMulticastPacket() != 0) { // beginMulticastPacket returns 0 in case of error
+        fftUdp.write(reinterpret_cast<uint8_t *>(&transmitData), len);
+        fftUdp.endPacket();
+      }
+    } // transmitAudioData_v3()
+
     static bool isValidUdpSyncVersion(const char *header) {
       return strncmp_P(header, PSTR(UDP_SYNC_HEADER), 6) == 0;
     }
@@ -1043,35 +1183,74 @@ class AudioReactive : public Usermod {
       FFT_MajorPeak = constrain(receivedPacket->FFT_MajorPeak, 1.0, 11025.0);  // restrict value to range expected by effects
     }
 
+    // V3 frame played out by the jitter buffer (or extrapolated for a lost packet)
+    void decodeAudioData_v3(const audiosyncframe_t &frame) {
+      // update samples for effects
+      volumeSmth   = fmaxf(frame.sampleSmth, 0.0f);
+      volumeRaw    = fmaxf(frame.sampleRaw, 0.0f);
+      // update internal samples
+      sampleRaw    = volumeRaw;
+      sampleAvg    = volumeSmth;
+      rawSampleAgc = volumeRaw;
+      sampleAgc    = volumeSmth;
+      multAgc      = 1.0f;
+      autoResetPeak();
+      if (!samplePeak) {
+            samplePeak = frame.peak;
+            if (samplePeak) timeOfPeak = millis();
+      }
+      for (int i = 0; i < NUM_GEQ_CHANNELS; i++) fftResult[i] = frame.geq[i];
+      my_magnitude   = fmaxf(frame.magnitude, 0.0f);
+      FFT_Magnitude  = my_magnitude;
+      FFT_MajorPeak  = constrain(frame.majorPeak, 1.0f, 11025.0f);  // restrict value to range expected by effects
+      beatBpm        = frame.bpm > 0.0f ? frame.bpm : 120.0f;
+      beatConfidence = frame.beatConfidence;
+    }
+
     bool receiveAudioData()   // check & process new data. return TRUE in case that new audio data was received. 
     {
       if (!udpSyncConnected) return false;
       bool haveFreshData = false;
 
-      size_t packetSize = fftUdp.parsePacket();
-      if (packetSize > 5) {
+      // read everything that has arrived: V3 packets go into the jitter buffer, V1 and V2 are applied right away
+      for (size_t n = 0; n < AUDIOSYNC_SLOTS; n++) {
+        size_t packetSize = fftUdp.parsePacket();
+        if (packetSize <= 5) break;
         //DEBUGSR_PRINTLN("Received UDP Sync Packet");
         uint8_t fftBuff[packetSize];
         fftUdp.read(fftBuff, packetSize);
 
         // VERIFY THAT THIS IS A COMPATIBLE PACKET
-        if (packetSize == sizeof(audioSyncPacket) && (isValidUdpSyncVersion((const char *)fftBuff))) {
+        if (syncReceiver.push(fftBuff, packetSize, millis())) {
+          receivedFormat = 3;
+          last_UDPTime = millis();
+        } else if (packetSize == sizeof(audioSyncPacket) && (isValidUdpSyncVersion((const char *)fftBuff))) {
           decodeAudioData(packetSize, fftBuff);
           //DEBUGSR_PRINTLN("Finished parsing UDP Sync Packet v2");
           haveFreshData = true;
           receivedFormat = 2;
+          last_UDPTime = millis();
         } else {
           if (packetSize == sizeof(audioSyncPacket_v1) && (isValidUdpSyncVersion_v1((const char *)fftBuff))) {
             decodeAudioData_v1(packetSize, fftBuff);
             //DEBUGSR_PRINTLN("Finished parsing UDP Sync Packet v1");
             haveFreshData = true;
             receivedFormat = 1;
+            last_UDPTime = millis();
           } else receivedFormat = 0; // unknown format
         }
       }
       return haveFreshData;
     }
 
+    bool playAudioSync()      // V3: apply packets that are due, or conceal a missing one. return TRUE if samples changed.
+    {
+      audiosyncframe_t frame;
+      if (syncReceiver.poll(millis(), frame) == AUDIOSYNC_NONE) return false;
+      decodeAudioData_v3(frame);
+      return true;
+    }
+
 
     //////////////////////
     // usermod functions//
@@ -1092,7 +1271,7 @@ class AudioReactive : public Usermod {
         // usermod exchangeable data
         // we will assign all usermod exportable data here as pointers to original variables or arrays and allocate memory for pointers
         um_data = new um_data_t;
-        um_data->u_size = 8;
+        um_data->u_size = 11;
         um_data->u_type = new um_types_t[um_data->u_size];
         um_data->u_data = new void*[um_data->u_size];
         um_data->u_data[0] = &volumeSmth;      //*used (New)
@@ -1111,6 +1290,12 @@ class AudioReactive : public Usermod {
         um_data->u_type[6] = UMT_BYTE;
         um_data->u_data[7] = &binNum;          // assigned in effect function from UI element!!! (Puddlepeak, Ripplepeak, Waterfall)
         um_data->u_type[7] = UMT_BYTE;
+        um_data->u_data[8] = &beatBpm;         // used (New)
+        um_data->u_type[8] = UMT_FLOAT;
+        um_data->u_data[9] = &beatPhase;       // used (New)
+        um_data->u_type[9] = UMT_FLOAT;
+        um_data->u_data[10] = &beatConfidence; // used (New)
+        um_data->u_type[10] = UMT_BYTE;
       }
 
       // Reset I2S peripheral for good measure
@@ -1214,6 +1399,8 @@ class AudioReactive : public Usermod {
         fftUdp.stop();
       }
       
+      syncEncoder.reset();
+      syncReceiver.reset();
       if (audioSyncPort > 0 && (audioSyncEnabled & 0x03)) {
       #ifndef ESP8266
         udpSyncConnected = fftUdp.beginMulticast(IPAddress(239, 0, 0, 1), audioSyncPort);
@@ -1306,6 +1493,24 @@ class AudioReactive : public Usermod {
         // update samples for effects (raw, smooth) 
         volumeSmth = (soundAgc) ? sampleAgc   : sampleAvg;
         volumeRaw  = (soundAgc) ? rawSampleAgc: sampleRaw;
+        // latest FFT results, unchanged until the next loop() so all effects of a frame see the same spectrum
+        static uint32_t audioSeq = 0;
+        audioresult_t result;
+        if (readAudioResult(result, audioSeq)) {
+          memcpy(fftResult, result.fftResult, sizeof(fftResult));
+          FFT_MajorPeak    = result.majorPeak;
+          FFT_Magnitude    = result.magnitude;
+          audioCaptured    = result.captured;
+          audioShowPending = true;
+          beatBpm          = result.bpm;
+          beatPhaseAt      = result.beatPhase;
+          beatConfidence   = result.beatConfidence;
+          syncPending      = true;
+        }
+        // beat phase keeps running between FFT cycles (and covers the FFT latency)
+        beatPhase = beatPhaseAt + float(esp_timer_get_time() - audioCaptured) * beatBpm / 60000000.0f;
+        beatPhase -= floorf(beatPhase);
+
         // update FFTMagnitude, taking into account AGC amplification
         my_magnitude = FFT_Magnitude; // / 16.0f, 8.0f, 4.0f done in effects
         if (soundAgc) my_magnitude *= multAgc;
@@ -1325,13 +1530,13 @@ class AudioReactive : public Usermod {
           static float syncVolumeSmth = 0;
           bool have_new_sample = false;
           if (millis() - lastTime > delayMs) {
-            have_new_sample = receiveAudioData();
-            if (have_new_sample) last_UDPTime = millis();
-#ifdef ARDUINO_ARCH_ESP32
-            else fftUdp.flush(); // Flush udp input buffers if we haven't read it - avoids hickups in receive mode. Does not work on 8266.
-#endif
+            have_new_sample = receiveAudioData();             // reads all pending packets, no flush (would drop V3 packets for the jitter buffer)
             lastTime = millis();
           }
+          if (playAudioSync()) have_new_sample = true;        // V3 jitter buffer
+          if (receivedFormat == 3) beatPhase = syncReceiver.beatPhase(millis());
+          else beatConfidence = 0;
+          audioSyncUpdateRate(syncReceiver.stats, millis());
           if (have_new_sample) syncVolumeSmth = volumeSmth;   // remember received sample
           else volumeSmth = syncVolumeSmth;                   // restore originally received sample for next run of dynamics limiter
           limitSampleDynamics();                              // run dynamics limiter on received volumeSmth, to hide jumps and hickups
@@ -1355,15 +1560,28 @@ class AudioReactive : public Usermod {
       }
 
       //UDP Microphone Sync  - transmit mode
-      if ((audioSyncEnabled & 0x01) && (millis() - lastTime > 20)) {
-        // Only run the transmit code IF we're in Transmit mode
+      if ((audioSyncEnabled & 0x01) && (millis() - lastTime > 20) && (syncPending || (millis() - lastTime > 100))) {
+        // Only run the transmit code IF we're in Transmit mode - once per FFT cycle, no repeated packets
         transmitAudioData();
         lastTime = millis();
       }
+      if (audioSyncEnabled & 0x01) audioSyncUpdateRate(syncEncoder.stats, millis());
 
     }
 
 
+    /*
+     * handleOverlayDraw() is called just before strip.show(): time from sample capture to LED output of the results used
+     */
+    void handleOverlayDraw()
+    {
+      if (!audioShowPending) return;
+      audioShowPending = false;
+      uint32_t latency = esp_timer_get_time() - audioCaptured;
+      audioLatency = audioLatency ? (latency*3 + audioLatency*7)/10 : latency; // smooth
+    }
+
+
     bool getUMData(um_data_t **data)
     {
       if (!data || !enabled) return false; // no pointer provided by caller or not enabled -> exit
@@ -1386,6 +1604,7 @@ class AudioReactive : public Usermod {
       sampleAgc = 0; sampleAvg = 0;
       sampleRaw = 0; rawSampleAgc = 0;
       my_magnitude = 0; FFT_Magnitude = 0; FFT_MajorPeak = 1;
+      beatConfidence = 0;
       multAgc = 1;
       // reset FFT data
       memset(fftCalc, 0, sizeof(fftCalc)); 
@@ -1534,6 +1753,20 @@ class AudioReactive : public Usermod {
           infoArr.add(F("suspended"));
         }
 
+        // tempo
+        if ((disableSoundProcessing == false) && !(audioSyncEnabled & 0x02) && beatConfidence > 64) {
+          infoArr = user.createNestedArray(F("Tempo"));
+          infoArr.add(roundf(beatBpm));
+          infoArr.add(F(" BPM"));
+        }
+
+        // sample capture to LED output
+        if (audioSource && (disableSoundProcessing == false) && !(audioSyncEnabled & 0x02) && audioLatency) {
+          infoArr = user.createNestedArray(F("Audio Latency"));
+          infoArr.add(roundf(audioLatency/100.0f) / 10.0f);
+          infoArr.add(" ms");
+        }
+
         // AGC or manual Gain
         if ((soundAgc==0) && (disableSoundProcessing == false) && !(audioSyncEnabled & 0x02)) {
           infoArr = user.createNestedArray(F("Manual Gain"));
@@ -1552,7 +1785,7 @@ class AudioReactive : public Usermod {
         if (audioSyncEnabled) {
           if (audioSyncEnabled & 0x01) {
             infoArr.add(F("send mode"));
-            if ((udpSyncConnected) && (millis() - lastTime < 2500)) infoArr.add(F(" v2"));
+            if ((udpSyncConnected) && (millis() - lastTime < 2500)) infoArr.add(audioSyncFormat ? F(" v3") : F(" v2"));
           } else if (audioSyncEnabled & 0x02) {
               infoArr.add(F("receive mode"));
           }
@@ -1562,6 +1795,26 @@ class AudioReactive : public Usermod {
         if (audioSyncEnabled && udpSyncConnected && (millis() - last_UDPTime < 2500)) {
             if (receivedFormat == 1) infoArr.add(F(" v1"));
             if (receivedFormat == 2) infoArr.add(F(" v2"));
+            if (receivedFormat == 3) infoArr.add(F(" v3"));
+        }
+        // V3 packet statistics
+        if (udpSyncConnected && (audioSyncEnabled & 0x01) && audioSyncFormat > 0) {
+          infoArr = user.createNestedArray(F("Sync Packets"));
+          infoArr.add(syncEncoder.stats.rate);
+          infoArr.add(F("/s, "));
+          infoArr.add(syncEncoder.stats.byteRate);
+          infoArr.add(F(" B/s"));
+        } else if (udpSyncConnected && (audioSyncEnabled & 0x02) && receivedFormat == 3) {
+          const audiosyncstats_t &st = syncReceiver.stats;
+          float lost = 100.0f * float(st.lost) / float(st.packets + st.lost);
+          infoArr = user.createNestedArray(F("Sync Packets"));
+          infoArr.add(st.rate);
+          infoArr.add(F("/s, "));
+          infoArr.add(roundf(lost * 10.0f) / 10.0f);
+          infoArr.add(F("% lost"));
+          infoArr = user.createNestedArray(F("Sync Delay"));
+          infoArr.add(roundf(syncReceiver.playoutDelay()));
+          infoArr.add(F(" ms"));
         }
 
         #if defined(WLED_DEBUG) || defined(SR_DEBUG)
@@ -1690,6 +1943,7 @@ class AudioReactive : public Usermod {
       JsonObject sync = top.createNestedObject("sync");
       sync[F("port")] = audioSyncPort;
       sync[F("mode")] = audioSyncEnabled;
+      sync[F("format")] = audioSyncFormat;
     }
 
 
@@ -1746,6 +2000,7 @@ class AudioReactive : public Usermod {
 
       configComplete &= getJsonValue(top["sync"][F("port")], audioSyncPort);
       configComplete &= getJsonValue(top["sync"][F("mode")], audioSyncEnabled);
+      configComplete &= getJsonValue(top["sync"][F("format")], audioSyncFormat);
 
       return configComplete;
     }
@@ -1789,6 +2044,11 @@ class AudioReactive : public Usermod {
       oappend(SET_F("addOption(dd,'Off',0);"));
       oappend(SET_F("addOption(dd,'Send',1);"));
       oappend(SET_F("addOption(dd,'Receive',2);"));
+      oappend(SET_F("dd=addDropdown('AudioReactive','sync:format');"));
+      oappend(SET_F("addOption(dd,'V2 (0.14)',0);"));
+      oappend(SET_F("addOption(dd,'V3',1);"));
+      oappend(SET_F("addOption(dd,'V3 compressed',2);"));
+      oappend(SET_F("addInfo('AudioReactive:sync:format',1,'<i>sending, V3 needs receivers with V3 support</i>');"));
       oappend(SET_F("addInfo('AudioReactive:digitalmic:type',1,'<i>requires reboot!</i>');"));  // 0 is field type, 1 is actual field
       oappend(SET_F("addInfo('AudioReactive:digitalmic:pin[]',0,'<i>sd/data/dout</i>','I2S SD');"));
       oappend(SET_F("addInfo('AudioReactive:digitalmic:pin[]',1,'<i>ws/clk/lrck</i>','I2S WS');"));
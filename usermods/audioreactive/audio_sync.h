@@ -0,0 +1,358 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/*
+ * "V3" UDP audio sync format for the audioreactive usermod
+ *
+ * Compared to V2 every packet carries a sequence number and the sender time, plus tempo and beat phase.
+ * The GEQ channels are sent either in full (16 bytes) or, if compression is enabled, as 4 bit deltas
+ * to the previous packet (8 bytes). Deltas are quantised non-uniformly and the sender tracks what the
+ * receiver reconstructs, so errors do not add up; a full GEQ is sent if a delta would be off by more
+ * than AUDIOSYNC_DQ_MAXERR, and at least every AUDIOSYNC_KEY_EVERY packets so receivers recover from loss.
+ *
+ * Receivers put packets into a small jitter buffer and play them out in sequence order at
+ * send time + smallest transit time + playout delay. The playout delay follows the spread of transit
+ * times seen in the last few seconds, so packets arriving in bursts over Wi-Fi come out evenly spaced.
+ * Late and duplicate packets are dropped, gaps are counted as lost and bridged by holding, then
+ * fading out the last values. Packets are little endian (raw structs, like V1 and V2).
+ */
+
+#define AUDIOSYNC_GEQ          16
+#define AUDIOSYNC_SLOTS        8     // jitter buffer depth (packets)
+#define AUDIOSYNC_KEY_EVERY    8     // full GEQ at least every n packets
+#define AUDIOSYNC_DQ_MAXERR    4     // max. GEQ error of a delta packet
+#define AUDIOSYNC_MAX_DELAY    80    // playout delay limit (ms)
+#define AUDIOSYNC_WINDOW       2000  // transit time statistics window (ms)
+#define AUDIOSYNC_TIMEOUT      1000  // no packets for this long: stop concealing, resync on next packet
+
+#define AUDIOSYNC_F_PEAK       0x01  // sample peak
+#define AUDIOSYNC_F_DELTA      0x02  // GEQ as deltas to the previous packet
+#define AUDIOSYNC_F_BEAT       0x04  // tempo and beat phase valid
+
+#define AUDIOSYNC_NONE         0
+#define AUDIOSYNC_NEW          1     // packet(s) played out
+#define AUDIOSYNC_CONCEALED    2     // packet missing, values extrapolated
+
+static const char    AUDIOSYNC_HEADER[6] = "00003";
+static const uint8_t audioSyncDQ[8] = { 0, 1, 2, 4, 8, 16, 32, 64 }; // delta magnitude per 3 bit code
+
+// "V3" audiosync struct - 52 Bytes (44 Bytes with compressed GEQ)
+struct audioSyncPacket_v3 {
+  char     header[6];      //  06 Bytes  - "00003"
+  uint8_t  flags;          //  01 Bytes  - AUDIOSYNC_F_*
+  uint8_t  reserved1;      //  01 Bytes
+  uint16_t seq;            //  02 Bytes  - incremented per packet
+  uint16_t bpm;            //  02 Bytes  - tempo * 100
+  uint32_t timestamp;      //  04 Bytes  - sender millis()
+  float    sampleRaw;      //  04 Bytes
+  float    sampleSmth;     //  04 Bytes
+  float    FFT_Magnitude;  //  04 Bytes
+  float    FFT_MajorPeak;  //  04 Bytes
+  uint8_t  beatPhase;      //  01 Bytes  - 0..255 = one beat, at timestamp
+  uint8_t  beatConfidence; //  01 Bytes
+  uint8_t  reserved2[2];   //  02 Bytes
+  uint8_t  geq[AUDIOSYNC_GEQ]; // 16 Bytes - or 8 bytes of deltas (low nibble: even channel): bit 3 sign, bits 0-2 audioSyncDQ index
+};
+static_assert(sizeof(audioSyncPacket_v3) == 52, "audioSyncPacket_v3 must not contain padding");
+#define AUDIOSYNC_LEN_FULL  sizeof(audioSyncPacket_v3)
+#define AUDIOSYNC_LEN_DELTA (sizeof(audioSyncPacket_v3) - AUDIOSYNC_GEQ/2)
+
+// values carried by a packet
+typedef struct AudioSyncFrame {
+  float    sampleRaw;
+  float    sampleSmth;
+  float    magnitude;
+  float    majorPeak;
+  float    bpm;
+  uint8_t  beatConfidence;
+  bool     peak;
+  uint8_t  geq[AUDIOSYNC_GEQ];
+} audiosyncframe_t;
+
+typedef struct AudioSyncStats {
+  uint32_t packets;        // sent / received (valid V3)
+  uint32_t bytes;
+  uint32_t lost;           // missing sequence numbers
+  uint32_t late;           // arrived after their sequence number was played out (or dropped on overflow)
+  uint32_t dup;            // duplicates
+  uint32_t undecodable;    // delta packets whose predecessor was lost (GEQ held until the next full one)
+  uint32_t concealed;      // frames extrapolated because of a missing packet
+  uint32_t deltas;         // compressed packets (sender)
+  uint16_t rate;           // packets/s
+  uint16_t byteRate;       // bytes/s
+  uint32_t lastPackets, lastBytes, lastRate; // rate bookkeeping
+} audiosyncstats_t;
+
+// packets and bytes per second, call regularly
+static inline void audioSyncUpdateRate(audiosyncstats_t &s, uint32_t now) {
+  if (now - s.lastRate < 1000) return;
+  uint32_t dt = now - s.lastRate;
+  s.rate     = s.lastRate ? ((s.packets - s.lastPackets) * 1000 + dt/2) / dt : 0;
+  s.byteRate = s.lastRate ? ((s.bytes   - s.lastBytes)   * 1000 + dt/2) / dt : 0;
+  s.lastPackets = s.packets;
+  s.lastBytes   = s.bytes;
+  s.lastRate    = now;
+}
+
+static inline uint8_t audioSyncApplyDelta(uint8_t base, uint8_t code) {
+  int v = base + ((code & 0x08) ? -int(audioSyncDQ[code & 0x07]) : int(audioSyncDQ[code & 0x07]));
+  return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+
+class AudioSyncEncoder {
+  public:
+    void reset() {
+      seq = 0;
+      sinceKey = AUDIOSYNC_KEY_EVERY;
+      memset(&stats, 0, sizeof(stats));
+    }
+
+    // fills the packet, returns its length
+    size_t encode(audioSyncPacket_v3 &p, const audiosyncframe_t &f, float beatPhase, uint32_t now, bool compress) {
+      memset(&p, 0, sizeof(p));
+      memcpy(p.header, AUDIOSYNC_HEADER, sizeof(p.header));
+      p.seq           = seq++;
+      p.timestamp     = now;
+      p.sampleRaw     = f.sampleRaw;
+      p.sampleSmth    = f.sampleSmth;
+      p.FFT_Magnitude = f.magnitude;
+      p.FFT_MajorPeak = f.majorPeak;
+      if (f.peak) p.flags |= AUDIOSYNC_F_PEAK;
+      if (f.bpm > 0.0f) {
+        p.flags |= AUDIOSYNC_F_BEAT;
+        p.bpm = f.bpm < 600.0f ? uint16_t(f.bpm * 100.0f + 0.5f) : 60000;
+        p.beatPhase = uint8_t(int((beatPhase - floorf(beatPhase)) * 256.0f) & 0xFF);
+        p.beatConfidence = f.beatConfidence;
+      }
+
+      size_t len = AUDIOSYNC_LEN_FULL;
+      if (compress && ++sinceKey < AUDIOSYNC_KEY_EVERY && encodeDelta(p, f.geq)) {
+        p.flags |= AUDIOSYNC_F_DELTA;
+        len = AUDIOSYNC_LEN_DELTA;
+        stats.deltas++;
+      } else {
+        memcpy(p.geq, f.geq, AUDIOSYNC_GEQ);
+        memcpy(last, f.geq, AUDIOSYNC_GEQ);
+        sinceKey = 0;
+      }
+      stats.packets++;
+      stats.bytes += len;
+      return len;
+    }
+
+    audiosyncstats_t stats;
+
+  private:
+    // closed loop: deltas are taken from what the receiver has, false if the error would be too large
+    bool encodeDelta(audioSyncPacket_v3 &p, const uint8_t *geq) {
+      uint8_t code[AUDIOSYNC_GEQ], rec[AUDIOSYNC_GEQ];
+      for (size_t i = 0; i < AUDIOSYNC_GEQ; i++) {
+        uint8_t best = 0;
+        int bestErr = 256;
+        for (uint8_t c = 0; c < 16; c++) {
+          if (c == 0x08) continue;  // "-0"
+          int err = abs(int(geq[i]) - int(audioSyncApplyDelta(last[i], c)));
+          if (err < bestErr) { bestErr = err; best = c; }
+        }
+        if (bestErr > AUDIOSYNC_DQ_MAXERR) return false;
+        code[i] = best;
+        rec[i]  = audioSyncApplyDelta(last[i], best);
+      }
+      for (size_t i = 0; i < AUDIOSYNC_GEQ/2; i++) p.geq[i] = code[2*i] | (code[2*i+1] << 4);
+      memcpy(last, rec, AUDIOSYNC_GEQ);
+      return true;
+    }
+
+    uint8_t  last[AUDIOSYNC_GEQ];  // GEQ as reconstructed by receivers
+    uint16_t seq;
+    uint8_t  sinceKey;
+};
+
+
+class AudioSyncReceiver {
+  public:
+    void reset() {
+      memset(this, 0, sizeof(*this));
+      interval = 20.0f;
+    }
+
+    // takes a received datagram, false if it is not a V3 packet
+    bool push(const uint8_t *buf, size_t len, uint32_t now) {
+      if (len != AUDIOSYNC_LEN_FULL && len != AUDIOSYNC_LEN_DELTA) return false;
+      if (memcmp(buf, AUDIOSYNC_HEADER, sizeof(AUDIOSYNC_HEADER)) != 0) return false;
+      const audioSyncPacket_v3 *p = reinterpret_cast<const audioSyncPacket_v3*>(buf);
+      if (bool(p->flags & AUDIOSYNC_F_DELTA) != (len == AUDIOSYNC_LEN_DELTA)) return false;
+      stats.packets++;
+      stats.bytes += len;
+
+      // sender restarted or we have been away: start over
+      if (started && (now - lastArrival > AUDIOSYNC_TIMEOUT || int16_t(p->seq - nextSeq) > 1000 || lateRun > AUDIOSYNC_SLOTS)) started = false;
+      lastArrival = now;
+
+      // transit time statistics (sender and receiver clocks are unrelated, only differences matter)
+      int32_t transit = int32_t(now - p->timestamp);
+      if (!started) {
+        for (size_t i = 0; i < AUDIOSYNC_SLOTS; i++) slot[i].used = false;
+        started   = true;
+        nextSeq   = p->seq;
+        minTransit = winMin[0] = winMin[1] = transit;
+        winMax[0] = winMax[1] = transit;
+        winStart  = now;
+        prevTransit = transit;
+        delay     = 0.0f;
+        baseValid = false;
+        lateRun   = 0;
+      }
+      if (now - winStart >= AUDIOSYNC_WINDOW) {  // windowed min/max, follows clock drift
+        winMin[1] = winMin[0]; winMax[1] = winMax[0];
+        winMin[0] = winMax[0] = transit;
+        winStart  = now;
+      }
+      if (transit - winMin[0] < 0) winMin[0] = transit;
+      if (transit - winMax[0] > 0) winMax[0] = transit;
+      minTransit = (winMin[0] - winMin[1] < 0) ? winMin[0] : winMin[1];
+      int32_t d = transit - prevTransit;
+      prevTransit = transit;
+      jitter += (float(abs(d)) - jitter) / 16.0f;   // RFC 3550 interarrival jitter
+      int32_t maxTransit = (winMax[0] - winMax[1] > 0) ? winMax[0] : winMax[1];
+      float target = float(maxTransit - minTransit);
+      if (target > AUDIOSYNC_MAX_DELAY) target = AUDIOSYNC_MAX_DELAY;
+      delay = target > delay ? target : delay + (target - delay) * 0.02f; // up at once, down slowly
+
+      int16_t ahead = int16_t(p->seq - nextSeq);
+      if (ahead < 0) { stats.late++; lateRun++; return true; }
+      lateRun = 0;
+      if (p->seq == lastSeenSeq + 1 && p->timestamp != lastSeenTs) {
+        float iv = float(p->timestamp - lastSeenTs);
+        if (iv < 1000.0f) interval += (iv - interval) * 0.125f;
+      }
+      lastSeenSeq = p->seq;
+      lastSeenTs  = p->timestamp;
+
+      int8_t freeSlot = -1, oldest = -1;
+      for (size_t i = 0; i < AUDIOSYNC_SLOTS; i++) {
+        if (!slot[i].used) { if (freeSlot < 0) freeSlot = i; continue; }
+        if (slot[i].pkt.seq == p->seq) { stats.dup++; return true; }
+        if (oldest < 0 || int16_t(slot[i].pkt.seq - slot[oldest].pkt.seq) < 0) oldest = i;
+      }
+      if (freeSlot < 0) {   // overflow: give up the oldest packet
+        freeSlot = oldest;
+        stats.late++;
+      }
+      memcpy(&slot[freeSlot].pkt, buf, len);
+      slot[freeSlot].used = true;
+      return true;
+    }
+
+    // plays out due packets in sequence order, or conceals a missing one; frame is updated unless AUDIOSYNC_NONE is returned
+    uint8_t poll(uint32_t now, audiosyncframe_t &frame) {
+      if (!started) return AUDIOSYNC_NONE;
+      uint8_t result = AUDIOSYNC_NONE;
+      cur.peak = false;
+      for (;;) {
+        int8_t next = -1;
+        for (size_t i = 0; i < AUDIOSYNC_SLOTS; i++) {
+          if (slot[i].used && (next < 0 || int16_t(slot[i].pkt.seq - slot[next].pkt.seq) < 0)) next = i;
+        }
+        if (next < 0) break;
+        const audioSyncPacket_v3 &p = slot[next].pkt;
+        if (int32_t(now - (p.timestamp + minTransit + uint32_t(delay))) < 0) break; // not yet due
+        int16_t gap = int16_t(p.seq - nextSeq);
+        if (gap > 0) stats.lost += gap;
+        decode(p);
+        nextSeq = p.seq + 1;
+        slot[next].used = false;
+        lastPlay = now;
+        result = AUDIOSYNC_NEW;
+      }
+
+      // missing packet: hold the last values for one interval, then fade out
+      if (result == AUDIOSYNC_NONE && lastPlay && now - lastPlay < AUDIOSYNC_TIMEOUT
+          && float(now - lastPlay) > 1.5f * interval && float(now - lastConceal) >= interval) {
+        if (int32_t(lastConceal - lastPlay) > 0) {        // second interval without packet
+          for (size_t i = 0; i < AUDIOSYNC_GEQ; i++) cur.geq[i] = cur.geq[i] * 7 / 8;
+          cur.sampleRaw  *= 0.875f;
+          cur.sampleSmth *= 0.875f;
+          cur.magnitude  *= 0.875f;
+          cur.beatConfidence = cur.beatConfidence * 7 / 8;
+        }
+        lastConceal = now;
+        stats.concealed++;
+        result = AUDIOSYNC_CONCEALED;
+      }
+      if (result != AUDIOSYNC_NONE) frame = cur;
+      return result;
+    }
+
+    // beat phase (0..1) at local time now, extrapolated from the last packet played out
+    float beatPhase(uint32_t now) const {
+      float ph = phaseAt + float(int32_t(now - phaseRef)) * cur.bpm / 60000.0f;
+      return ph - floorf(ph);
+    }
+
+    float    playoutDelay() const { return delay; }
+    float    jitterMs() const     { return jitter; }
+    bool     active(uint32_t now) const { return started && now - lastArrival < AUDIOSYNC_TIMEOUT; }
+
+    audiosyncstats_t stats;
+
+  private:
+    void decode(const audioSyncPacket_v3 &p) {
+      cur.sampleRaw  = p.sampleRaw;
+      cur.sampleSmth = p.sampleSmth;
+      cur.magnitude  = p.FFT_Magnitude;
+      cur.majorPeak  = p.FFT_MajorPeak;
+      cur.peak      |= bool(p.flags & AUDIOSYNC_F_PEAK);
+      if (p.flags & AUDIOSYNC_F_BEAT) {
+        cur.bpm            = p.bpm / 100.0f;
+        cur.beatConfidence = p.beatConfidence;
+        phaseAt  = p.beatPhase / 256.0f;
+        phaseRef = p.timestamp + minTransit;       // local time of the phase, without the playout delay
+      } else {
+        cur.bpm = 0.0f;
+        cur.beatConfidence = 0;
+      }
+      if (!(p.flags & AUDIOSYNC_F_DELTA)) {
+        memcpy(base, p.geq, AUDIOSYNC_GEQ);
+        baseValid = true;
+      } else if (baseValid && p.seq == uint16_t(lastDecoded + 1)) {
+        for (size_t i = 0; i < AUDIOSYNC_GEQ/2; i++) {
+          base[2*i]   = audioSyncApplyDelta(base[2*i],   p.geq[i] & 0x0F);
+          base[2*i+1] = audioSyncApplyDelta(base[2*i+1], p.geq[i] >> 4);
+        }
+      } else {
+        baseValid = false;    // GEQ is held until the next full packet
+        stats.undecodable++;
+      }
+      lastDecoded = p.seq;
+      memcpy(cur.geq, base, AUDIOSYNC_GEQ);
+    }
+
+    struct {
+      bool used;
+      audioSyncPacket_v3 pkt;
+    } slot[AUDIOSYNC_SLOTS];
+    audiosyncframe_t cur;
+    uint8_t  base[AUDIOSYNC_GEQ];  // last decoded GEQ
+    bool     baseValid;
+    bool     started;
+    uint8_t  lateRun;              // late packets in a row
+    uint16_t nextSeq;              // next sequence number to play out
+    uint16_t lastDecoded;
+    uint16_t lastSeenSeq;
+    uint32_t lastSeenTs;
+    int32_t  minTransit, prevTransit;
+    int32_t  winMin[2], winMax[2]; // transit time min/max of the current and previous window
+    uint32_t winStart;
+    uint32_t lastArrival, lastPlay, lastConceal;
+    uint32_t phaseRef;
+    float    phaseAt;
+    float    interval;             // packet interval (ms)
+    float    delay;                // playout delay (ms)
+    float    jitter;
+};
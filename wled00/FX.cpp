@@ -36,6 +36,8 @@
 
 #define indexToVStrip(index, stripNr) ((index) | (int((stripNr)+1)<<16))
 
+#define NOISE_BLOCK 64 // noise samples generated at once by 1D effects (see fillNoise8())
+
 // effect utility functions
 uint8_t sin_gap(uint16_t in) {
   if (in & 0x100) return 0;
@@ -1960,56 +1962,98 @@ static const char _data_FX_MODE_PALETTE[] PROGMEM = "Palette@Cycle speed;;!;;c3=
 // There are two main parameters you can play with to control the look and
 // feel of your fire: COOLING (used in step 1 above) (Speed = COOLING), and SPARKING (used
 // in step 3 above) (Effect Intensity = Sparking).
+
+// Fire engine shared by Fire 2012 and 2D Fire.
+// Heat is a plane of `len` rows (distance from the base) by `width` columns (virtual strips or matrix
+// columns) so each step runs row by row across all strips at once on contiguous memory.
+
+// cheap xorshift, cooling needs a random value for every cell in every frame
+static inline uint32_t fireRandom(uint32_t &s) {
+  s ^= s << 13;
+  s ^= s >> 17;
+  s ^= s << 5;
+  return s;
+}
+
+// Step 1.  Cool down every cell a little
+static void fireCool(uint8_t *heat, uint16_t len, uint16_t width, uint8_t ignition, bool step) {
+  uint8_t  coolRange = (((20 + SEGMENT.speed/3) * 16) / len) + 2;
+  uint32_t rnd = (uint32_t(random16()) << 16) | random16() | 1;
+  uint32_t r = 0;
+  unsigned n = 0;
+  for (int i = 0; i < len; i++) {
+    uint8_t minTemp = (i<ignition) ? (ignition-i)/4 + 16 : 0;  // should not become black in ignition area
+    uint8_t *row = heat + i * width;
+    for (int x = 0; x < width; x++) {
+      if (n++ % 4 == 0) r = fireRandom(rnd); // 4 random bytes per call
+      uint8_t cool = step ? ((r & 0xFF) * coolRange) >> 8 : r & 0x03;
+      r >>= 8;
+      uint8_t temp = qsub8(row[x], cool);
+      row[x] = temp<minTemp ? minTemp : temp;
+    }
+  }
+}
+
+// Step 2.  Heat from each cell drifts 'up' and diffuses a little (also sideways if spread is set)
+static void fireDrift(uint8_t *heat, uint16_t len, uint16_t width, bool spread) {
+  for (int k = len - 1; k > 1; k--) {
+    uint8_t *row = heat + k * width;
+    const uint8_t *below  = row - width;
+    const uint8_t *below2 = below - width;
+    if (!spread) {
+      for (int x = 0; x < width; x++) row[x] = (below[x] + (below2[x]<<1)) / 3;  // heat[k-2] multiplied by 2
+    } else {
+      for (int x = 0; x < width; x++) {
+        int l = x > 0 ? x-1 : x, r = x+1 < width ? x+1 : x;
+        row[x] = ((below[x]<<1) + below2[l] + (below2[x]<<1) + below2[r]) / 6;
+      }
+    }
+  }
+}
+
+// Step 3.  Randomly ignite new 'sparks' of heat near the bottom
+static void fireSpark(uint8_t *heat, uint16_t width, uint16_t x, uint8_t ignition) {
+  uint8_t y = random8(ignition);
+  uint8_t boost = (17+SEGMENT.custom3) * (ignition - y/2) / ignition; // integer math!
+  heat[y * width + x] = qadd8(heat[y * width + x], random8(96+2*boost,207+boost));
+}
+
+// Step 4.  Heat to color lookup, palette is used without blending so there are only 16 colors
+static void fireLUT(uint32_t *lut) {
+  for (int i = 0; i < 16; i++) {
+    CRGB c = ColorFromPalette(SEGPALETTE, i << 4, 255, NOBLEND);
+    lut[i] = RGBW32(c.r, c.g, c.b, 0);
+  }
+}
+
 uint16_t mode_fire_2012() {
   if (SEGLEN == 1) return mode_static();
   const uint16_t strips = SEGMENT.nrOfVStrips();
   if (!SEGENV.allocateData(strips * SEGLEN)) return mode_static(); //allocation failed
-  byte* heat = SEGENV.data;
+  byte* heat = SEGENV.data;  // SEGLEN rows of all strips
 
   const uint32_t it = strip.now >> 5; //div 32
+  const bool step = it != SEGENV.step;
+  const uint8_t ignition = max(3,SEGLEN/10);  // ignition area: 10% of segment length or minimum 3 pixels
+
+  fireCool(heat, SEGLEN, strips, ignition, step);
+  if (step) {
+    fireDrift(heat, SEGLEN, strips, false);
+    for (int stripNr=0; stripNr<strips; stripNr++)
+      if (random8() <= SEGMENT.intensity) fireSpark(heat, strips, stripNr, ignition);
+    SEGENV.step = it;
+  }
 
-  struct virtualStrip {
-    static void runStrip(uint16_t stripNr, byte* heat, uint32_t it) {
-
-      const uint8_t ignition = max(3,SEGLEN/10);  // ignition area: 10% of segment length or minimum 3 pixels
-
-      // Step 1.  Cool down every cell a little
-      for (int i = 0; i < SEGLEN; i++) {
-        uint8_t cool = (it != SEGENV.step) ? random8((((20 + SEGMENT.speed/3) * 16) / SEGLEN)+2) : random(4);
-        uint8_t minTemp = (i<ignition) ? (ignition-i)/4 + 16 : 0;  // should not become black in ignition area
-        uint8_t temp = qsub8(heat[i], cool);
-        heat[i] = temp<minTemp ? minTemp : temp;
-      }
-
-      if (it != SEGENV.step) {
-        // Step 2.  Heat from each cell drifts 'up' and diffuses a little
-        for (int k = SEGLEN -1; k > 1; k--) {
-          heat[k] = (heat[k - 1] + (heat[k - 2]<<1) ) / 3;  // heat[k-2] multiplied by 2
-        }
-
-        // Step 3.  Randomly ignite new 'sparks' of heat near the bottom
-        if (random8() <= SEGMENT.intensity) {
-          uint8_t y = random8(ignition);
-          uint8_t boost = (17+SEGMENT.custom3) * (ignition - y/2) / ignition; // integer math!
-          heat[y] = qadd8(heat[y], random8(96+2*boost,207+boost));
-        }
-      }
-
-      // Step 4.  Map from heat cells to LED colors
-      for (int j = 0; j < SEGLEN; j++) {
-        SEGMENT.setPixelColor(indexToVStrip(j, stripNr), ColorFromPalette(SEGPALETTE, MIN(heat[j],240), 255, NOBLEND));
-      }
-    }
-  };
-
-  for (int stripNr=0; stripNr<strips; stripNr++)
-    virtualStrip::runStrip(stripNr, &heat[stripNr * SEGLEN], it);
+  uint32_t lut[16];
+  fireLUT(lut);
+  for (int j = 0; j < SEGLEN; j++) {
+    const uint8_t *row = heat + j * strips;
+    for (int stripNr=0; stripNr<strips; stripNr++)
+      SEGMENT.setPixelColor(indexToVStrip(j, stripNr), lut[MIN(row[stripNr],240) >> 4]);
+  }
 
   if (SEGMENT.is2D()) SEGMENT.blur(32);
 
-  if (it != SEGENV.step)
-    SEGENV.step = it;
-
   return FRAMETIME;
 }
 static const char _data_FX_MODE_FIRE_2012[] PROGMEM = "Fire 2012@Cooling,Spark rate,,,Boost;;!;1;sx=64,ix=160,m12=1"; // bars
@@ -2077,8 +2121,10 @@ static const char _data_FX_MODE_BPM[] PROGMEM = "Bpm@!;!;!;;sx=64";
 uint16_t mode_fillnoise8() {
   if (SEGENV.call == 0) SEGENV.step = random16(12345);
   //CRGB fastled_col;
+  uint8_t noise[NOISE_BLOCK];
   for (int i = 0; i < SEGLEN; i++) {
-    uint8_t index = inoise8(i * SEGLEN, SEGENV.step + i * SEGLEN);
+    if (i % NOISE_BLOCK == 0) fillNoise8(noise, MIN(SEGLEN - i, NOISE_BLOCK), uint32_t(i * SEGLEN) << 8, SEGLEN << 8, (SEGENV.step + i * SEGLEN) << 8, SEGLEN << 8);
+    uint8_t index = noise[i % NOISE_BLOCK];
     //fastled_col = ColorFromPalette(SEGPALETTE, index, 255, LINEARBLEND);
     //SEGMENT.setPixelColor(i, fastled_col.red, fastled_col.green, fastled_col.blue);
     SEGMENT.setPixelColor(i, SEGMENT.color_from_palette(index, false, PALETTE_SOLID_WRAP, 0));
@@ -2094,14 +2140,24 @@ uint16_t mode_noise16_1() {
   uint16_t scale = 320;                                       // the "zoom factor" for the noise
   //CRGB fastled_col;
   SEGENV.step += (1 + SEGMENT.speed/16);
+  uint16_t shift_x = beatsin8(11);                            // the x position of the noise field swings @ 17 bpm
+  uint16_t shift_y = SEGENV.step/42;                          // the y position becomes slowly incremented
+  uint32_t real_z = SEGENV.step;                              // the z position becomes quickly incremented
+  uint8_t noises[NOISE_BLOCK];
+  uint16_t prev_x = 0, prev_y = 0;
+  int k = NOISE_BLOCK;
 
   for (int i = 0; i < SEGLEN; i++) {
-    uint16_t shift_x = beatsin8(11);                          // the x position of the noise field swings @ 17 bpm
-    uint16_t shift_y = SEGENV.step/42;                        // the y position becomes slowly incremented
     uint16_t real_x = (i + shift_x) * scale;                  // the x position of the noise field swings @ 17 bpm
     uint16_t real_y = (i + shift_y) * scale;                  // the y position becomes slowly incremented
-    uint32_t real_z = SEGENV.step;                            // the z position becomes quickly incremented
-    uint8_t noise = inoise16(real_x, real_y, real_z) >> 8;    // get the noise data and scale it down
+    // positions wrap at 16 bit, a new block starts there so the field jumps exactly where it always did
+    if (k == NOISE_BLOCK || real_x < prev_x || real_y < prev_y) {
+      fillNoise8(noises, MIN(SEGLEN - i, NOISE_BLOCK), real_x, scale, real_y, scale, real_z);
+      k = 0;
+    }
+    prev_x = real_x;
+    prev_y = real_y;
+    uint8_t noise = noises[k++];                              // get the noise data (scaled down)
     uint8_t index = sin8(noise * 3);                          // map LED color based on noise data
 
     //fastled_col = ColorFromPalette(SEGPALETTE, index, 255, LINEARBLEND);   // With that value, look up the 8 bit colour palette value and assign it to the current LED.
@@ -2118,11 +2174,13 @@ uint16_t mode_noise16_2() {
   uint16_t scale = 1000;                                        // the "zoom factor" for the noise
   //CRGB fastled_col;
   SEGENV.step += (1 + (SEGMENT.speed >> 1));
+  uint16_t shift_x = SEGENV.step >> 6;                          // x as a function of time
+  uint8_t noises[NOISE_BLOCK];
 
   for (int i = 0; i < SEGLEN; i++) {
-    uint16_t shift_x = SEGENV.step >> 6;                        // x as a function of time
     uint32_t real_x = (i + shift_x) * scale;                    // calculate the coordinates within the noise field
-    uint8_t noise = inoise16(real_x, 0, 4223) >> 8;             // get the noise data and scale it down
+    if (i % NOISE_BLOCK == 0) fillNoise8(noises, MIN(SEGLEN - i, NOISE_BLOCK), real_x, scale, 0, 0, 4223);
+    uint8_t noise = noises[i % NOISE_BLOCK];                    // get the noise data (scaled down)
     uint8_t index = sin8(noise * 3);                            // map led color based on noise data
 
     //fastled_col = ColorFromPalette(SEGPALETTE, index, noise, LINEARBLEND);   // With that value, look up the 8 bit colour palette value and assign it to the current LED.
@@ -2139,6 +2197,7 @@ uint16_t mode_noise16_3() {
   uint16_t scale = 800;                                       // the "zoom factor" for the noise
   //CRGB fastled_col;
   SEGENV.step += (1 + SEGMENT.speed);
+  uint8_t noises[NOISE_BLOCK];
 
   for (int i = 0; i < SEGLEN; i++) {
     uint16_t shift_x = 4223;                                  // no movement along x and y
@@ -2146,7 +2205,8 @@ uint16_t mode_noise16_3() {
     uint32_t real_x = (i + shift_x) * scale;                  // calculate the coordinates within the noise field
     uint32_t real_y = (i + shift_y) * scale;                  // based on the precalculated positions
     uint32_t real_z = SEGENV.step*8;
-    uint8_t noise = inoise16(real_x, real_y, real_z) >> 8;    // get the noise data and scale it down
+    if (i % NOISE_BLOCK == 0) fillNoise8(noises, MIN(SEGLEN - i, NOISE_BLOCK), real_x, scale, real_y, scale, real_z);
+    uint8_t noise = noises[i % NOISE_BLOCK];                  // get the noise data (scaled down)
     uint8_t index = sin8(noise * 3);                          // map led color based on noise data
 
     //fastled_col = ColorFromPalette(SEGPALETTE, index, noise, LINEARBLEND);   // With that value, look up the 8 bit colour palette value and assign it to the current LED.
@@ -2163,8 +2223,10 @@ static const char _data_FX_MODE_NOISE16_3[] PROGMEM = "Noise 3@!;!;!";
 uint16_t mode_noise16_4() {
   //CRGB fastled_col;
   uint32_t stp = (strip.now * SEGMENT.speed) >> 7;
+  uint16_t noise[NOISE_BLOCK];
   for (int i = 0; i < SEGLEN; i++) {
-    int16_t index = inoise16(uint32_t(i) << 12, stp);
+    if (i % NOISE_BLOCK == 0) fillNoise16(noise, MIN(SEGLEN - i, NOISE_BLOCK), uint32_t(i) << 12, 1 << 12, stp);
+    int16_t index = noise[i % NOISE_BLOCK];
     //fastled_col = ColorFromPalette(SEGPALETTE, index);
     //SEGMENT.setPixelColor(i, fastled_col.red, fastled_col.green, fastled_col.blue);
     SEGMENT.setPixelColor(i, SEGMENT.color_from_palette(index, false, PALETTE_SOLID_WRAP, 0));
@@ -3026,8 +3088,185 @@ uint16_t mode_solid_glitter()
 static const char _data_FX_MODE_SOLID_GLITTER[] PROGMEM = "Solid Glitter@,!;Bg,,Glitter color;;;m12=0";
 
 
+// Particle engine shared by Popcorn and Fireworks 1D (free particles under constant acceleration).
+// Bouncing Balls and Starburst compute positions from elapsed time, Drip runs a per-drop state machine
+// and Fireworks, Rain and Matrix shift pixels, so they keep their own code.
+// Particles are kept in segment data as a structure of arrays, so update and render passes stream
+// through memory and live particles stay packed at the front (a dying particle is replaced by the last one).
+// Positions and velocities are 16.16 fixed point pixels (per frame), y runs along the strip (upwards
+// on a matrix) and x is the matrix column or the virtual strip.
+#define PARTICLE_FIXED(f)  int32_t((f) * 65536.0f)
+#define PARTICLE_BYTES     (4*sizeof(int32_t) + sizeof(uint16_t) + sizeof(uint8_t)) // 19 bytes per particle
+#define PARTICLE_INFINITE  0xFFFF  // particle does not age
+
+typedef struct Particles {
+  uint16_t *count;     // live particles (stored in segment data)
+  uint16_t capacity;
+  int32_t  *x, *y, *vx, *vy;
+  uint16_t *life;      // frames left
+  uint8_t  *hue;       // palette index or color slot
+} particles;
+
+typedef uint32_t (*particleColor)(const particles &ps, unsigned i);
+
+// allocate room for `capacity` particles after `extra` bytes (multiple of 4) of effect data
+static bool particleData(particles &ps, uint16_t capacity, uint16_t extra = 0) {
+  if (!SEGENV.allocateData(extra + 4 + capacity * PARTICLE_BYTES)) return false; // new data is zeroed, no particles
+  byte *d = SEGENV.data + extra;
+  ps.count    = reinterpret_cast<uint16_t*>(d);
+  ps.capacity = capacity;
+  ps.x        = reinterpret_cast<int32_t*>(d + 4);
+  ps.y        = ps.x  + capacity;
+  ps.vx       = ps.y  + capacity;
+  ps.vy       = ps.vx + capacity;
+  ps.life     = reinterpret_cast<uint16_t*>(ps.vy + capacity);
+  ps.hue      = reinterpret_cast<uint8_t*>(ps.life + capacity);
+  if (*ps.count > capacity) *ps.count = 0;
+  return true;
+}
+
+// returns index of the new particle or -1 if there is no room
+static int particleSpawn(particles &ps, int32_t x, int32_t y, int32_t vx, int32_t vy, uint16_t life, uint8_t hue) {
+  if (*ps.count >= ps.capacity) return -1;
+  unsigned i = (*ps.count)++;
+  ps.x[i]  = x;  ps.y[i]  = y;
+  ps.vx[i] = vx; ps.vy[i] = vy;
+  ps.life[i] = life;
+  ps.hue[i]  = hue;
+  return i;
+}
+
+// age, move and accelerate all particles, particles die of age or when falling below `floor`
+static void particleUpdate(particles &ps, int32_t ax, int32_t ay, int32_t floor = INT32_MIN) {
+  unsigned n = *ps.count;
+  for (unsigned i = 0; i < n; ) {
+    if (ps.life[i] != PARTICLE_INFINITE) ps.life[i]--;
+    ps.x[i]  += ps.vx[i];
+    ps.y[i]  += ps.vy[i];
+    ps.vx[i] += ax;
+    ps.vy[i] += ay;
+    if (ps.life[i] && ps.y[i] >= floor) { i++; continue; }
+    n--;  // dead, move last particle into its place
+    ps.x[i]  = ps.x[n];  ps.y[i]  = ps.y[n];
+    ps.vx[i] = ps.vx[n]; ps.vy[i] = ps.vy[n];
+    ps.life[i] = ps.life[n];
+    ps.hue[i]  = ps.hue[n];
+  }
+  *ps.count = n;
+}
+
+// scale all channels of a color by w/256 (0-256), two channels per multiplication
+static inline uint32_t particleScale(uint32_t c, unsigned w) {
+  return ((((c & 0x00FF00FF) * w) >> 8) & 0x00FF00FF) | ((((c >> 8) & 0x00FF00FF) * w) & 0xFF00FF00);
+}
+
+static inline void particlePixel(int i, uint32_t c, unsigned w) {
+  SEGMENT.addPixelColor(i, particleScale(c, w), true);
+}
+
+static inline void particlePixelXY(int x, int y, uint32_t c, unsigned w) {
+  SEGMENT.addPixelColorXY(x, y, particleScale(c, w), true);
+}
+
+static inline uint32_t particleAdd(uint32_t a, uint32_t b) {
+  return RGBW32(qadd8(R(a), R(b)), qadd8(G(a), G(b)), qadd8(B(a), B(b)), qadd8(W(a), W(b)));
+}
+
+#define PARTICLE_LINE 64 // pixels summed at once by particleRenderAdd()
+
+// additive particles along a single strip, anti-aliased over two pixels: contributions are summed in a line
+// buffer one window of PARTICLE_LINE pixels at a time, so every touched pixel is read and written only once
+static void particleRenderAdd(const particles &ps, particleColor color, bool reverse) {
+  const int len = SEGLEN;
+  int lo = len, hi = -1;
+  for (unsigned i = 0; i < *ps.count; i++) {
+    if (ps.y[i] < 0 || (ps.y[i] >> 16) >= len) continue;
+    int pos = ps.y[i] >> 16;
+    if (pos < lo) lo = pos;
+    if (pos + 1 > hi) hi = min(pos + 1, len - 1);
+  }
+  uint32_t line[PARTICLE_LINE];
+  for (int start = lo; start <= hi; start += PARTICLE_LINE) {
+    const int n = min(PARTICLE_LINE, hi - start + 1);
+    uint64_t touched = 0;
+    memset(line, 0, sizeof(line));
+    for (unsigned i = 0; i < *ps.count; i++) {
+      if (ps.y[i] < 0) continue;
+      int pos = ps.y[i] >> 16;
+      int k = pos - start;
+      unsigned f = (ps.y[i] >> 8) & 0xFF;
+      if (pos >= len || k >= n || k < -1 || (k < 0 && !f)) continue; // k = -1: only the second pixel is in this window
+      uint32_t c = color(ps, i);
+      if (k >= 0) {
+        line[k] = particleAdd(line[k], particleScale(c, 256 - f));
+        touched |= 1ULL << k;
+      }
+      if (f && k + 1 < n && pos + 1 < len) {
+        line[k+1] = particleAdd(line[k+1], particleScale(c, f));
+        touched |= 1ULL << (k+1);
+      }
+    }
+    for (int k = 0; k < n; k++) {
+      if (!(touched & (1ULL << k))) continue;
+      int p = reverse ? len - 1 - start - k : start + k;
+      SEGMENT.setPixelColor(p, particleAdd(SEGMENT.getPixelColor(p), line[k]));
+    }
+  }
+}
+
+// draw particles along the strip (or their virtual strips): solid particles (Popcorn) are set on one
+// pixel, additive ones (sparks) are anti-aliased over two pixels and added to what is already there
+static void particleRender(const particles &ps, particleColor color, bool additive, bool reverse = false) {
+  const int  len    = SEGLEN;
+  const bool vstrip = SEGMENT.nrOfVStrips() > 1;
+  if (additive && !vstrip) {
+    particleRenderAdd(ps, color, reverse);
+    return;
+  }
+  for (unsigned i = 0; i < *ps.count; i++) {
+    if (ps.y[i] < 0) continue;
+    int pos = ps.y[i] >> 16;
+    if (pos >= len) continue;
+    uint32_t c = color(ps, i);
+    int a = reverse ? len - 1 - pos : pos;
+    if (!additive) {
+      SEGMENT.setPixelColor(vstrip ? indexToVStrip(a, ps.x[i] >> 16) : a, c);
+      continue;
+    }
+    unsigned f = (ps.y[i] >> 8) & 0xFF;
+    int b = reverse ? a - 1 : a + 1;
+    if (vstrip) { a = indexToVStrip(a, ps.x[i] >> 16); b = indexToVStrip(b, ps.x[i] >> 16); }
+    particlePixel(a, c, 256 - f);
+    if (f && pos + 1 < len) particlePixel(b, c, f);
+  }
+}
+
+// draw particles on a matrix (y pointing up), solid ones on one pixel, additive ones anti-aliased over four pixels
+static void particleRenderXY(const particles &ps, particleColor color, bool additive) {
+  const int cols = SEGMENT.virtualWidth();
+  const int rows = SEGMENT.virtualHeight();
+  for (unsigned i = 0; i < *ps.count; i++) {
+    if (ps.x[i] < 0 || ps.y[i] < 0) continue;
+    int x = ps.x[i] >> 16, y = ps.y[i] >> 16;
+    if (x >= cols || y >= rows) continue;
+    uint32_t c = color(ps, i);
+    int r = rows - 1 - y;
+    if (!additive) {
+      SEGMENT.setPixelColorXY(x, r, c);
+      continue;
+    }
+    unsigned fx = (ps.x[i] >> 8) & 0xFF, fy = (ps.y[i] >> 8) & 0xFF;
+    bool right = fx && x + 1 < cols, up = fy && r > 0;
+    particlePixelXY(x, r, c, ((256 - fx) * (256 - fy)) >> 8);
+    if (right)       particlePixelXY(x + 1, r,     c, (fx * (256 - fy)) >> 8);
+    if (up)          particlePixelXY(x,     r - 1, c, ((256 - fx) * fy) >> 8);
+    if (right && up) particlePixelXY(x + 1, r - 1, c, (fx * fy) >> 8);
+  }
+}
+
+
 //each needs 19 bytes
-//Spark type is used for popcorn, 1D fireworks, and drip
+//Spark type is used for drip
 typedef struct Spark {
   float pos, posX;
   float vel, velX;
@@ -3040,60 +3279,51 @@ typedef struct Spark {
 *  POPCORN
 *  modified from https://github.com/kitesurfer1404/WS2812FX/blob/master/src/custom/Popcorn.h
 */
+static uint32_t popcornColor(const particles &ps, unsigned i) {
+  if (!SEGMENT.palette && ps.hue[i] < NUM_COLORS) return SEGCOLOR(ps.hue[i]);
+  return SEGMENT.color_wheel(ps.hue[i]);
+}
+
 uint16_t mode_popcorn(void) {
   if (SEGLEN == 1) return mode_static();
   //allocate segment data
   uint16_t strips = SEGMENT.nrOfVStrips();
-  uint16_t dataSize = sizeof(spark) * maxNumPopcorn;
-  if (!SEGENV.allocateData(dataSize * strips)) return mode_static(); //allocation failed
-
-  Spark* popcorn = reinterpret_cast<Spark*>(SEGENV.data);
+  particles ps;
+  if (!particleData(ps, maxNumPopcorn * strips)) return mode_static(); //allocation failed
 
   bool hasCol2 = SEGCOLOR(2);
   if (!SEGMENT.check2) SEGMENT.fill(hasCol2 ? BLACK : SEGCOLOR(1));
 
-  struct virtualStrip {
-    static void runStrip(uint16_t stripNr, Spark* popcorn) {
-      float gravity = -0.0001 - (SEGMENT.speed/200000.0); // m/s/s
-      gravity *= SEGLEN;
-
-      uint8_t numPopcorn = SEGMENT.intensity*maxNumPopcorn/255;
-      if (numPopcorn == 0) numPopcorn = 1;
-
-      for(int i = 0; i < numPopcorn; i++) {
-        if (popcorn[i].pos >= 0.0f) { // if kernel is active, update its position
-          popcorn[i].pos += popcorn[i].vel;
-          popcorn[i].vel += gravity;
-        } else { // if kernel is inactive, randomly pop it
-          if (random8() < 2) { // POP!!!
-            popcorn[i].pos = 0.01f;
-
-            uint16_t peakHeight = 128 + random8(128); //0-255
-            peakHeight = (peakHeight * (SEGLEN -1)) >> 8;
-            popcorn[i].vel = sqrtf(-2.0f * gravity * peakHeight);
-
-            if (SEGMENT.palette)
-            {
-              popcorn[i].colIndex = random8();
-            } else {
-              byte col = random8(0, NUM_COLORS);
-              if (!SEGCOLOR(2) || !SEGCOLOR(col)) col = 0;
-              popcorn[i].colIndex = col;
-            }
-          }
-        }
-        if (popcorn[i].pos >= 0.0f) { // draw now active popcorn (either active before or just popped)
-          uint32_t col = SEGMENT.color_wheel(popcorn[i].colIndex);
-          if (!SEGMENT.palette && popcorn[i].colIndex < NUM_COLORS) col = SEGCOLOR(popcorn[i].colIndex);
-          uint16_t ledIndex = popcorn[i].pos;
-          if (ledIndex < SEGLEN) SEGMENT.setPixelColor(indexToVStrip(ledIndex, stripNr), col);
-        }
+  float gravity = -0.0001 - (SEGMENT.speed/200000.0); // m/s/s
+  gravity *= SEGLEN;
+
+  uint8_t numPopcorn = SEGMENT.intensity*maxNumPopcorn/255;
+  if (numPopcorn == 0) numPopcorn = 1;
+
+  // move active kernels, the ones falling below the start become inactive
+  particleUpdate(ps, 0, PARTICLE_FIXED(gravity), 0);
+
+  uint8_t active[strips];
+  memset(active, 0, strips);
+  for (unsigned i = 0; i < *ps.count; i++) active[ps.x[i] >> 16]++;
+
+  for (int stripNr = 0; stripNr < strips; stripNr++) {
+    for (int i = active[stripNr]; i < numPopcorn; i++) {
+      if (random8() >= 2) continue; // randomly pop inactive kernels
+      uint16_t peakHeight = 128 + random8(128); //0-255
+      peakHeight = (peakHeight * (SEGLEN -1)) >> 8;
+      uint8_t colIndex;
+      if (SEGMENT.palette) {
+        colIndex = random8();
+      } else {
+        colIndex = random8(0, NUM_COLORS);
+        if (!SEGCOLOR(2) || !SEGCOLOR(colIndex)) colIndex = 0;
       }
+      particleSpawn(ps, stripNr << 16, PARTICLE_FIXED(0.01f), 0, PARTICLE_FIXED(sqrtf(-2.0f * gravity * peakHeight)), PARTICLE_INFINITE, colIndex);
     }
-  };
+  }
 
-  for (int stripNr=0; stripNr<strips; stripNr++)
-    virtualStrip::runStrip(stripNr, &popcorn[stripNr * maxNumPopcorn]);
+  particleRender(ps, popcornColor, false);
 
   return FRAMETIME;
 }
@@ -3332,6 +3562,30 @@ static const char _data_FX_MODE_STARBURST[] PROGMEM = "Fireworks Starburst@Chanc
  * adapted from: http://www.anirama.com/1000leds/1d-fireworks/
  * adapted for 2D WLED by blazoncek (Blaz Kristan (AKA blazoncek))
  */
+typedef struct FireworkFlare {
+  int32_t  x, y, vx, vy;   // 16.16 fixed point like particles
+  int32_t  dyingGravity;
+  uint16_t bri;
+  uint16_t reserved;
+} fireworkFlare;
+
+#define FIREWORK_SPARK_LIFE 86 // frames a spark burns (color progress 345 -> 1 in steps of 4)
+
+static uint32_t fireworkSparkColor(const particles &ps, unsigned i) {
+  uint16_t prog = ps.life[i] * 4 + 1;
+  uint32_t spColor = (SEGMENT.palette) ? SEGMENT.color_wheel(ps.hue[i]) : SEGCOLOR(0);
+  CRGB c = CRGB::Black; //HeatColor(prog);
+  if (prog > 300) { //fade from white to spark color
+    c = CRGB(color_blend(spColor, WHITE, (prog - 300)*5));
+  } else if (prog > 45) { //fade from spark color to black
+    c = CRGB(color_blend(BLACK, spColor, prog - 45));
+    uint8_t cooling = (300 - prog) >> 5;
+    c.g = qsub8(c.g, cooling);
+    c.b = qsub8(c.b, cooling * 2);
+  }
+  return RGBW32(c.r, c.g, c.b, 0);
+}
+
 uint16_t mode_exploding_fireworks(void)
 {
   if (SEGLEN == 1) return mode_static();
@@ -3343,50 +3597,50 @@ uint16_t mode_exploding_fireworks(void)
   uint8_t segs = strip.getActiveSegmentsNum();
   if (segs <= (strip.getMaxSegments() /2)) maxData *= 2; //ESP8266: 512 if <= 8 segs ESP32: 1280 if <= 16 segs
   if (segs <= (strip.getMaxSegments() /4)) maxData *= 2; //ESP8266: 1024 if <= 4 segs ESP32: 2560 if <= 8 segs
-  int maxSparks = maxData / sizeof(spark); //ESP8266: max. 21/42/85 sparks/seg, ESP32: max. 53/106/213 sparks/seg
+  int maxSparks = (maxData - sizeof(fireworkFlare) - 4) / PARTICLE_BYTES; //ESP8266: max. 12/25/52 sparks/seg, ESP32: max. 32/65/133 sparks/seg
 
   uint16_t numSparks = min(2 + ((rows*cols) >> 1), maxSparks);
-  uint16_t dataSize = sizeof(spark) * numSparks;
-  if (!SEGENV.allocateData(dataSize + sizeof(float))) return mode_static(); //allocation failed
-  float *dying_gravity = reinterpret_cast<float*>(SEGENV.data + dataSize);
+  particles ps;
+  if (!particleData(ps, numSparks, sizeof(fireworkFlare))) return mode_static(); //allocation failed
+  fireworkFlare *flare = reinterpret_cast<fireworkFlare*>(SEGENV.data);
 
-  if (dataSize != SEGENV.aux1) { //reset to flare if sparks were reallocated (it may be good idea to reset segment if bounds change)
-    *dying_gravity = 0.0f;
+  if (numSparks != SEGENV.aux1) { //reset to flare if sparks were reallocated (it may be good idea to reset segment if bounds change)
+    *ps.count = 0;
+    flare->dyingGravity = 0;
     SEGENV.aux0 = 0;
-    SEGENV.aux1 = dataSize;
+    SEGENV.aux1 = numSparks;
   }
 
   SEGMENT.fade_out(252);
 
-  Spark* sparks = reinterpret_cast<Spark*>(SEGENV.data);
-  Spark* flare = sparks; //first spark is flare data
-
   float gravity = -0.0004f - (SEGMENT.speed/800000.0f); // m/s/s
   gravity *= rows;
+  const int32_t g = PARTICLE_FIXED(gravity);
+  const bool reverse = !strip.isMatrix && flare->x; // firing side on 1D
 
   if (SEGENV.aux0 < 2) { //FLARE
     if (SEGENV.aux0 == 0) { //init flare
-      flare->pos = 0;
-      flare->posX = strip.isMatrix ? random16(2,cols-3) : (SEGMENT.intensity > random8()); // will enable random firing side on 1D
+      flare->y = 0;
+      flare->x = (strip.isMatrix ? random16(2,cols-3) : (SEGMENT.intensity > random8())) << 16; // will enable random firing side on 1D
       uint16_t peakHeight = 75 + random8(180); //0-255
       peakHeight = (peakHeight * (rows -1)) >> 8;
-      flare->vel = sqrtf(-2.0f * gravity * peakHeight);
-      flare->velX = strip.isMatrix ? (random8(9)-4)/32.f : 0; // no X velocity on 1D
-      flare->col = 255; //brightness
+      flare->vy = PARTICLE_FIXED(sqrtf(-2.0f * gravity * peakHeight));
+      flare->vx = strip.isMatrix ? (random8(9)-4) * 2048 : 0; // (-4..4)/32, no X velocity on 1D
+      flare->bri = 255;
       SEGENV.aux0 = 1;
     }
 
     // launch
-    if (flare->vel > 12 * gravity) {
+    if (flare->vy > 12 * g) {
       // flare
-      if (strip.isMatrix) SEGMENT.setPixelColorXY(int(flare->posX), rows - uint16_t(flare->pos) - 1, flare->col, flare->col, flare->col);
-      else                SEGMENT.setPixelColor(int(flare->posX) ? rows - int(flare->pos) - 1 : int(flare->pos), flare->col, flare->col, flare->col);
-      flare->pos  += flare->vel;
-      flare->posX += flare->velX;
-      flare->pos  = constrain(flare->pos, 0, rows-1);
-      flare->posX = constrain(flare->posX, 0, cols-strip.isMatrix);
-      flare->vel  += gravity;
-      flare->col  -= 2;
+      uint8_t b = flare->bri;
+      int pos = flare->y >> 16;
+      if (strip.isMatrix) SEGMENT.setPixelColorXY(flare->x >> 16, rows - pos - 1, b, b, b);
+      else                SEGMENT.setPixelColor(flare->x ? rows - pos - 1 : pos, b, b, b);
+      flare->y  = constrain(flare->y + flare->vy, 0, (rows-1) << 16);
+      flare->x  = constrain(flare->x + flare->vx, 0, (cols-strip.isMatrix) << 16);
+      flare->vy += g;
+      flare->bri -= 2;
     } else {
       SEGENV.aux0 = 2;  // ready to explode
     }
@@ -3397,56 +3651,32 @@ uint16_t mode_exploding_fireworks(void)
      * Explosion happens where the flare ended.
      * Size is proportional to the height.
      */
-    int nSparks = flare->pos + random8(4);
-    nSparks = constrain(nSparks, 4, numSparks);
-
-    // initialize sparks
     if (SEGENV.aux0 == 2) {
+      int nSparks = (flare->y >> 16) + random8(4);
+      nSparks = constrain(nSparks, 4, numSparks);
+      const float flarePos  = flare->y / 65536.0f;
+      const float flarePosX = flare->x / 65536.0f;
+      *ps.count = 0;
       for (int i = 1; i < nSparks; i++) {
-        sparks[i].pos  = flare->pos;
-        sparks[i].posX = flare->posX;
-        sparks[i].vel  = (float(random16(20001)) / 10000.0f) - 0.9f; // from -0.9 to 1.1
-        sparks[i].vel *= rows<32 ? 0.5f : 1; // reduce velocity for smaller strips
-        sparks[i].velX = strip.isMatrix ? (float(random16(10001)) / 10000.0f) - 0.5f : 0; // from -0.5 to 0.5
-        sparks[i].col  = 345;//abs(sparks[i].vel * 750.0); // set colors before scaling velocity to keep them bright
-        //sparks[i].col = constrain(sparks[i].col, 0, 345);
-        sparks[i].colIndex = random8();
-        sparks[i].vel  *= flare->pos/rows; // proportional to height
-        sparks[i].velX *= strip.isMatrix ? flare->posX/cols : 0; // proportional to width
-        sparks[i].vel  *= -gravity *50;
+        float vel  = (float(random16(20001)) / 10000.0f) - 0.9f; // from -0.9 to 1.1
+        vel *= rows<32 ? 0.5f : 1; // reduce velocity for smaller strips
+        float velX = strip.isMatrix ? (float(random16(10001)) / 10000.0f) - 0.5f : 0; // from -0.5 to 0.5
+        vel  *= flarePos/rows; // proportional to height
+        velX *= strip.isMatrix ? flarePosX/cols : 0; // proportional to width
+        vel  *= -gravity *50;
+        particleSpawn(ps, strip.isMatrix ? flare->x : 0, flare->y, PARTICLE_FIXED(velX), PARTICLE_FIXED(vel), FIREWORK_SPARK_LIFE, random8());
       }
-      //sparks[1].col = 345; // this will be our known spark
-      *dying_gravity = gravity/2;
+      flare->dyingGravity = g/2;
       SEGENV.aux0 = 3;
     }
 
-    if (sparks[1].col > 4) {//&& sparks[1].pos > 0) { // as long as our known spark is lit, work with all the sparks
-      for (int i = 1; i < nSparks; i++) {
-        sparks[i].pos  += sparks[i].vel;
-        sparks[i].posX += sparks[i].velX;
-        sparks[i].vel  += *dying_gravity;
-        sparks[i].velX += strip.isMatrix ? *dying_gravity : 0;
-        if (sparks[i].col > 3) sparks[i].col -= 4;
-
-        if (sparks[i].pos > 0 && sparks[i].pos < rows) {
-          if (strip.isMatrix && !(sparks[i].posX >= 0 && sparks[i].posX < cols)) continue;
-          uint16_t prog = sparks[i].col;
-          uint32_t spColor = (SEGMENT.palette) ? SEGMENT.color_wheel(sparks[i].colIndex) : SEGCOLOR(0);
-          CRGB c = CRGB::Black; //HeatColor(sparks[i].col);
-          if (prog > 300) { //fade from white to spark color
-            c = CRGB(color_blend(spColor, WHITE, (prog - 300)*5));
-          } else if (prog > 45) { //fade from spark color to black
-            c = CRGB(color_blend(BLACK, spColor, prog - 45));
-            uint8_t cooling = (300 - prog) >> 5;
-            c.g = qsub8(c.g, cooling);
-            c.b = qsub8(c.b, cooling * 2);
-          }
-          if (strip.isMatrix) SEGMENT.setPixelColorXY(int(sparks[i].posX), rows - int(sparks[i].pos) - 1, c.red, c.green, c.blue);
-          else                SEGMENT.setPixelColor(int(sparks[i].posX) ? rows - int(sparks[i].pos) - 1 : int(sparks[i].pos), c.red, c.green, c.blue);
-        }
-      }
+    // all sparks burn out at the same time
+    particleUpdate(ps, strip.isMatrix ? flare->dyingGravity : 0, flare->dyingGravity);
+    if (*ps.count) {
+      if (strip.isMatrix) particleRenderXY(ps, fireworkSparkColor, true);
+      else                particleRender(ps, fireworkSparkColor, true, reverse);
       SEGMENT.blur(16);
-      *dying_gravity *= .8f; // as sparks burn out they fall slower
+      flare->dyingGravity = (flare->dyingGravity * 4) / 5; // as sparks burn out they fall slower
     } else {
       SEGENV.aux0 = 6 + random8(10); //wait for this many frames
     }
@@ -4006,8 +4236,10 @@ uint16_t mode_noisepal(void) {                                    // Slow noise
 
   if (SEGMENT.palette > 0) palettes[0] = SEGPALETTE;
 
+  uint8_t noise[NOISE_BLOCK];
   for (int i = 0; i < SEGLEN; i++) {
-    uint8_t index = inoise8(i*scale, SEGENV.aux0+i*scale);                // Get a value from the noise function. I'm using both x and y axis.
+    if (i % NOISE_BLOCK == 0) fillNoise8(noise, MIN(SEGLEN - i, NOISE_BLOCK), (i*scale) << 8, scale << 8, (SEGENV.aux0+i*scale) << 8, scale << 8);
+    uint8_t index = noise[i % NOISE_BLOCK];                               // Get a value from the noise function. I'm using both x and y axis.
     color = ColorFromPalette(palettes[0], index, 255, LINEARBLEND);       // Use the my own palette.
     SEGMENT.setPixelColor(i, color.red, color.green, color.blue);
   }
@@ -4601,8 +4833,11 @@ static const char _data_FX_MODE_AURORA[] PROGMEM = "Aurora@!,!;1,2,3;!;;sx=24,pa
 uint16_t mode_perlinmove(void) {
   if (SEGLEN == 1) return mode_static();
   SEGMENT.fade_out(255-SEGMENT.custom1);
+  uint16_t noise[16];
+  uint32_t t = millis()*128/(260-SEGMENT.speed);
+  fillNoise16(noise, SEGMENT.intensity/16 + 1, t, 15000, t);                                               // Get new pixel locations from moving noise.
   for (int i = 0; i < SEGMENT.intensity/16 + 1; i++) {
-    uint16_t locn = inoise16(millis()*128/(260-SEGMENT.speed)+i*15000, millis()*128/(260-SEGMENT.speed)); // Get a new pixel location from moving noise.
+    uint16_t locn = noise[i];
     uint16_t pixloc = map(locn, 50*256, 192*256, 0, SEGLEN-1);                                            // Map that to the length of the strand, and ensure we don't go over.
     SEGMENT.setPixelColor(pixloc, SEGMENT.color_from_palette(pixloc%255, false, PALETTE_SOLID_WRAP, 0));
   }
@@ -4857,18 +5092,56 @@ uint16_t mode_2Dfirenoise(void) {               // firenoise2d. By Andrew Tuline
                               CRGB::DarkOrange,CRGB::DarkOrange, CRGB::Orange, CRGB::Orange,
                               CRGB::Yellow, CRGB::Orange, CRGB::Yellow, CRGB::Yellow);
 
-  for (int j=0; j < cols; j++) {
-    for (int i=0; i < rows; i++) {
-      indexx = inoise8(j*yscale*rows/255, i*xscale+millis()/4);                                           // We're moving along our Perlin map.
+  uint8_t noise[cols];
+  for (int i=0; i < rows; i++) {
+    fillNoise8(noise, cols, 0, (yscale*rows << 8)/255, (i*xscale+millis()/4) << 8);                         // We're moving along our Perlin map.
+    for (int j=0; j < cols; j++) {
+      indexx = noise[j];
       SEGMENT.setPixelColorXY(j, i, ColorFromPalette(SEGPALETTE, min(i*(indexx)>>4, 255), i*255/cols, LINEARBLEND)); // With that value, look up the 8 bit colour palette value and assign it to the current LED.
-    } // for i
-  } // for j
+    } // for j
+  } // for i
 
   return FRAMETIME;
 } // mode_2Dfirenoise()
 static const char _data_FX_MODE_2DFIRENOISE[] PROGMEM = "Firenoise@X scale,Y scale;;!;2";
 
 
+//////////////////////////////
+//     2D Fire              //
+//////////////////////////////
+// Fire 2012 engine on a full matrix: heat also spreads sideways as it rises
+uint16_t mode_2Dfire(void) {
+  if (!strip.isMatrix) return mode_static(); // not a 2D set-up
+
+  const uint16_t cols = SEGMENT.virtualWidth();
+  const uint16_t rows = SEGMENT.virtualHeight();
+  if (rows < 3 || !SEGENV.allocateData(cols * rows)) return mode_static(); //allocation failed
+  uint8_t *heat = SEGENV.data;  // row 0 is the bottom of the matrix
+
+  const uint32_t it = strip.now >> 5; //div 32
+  const bool step = it != SEGENV.step;
+  const uint8_t ignition = max(3,rows/10);
+
+  fireCool(heat, rows, cols, ignition, step);
+  if (step) {
+    fireDrift(heat, rows, cols, true);
+    for (int x = 0; x < cols; x++)
+      if (random8() <= SEGMENT.intensity) fireSpark(heat, cols, x, ignition);
+    SEGENV.step = it;
+  }
+
+  uint32_t lut[16];
+  fireLUT(lut);
+  for (int y = 0; y < rows; y++) {
+    const uint8_t *row = heat + y * cols;
+    for (int x = 0; x < cols; x++) SEGMENT.setPixelColorXY(x, rows - 1 - y, lut[MIN(row[x],240) >> 4]);
+  }
+
+  return FRAMETIME;
+} // mode_2Dfire()
+static const char _data_FX_MODE_2DFIRE[] PROGMEM = "Fire 2D@Cooling,Spark rate,,,Boost;;!;2;sx=64,ix=160";
+
+
 //////////////////////////////
 //     2D Frizzles          //
 //////////////////////////////
@@ -4894,112 +5167,231 @@ static const char _data_FX_MODE_2DFRIZZLES[] PROGMEM = "Frizzles@X frequency,Y f
 ///////////////////////////////////////////
 //   2D Cellular Automata Game of life   //
 ///////////////////////////////////////////
-typedef struct ColorCount {
-  CRGB color;
-  int8_t count;
-} colorCount;
+// Cells are kept in bit planes (32 cells per machine word, one plane per cell state) and
+// neighbours of a whole word are counted at once using bit-sliced adders. Palette index of
+// each cell is kept in a separate byte plane so colors no longer need to be read back.
+#define GOL_RULE_LIFE       0 // B3/S23
+#define GOL_RULE_HIGHLIFE   1 // B36/S23
+#define GOL_RULE_BRIAN      2 // Brian's Brain: off -> on (2 neighbours) -> dying -> off
+#define GOL_RULE_WIREWORLD  3 // head -> tail -> wire -> head (1 or 2 neighbouring heads)
+#define GOL_HISTORY         4 // generations remembered for repetition detection
+
+typedef struct GoLState {
+  uint32_t hash[GOL_HISTORY]; // hashes of previous generations
+  uint32_t look;              // hash of palette and background color the cells were drawn with
+  uint16_t cols, rows;
+  uint8_t  rule;
+  uint8_t  cur;               // plane set holding current generation
+  uint8_t  hashIdx;
+  uint8_t  reserved;
+} golState;
+
+// bit i holds the cell left (west) or right (east) of cell i, wrapping around the row
+static inline uint32_t golWest(const uint32_t *row, unsigned w, unsigned cols) {
+  uint32_t carry = w ? row[w-1] >> 31 : (row[(cols-1)>>5] >> ((cols-1)&31)) & 1;
+  return (row[w] << 1) | carry;
+}
+static inline uint32_t golEast(const uint32_t *row, unsigned w, unsigned words, unsigned cols) {
+  if (w+1 < words) return (row[w] >> 1) | (row[w+1] << 31);
+  return (row[w] >> 1) | ((row[0] & 1) << ((cols-1)&31));
+}
+
+// add one neighbour word to bit-sliced counters s0..s3 (s3 is only set by 8 neighbours)
+static inline void golAdd(uint32_t &s0, uint32_t &s1, uint32_t &s2, uint32_t &s3, uint32_t v) {
+  uint32_t c0 = s0 & v; s0 ^= v;
+  uint32_t c1 = s1 & c0; s1 ^= c0;
+  s3 |= s2 & c1; s2 ^= c1;
+}
+
+// most frequent palette index among live neighbours of a cell
+static uint8_t golDominant(const uint32_t *live, const uint8_t *colors, unsigned words, int x, int y, int cols, int rows) {
+  uint8_t idx[8], cnt[8];
+  int n = 0;
+  for (int j = -1; j <= 1; j++) for (int i = -1; i <= 1; i++) {
+    if (i == 0 && j == 0) continue; // ignore itself
+    int xx = x+i, yy = y+j;
+    if (xx < 0) xx = cols-1; else if (xx >= cols) xx = 0;
+    if (yy < 0) yy = rows-1; else if (yy >= rows) yy = 0;
+    if (!((live[yy*words + (xx>>5)] >> (xx&31)) & 1)) continue;
+    uint8_t c = colors[yy*cols + xx];
+    int k = 0;
+    while (k < n && idx[k] != c) k++;
+    if (k == n) { idx[n] = c; cnt[n++] = 0; }
+    cnt[k]++;
+  }
+  if (n == 0) return random8();
+  int best = 0;
+  for (int k = 1; k < n; k++) if (cnt[k] > cnt[best]) best = k;
+  return idx[best];
+}
+
+static uint32_t golColor(const uint32_t *planes, uint8_t numPlanes, unsigned planeLen, unsigned words, uint8_t colorIdx, int x, int y, uint32_t bgc) {
+  const unsigned i = y*words + (x>>5);
+  const uint32_t b = 1UL << (x&31);
+  uint8_t fade;
+  if (planes[i] & b)                                      fade = 0;   // alive, on or head
+  else if (numPlanes > 1 && (planes[planeLen + i] & b))   fade = 128; // dying or tail
+  else if (numPlanes > 2 && (planes[2*planeLen + i] & b)) fade = 224; // wire
+  else return bgc;
+  return color_blend(SEGMENT.color_from_palette(colorIdx, false, PALETTE_SOLID_WRAP, 255), bgc, fade);
+}
 
 uint16_t mode_2Dgameoflife(void) { // Written by Ewoud Wijma, inspired by https://natureofcode.com/book/chapter-7-cellular-automata/ and https://github.com/DougHaber/nlife-color
   if (!strip.isMatrix) return mode_static(); // not a 2D set-up
 
   const uint16_t cols = SEGMENT.virtualWidth();
   const uint16_t rows = SEGMENT.virtualHeight();
-  const uint16_t dataSize = sizeof(CRGB) * SEGMENT.length();  // using width*height prevents reallocation if mirroring is enabled
-  const uint16_t crcBufferLen = 2; //(SEGMENT.width() + SEGMENT.height())*71/100; // roughly sqrt(2)/2 for better repetition detection (Ewowi)
+  // Conway's Life unless a checkmark selects another automaton (sliders are left alone so existing presets keep their rule)
+  const uint8_t  rule = SEGMENT.check3 ? GOL_RULE_WIREWORLD : SEGMENT.check2 ? GOL_RULE_BRIAN : SEGMENT.check1 ? GOL_RULE_HIGHLIFE : GOL_RULE_LIFE;
+  const uint8_t  numPlanes = rule == GOL_RULE_WIREWORLD ? 3 : rule == GOL_RULE_BRIAN ? 2 : 1;
+  const unsigned words = (cols + 31) >> 5;
+  const unsigned planeLen = words * rows;
+  const size_t   bitsSize = 2 * numPlanes * planeLen * sizeof(uint32_t); // current and next generation
+  const size_t   dataSize = sizeof(golState) + bitsSize + cols * rows;
 
-  if (!SEGENV.allocateData(dataSize + sizeof(uint16_t)*crcBufferLen)) return mode_static(); //allocation failed
-  CRGB *prevLeds = reinterpret_cast<CRGB*>(SEGENV.data);
-  uint16_t *crcBuffer = reinterpret_cast<uint16_t*>(SEGENV.data + dataSize); 
+  if (!SEGENV.allocateData(dataSize)) return mode_static(); //allocation failed
+  golState *gol    = reinterpret_cast<golState*>(SEGENV.data);
+  uint32_t *bits   = reinterpret_cast<uint32_t*>(SEGENV.data + sizeof(golState));
+  uint8_t  *colors = SEGENV.data + sizeof(golState) + bitsSize;
 
-  CRGB backgroundColor = SEGCOLOR(1);
+  const uint32_t bgc = SEGCOLOR(1);
+  const bool life = rule <= GOL_RULE_HIGHLIFE;
+  uint32_t look = (((2166136261UL ^ bgc) * 16777619UL) ^ (SEGMENT.options & 0x01CE)) * 16777619UL; // on, reverse, mirror, transpose
+  for (int i = 0; i < 256; i += 16) look = (look ^ SEGMENT.color_from_palette(i, false, PALETTE_SOLID_WRAP, 255)) * 16777619UL;
 
-  if (SEGENV.call == 0 || strip.now - SEGMENT.step > 3000) {
+  if (SEGENV.call == 0 || strip.now - SEGMENT.step > 3000 || gol->cols != cols || gol->rows != rows || gol->rule != rule) {
     SEGENV.step = strip.now;
-    SEGENV.aux0 = 0;
     random16_set_seed(millis()>>2); //seed the random generator
-
-    //give the leds random state and colors (based on intensity, colors from palette or all posible colors are chosen)
-    for (int x = 0; x < cols; x++) for (int y = 0; y < rows; y++) {
-      uint8_t state = random8()%2;
-      if (state == 0)
-        SEGMENT.setPixelColorXY(x,y, backgroundColor);
-      else
-        SEGMENT.setPixelColorXY(x,y, SEGMENT.color_from_palette(random8(), false, PALETTE_SOLID_WRAP, 255));
+    memset(SEGENV.data, 0, sizeof(golState) + bitsSize);
+    gol->cols = cols;
+    gol->rows = rows;
+    gol->rule = rule;
+
+    //give the cells random state and colors from the palette
+    for (int y = 0; y < rows; y++) for (int x = 0; x < cols; x++) {
+      const unsigned i = y*words + (x>>5);
+      const uint32_t b = 1UL << (x&31);
+      const uint8_t r = random8();
+      switch (rule) {
+        case GOL_RULE_BRIAN:     if (r < 64) bits[i] |= b; break;
+        case GOL_RULE_WIREWORLD: if (r < 12) bits[i] |= b; else if (r < 128) bits[2*planeLen + i] |= b; break;
+        default:                 if (r & 1)  bits[i] |= b; break;
+      }
+      colors[y*cols + x] = random8();
+      SEGMENT.setPixelColorXY(x, y, golColor(bits, numPlanes, planeLen, words, colors[y*cols + x], x, y, bgc));
     }
+    gol->look = look;
+    return FRAMETIME;
+  }
+
+  // only changed cells are drawn per generation, so redraw everything when colors or segment mapping change
+  if (look != gol->look) {
+    const uint32_t *cur = bits + (gol->cur ? numPlanes*planeLen : 0);
+    for (int y = 0; y < rows; y++) for (int x = 0; x < cols; x++)
+      SEGMENT.setPixelColorXY(x, y, golColor(cur, numPlanes, planeLen, words, colors[y*cols + x], x, y, bgc));
+    gol->look = look;
+  }
 
-    for (int y = 0; y < rows; y++) for (int x = 0; x < cols; x++) prevLeds[XY(x,y)] = CRGB::Black;
-    memset(crcBuffer, 0, sizeof(uint16_t)*crcBufferLen);
-  } else if (strip.now - SEGENV.step < FRAMETIME_FIXED * (uint32_t)map(SEGMENT.speed,0,255,64,4)) {
+  if (strip.now - SEGENV.step < FRAMETIME_FIXED * (uint32_t)map(SEGMENT.speed,0,255,64,4)) {
     // update only when appropriate time passes (in 42 FPS slots)
     return FRAMETIME;
   }
 
-  //copy previous leds (save previous generation)
-  //NOTE: using lossy getPixelColor() is a benefit as endlessly repeating patterns will eventually fade out causing a reset
-  for (int x = 0; x < cols; x++) for (int y = 0; y < rows; y++) prevLeds[XY(x,y)] = SEGMENT.getPixelColorXY(x,y);
-
-  //calculate new leds
-  for (int x = 0; x < cols; x++) for (int y = 0; y < rows; y++) {
-
-    colorCount colorsCount[9]; // count the different colors in the 3*3 matrix
-    for (int i=0; i<9; i++) colorsCount[i] = {backgroundColor, 0}; // init colorsCount
-
-    // iterate through neighbors and count them and their different colors
-    int neighbors = 0;
-    for (int i = -1; i <= 1; i++) for (int j = -1; j <= 1; j++) { // iterate through 3*3 matrix
-      if (i==0 && j==0) continue; // ignore itself
-      // wrap around segment
-      int16_t xx = x+i, yy = y+j;
-      if (x+i < 0) xx = cols-1; else if (x+i >= cols) xx = 0;
-      if (y+j < 0) yy = rows-1; else if (y+j >= rows) yy = 0;
-
-      uint16_t xy = XY(xx, yy); // previous cell xy to check
-      // count different neighbours and colors
-      if (prevLeds[xy] != backgroundColor) {
-        neighbors++;
-        bool colorFound = false;
-        int k;
-        for (k=0; k<9 && colorsCount[i].count != 0; k++)
-          if (colorsCount[k].color == prevLeds[xy]) {
-            colorsCount[k].count++;
-            colorFound = true;
-          }
-        if (!colorFound) colorsCount[k] = {prevLeds[xy], 1}; //add new color found in the array
+  const uint32_t *cur = bits + (gol->cur ? numPlanes*planeLen : 0);
+  uint32_t      *next = bits + (gol->cur ? 0 : numPlanes*planeLen);
+  const uint32_t lastMask = (cols & 31) ? (1UL << (cols & 31)) - 1 : 0xFFFFFFFFUL; // unused bits of last word in a row
+  uint32_t hash = 2166136261UL; // FNV-1a over state words, computed while the generation is built
+
+  for (int y = 0; y < rows; y++) {
+    const uint32_t *up  = cur + (y ? y-1 : rows-1) * words;
+    const uint32_t *row = cur + y * words;
+    const uint32_t *dn  = cur + (y+1 < rows ? y+1 : 0) * words;
+    for (unsigned w = 0; w < words; w++) {
+      const unsigned i = y*words + w;
+      const uint32_t mask  = w+1 < words ? 0xFFFFFFFFUL : lastMask;
+      const uint32_t alive = row[w];
+
+      // count live neighbours of 32 cells at once
+      uint32_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+      golAdd(s0, s1, s2, s3, golWest(up, w, cols));
+      golAdd(s0, s1, s2, s3, up[w]);
+      golAdd(s0, s1, s2, s3, golEast(up, w, words, cols));
+      golAdd(s0, s1, s2, s3, golWest(row, w, cols));
+      golAdd(s0, s1, s2, s3, golEast(row, w, words, cols));
+      golAdd(s0, s1, s2, s3, golWest(dn, w, cols));
+      golAdd(s0, s1, s2, s3, dn[w]);
+      golAdd(s0, s1, s2, s3, golEast(dn, w, words, cols));
+      const uint32_t few = ~s2 & ~s3; // less than 4
+      const uint32_t n1  =  s0 & ~s1 & few;
+      const uint32_t n2  = ~s0 &  s1 & few;
+      const uint32_t n3  =  s0 &  s1 & few;
+      const uint32_t n6  = ~s0 &  s1 & s2 & ~s3;
+
+      uint32_t born;
+      switch (rule) {
+        case GOL_RULE_BRIAN:     born = ~alive & ~cur[planeLen + i] & n2; break;
+        case GOL_RULE_WIREWORLD: born = cur[2*planeLen + i] & (n1 | n2);  break;
+        case GOL_RULE_HIGHLIFE:  born = ~alive & (n3 | n6);               break;
+        default:                 born = ~alive & n3;                      break;
+      }
+      born &= mask;
+
+      // born cells take the dominant color of their neighbours
+      for (uint32_t m = born; m; m &= m - 1) {
+        const unsigned b = __builtin_ctz(m);
+        const int x = (w << 5) + b;
+        if (life && !random8(128)) born &= ~(1UL << b); // a bit of randomness to avoid "gliders"
+        else colors[y*cols + x] = golDominant(cur, colors, words, x, y, cols, rows);
+      }
+      // mutation
+      if (life) for (uint32_t m = ~alive & n2 & mask; m; m &= m - 1) {
+        if (random8(128)) continue;
+        const unsigned b = __builtin_ctz(m);
+        born |= 1UL << b;
+        colors[y*cols + (w << 5) + b] = random8();
       }
-    } // i,j
-
-    // Rules of Life
-    uint32_t col = uint32_t(prevLeds[XY(x,y)]) & 0x00FFFFFF;  // uint32_t operator returns RGBA, we want RGBW -> cut off "alpha" byte
-    uint32_t bgc = RGBW32(backgroundColor.r, backgroundColor.g, backgroundColor.b, 0);
-    if      ((col != bgc) && (neighbors <  2)) SEGMENT.setPixelColorXY(x,y, bgc); // Loneliness
-    else if ((col != bgc) && (neighbors >  3)) SEGMENT.setPixelColorXY(x,y, bgc); // Overpopulation
-    else if ((col == bgc) && (neighbors == 3)) {                                  // Reproduction
-      // find dominant color and assign it to a cell
-      colorCount dominantColorCount = {backgroundColor, 0};
-      for (int i=0; i<9 && colorsCount[i].count != 0; i++)
-        if (colorsCount[i].count > dominantColorCount.count) dominantColorCount = colorsCount[i];
-      // assign the dominant color w/ a bit of randomness to avoid "gliders"
-      if (dominantColorCount.count > 0 && random8(128)) SEGMENT.setPixelColorXY(x,y, dominantColorCount.color);
-    } else if ((col == bgc) && (neighbors == 2) && !random8(128)) {               // Mutation
-      SEGMENT.setPixelColorXY(x,y, SEGMENT.color_from_palette(random8(), false, PALETTE_SOLID_WRAP, 255));
-    }
-    // else do nothing!
-  } //x,y
-
-  // calculate CRC16 of leds
-  uint16_t crc = crc16((const unsigned char*)prevLeds, dataSize);
-  // check if we had same CRC and reset if needed
+
+      switch (rule) {
+        case GOL_RULE_BRIAN:
+          next[i] = born;
+          next[planeLen + i] = alive;
+          break;
+        case GOL_RULE_WIREWORLD:
+          next[i] = born;
+          next[planeLen + i] = alive;
+          next[2*planeLen + i] = (cur[2*planeLen + i] & ~born) | cur[planeLen + i];
+          break;
+        default:
+          next[i] = born | (alive & (n2 | n3)); // Reproduction | Survival
+          break;
+      }
+
+      uint32_t changed = 0;
+      for (unsigned p = 0; p < numPlanes; p++) {
+        const uint32_t v = next[p*planeLen + i];
+        changed |= v ^ cur[p*planeLen + i];
+        hash = (hash ^ v) * 16777619UL;
+      }
+      // only cells that changed state need to be redrawn
+      for (; changed; changed &= changed - 1) {
+        const int x = (w << 5) + __builtin_ctz(changed);
+        SEGMENT.setPixelColorXY(x, y, golColor(next, numPlanes, planeLen, words, colors[y*cols + x], x, y, bgc));
+      }
+    }
+  }
+  gol->cur ^= 1;
+
+  // same hash would mean pattern did not change or is oscillating with a short period
   bool repetition = false;
-  for (int i=0; i<crcBufferLen && !repetition; i++) repetition = (crc == crcBuffer[i]); // (Ewowi)
-  // same CRC would mean image did not change or was repeating itself
+  for (int i=0; i<GOL_HISTORY && !repetition; i++) repetition = (hash == gol->hash[i]);
   if (!repetition) SEGENV.step = strip.now; //if no repetition avoid reset
-  // remember CRCs across frames
-  crcBuffer[SEGENV.aux0] = crc;
-  ++SEGENV.aux0 %= crcBufferLen;
+  // remember hashes across frames
+  gol->hash[gol->hashIdx] = hash;
+  ++gol->hashIdx %= GOL_HISTORY;
 
   return FRAMETIME;
 } // mode_2Dgameoflife()
-static const char _data_FX_MODE_2DGAMEOFLIFE[] PROGMEM = "Game Of Life@!;!,!;!;2";
+static const char _data_FX_MODE_2DGAMEOFLIFE[] PROGMEM = "Game Of Life@!,,,,,HighLife,Brian's Brain,Wireworld;!,!;!;2";
 
 
 /////////////////////////
@@ -5023,6 +5415,135 @@ uint16_t mode_2DHiphotic() {                        //  By: ldirko  https://edit
 static const char _data_FX_MODE_2DHIPHOTIC[] PROGMEM = "Hiphotic@X scale,Y scale,,,Speed;!;!;2";
 
 
+/////////////////////////
+//   Fractal renderer  //
+/////////////////////////
+// Escape-time renderer shared by Julia, Mandelbrot and Burning Ship.
+// Escape counts are kept per pixel so frames where only colors change do not iterate again.
+// Rendering is progressive: 8x8 tiles first, then 4x4, 2x2 and single pixels, spread over as many
+// frames as needed to stay within half of the frame time. A new view (or Julia constant) is picked
+// up once the current one is fully refined, changing kind or iterations restarts immediately.
+#if defined(ESP8266) || defined(CONFIG_IDF_TARGET_ESP32C3) || defined(CONFIG_IDF_TARGET_ESP32S2)
+  // no FPU: Q11.20 fixed point, |z|^2 stays below 16 before squaring so values never exceed ~600
+  typedef int32_t fractal_t;
+  #define FRACTAL_FROM(f)   ((fractal_t)((f) * (float)(1L<<20)))
+  #define FRACTAL_MUL(a,b)  ((fractal_t)(((int64_t)(a) * (b)) >> 20))
+#else
+  typedef float fractal_t;
+  #define FRACTAL_FROM(f)   ((fractal_t)(f))
+  #define FRACTAL_MUL(a,b)  ((a) * (b))
+#endif
+
+#define FRACTAL_JULIA       0
+#define FRACTAL_MANDELBROT  1
+#define FRACTAL_BURNINGSHIP 2
+#define FRACTAL_TILE_LEVEL  3 // coarsest tiles are 8x8 pixels
+
+typedef struct FractalView {
+  fractal_t x0, y0;   // top left corner
+  fractal_t dx, dy;   // pixel size
+  fractal_t cre, cim; // Julia constant
+} fractalView;
+
+typedef struct FractalState {
+  fractalView view;   // view being refined
+  float    xcen, ycen, xymag; // Julia position (moves with sliders)
+  uint16_t cols, rows;
+  uint16_t px, py;    // next pixel to compute in current level
+  uint8_t  kind;
+  uint8_t  maxIter;
+  uint8_t  level;     // tiles are 1<<level pixels wide
+  bool     done;
+} fractalState;
+
+static uint8_t fractalEscape(uint8_t kind, fractal_t a, fractal_t b, fractal_t cre, fractal_t cim, uint8_t maxIter) {
+  const fractal_t maxCalc = FRACTAL_FROM(16.0f); // How big is each calculation allowed to be before we give up.
+  uint8_t iter = 0;
+  while (iter < maxIter) {
+    fractal_t aa = FRACTAL_MUL(a, a);
+    fractal_t bb = FRACTAL_MUL(b, b);
+    if (aa + bb > maxCalc) break; // |z|^2 = a^2+b^2 to save on having to perform a square root.
+    if (kind == FRACTAL_BURNINGSHIP) {
+      if (a < 0) a = -a;
+      if (b < 0) b = -b;
+    }
+    // This operation corresponds to z -> z^2+c where z=a+ib. Remember to use 'foil'.
+    b = 2 * FRACTAL_MUL(a, b) + cim;
+    a = aa - bb + cre;
+    iter++;
+  }
+  return iter;
+}
+
+// allocates effect data, returns nullptr if not possible
+static fractalState* fractalData(uint16_t cols, uint16_t rows) {
+  if (!SEGENV.allocateData(sizeof(fractalState) + cols * rows)) return nullptr;
+  return reinterpret_cast<fractalState*>(SEGENV.data);
+}
+
+static uint16_t fractalRender(fractalState *fs, uint8_t kind, const fractalView &view, uint8_t maxIter, uint8_t colorShift) {
+  const uint16_t cols = SEGMENT.virtualWidth();
+  const uint16_t rows = SEGMENT.virtualHeight();
+  uint8_t *counts = SEGENV.data + sizeof(fractalState);
+
+  if (fs->cols != cols || fs->rows != rows || fs->kind != kind || fs->maxIter != maxIter ||
+      (fs->done && memcmp(&fs->view, &view, sizeof(fractalView)))) {
+    fs->view    = view;
+    fs->cols    = cols;
+    fs->rows    = rows;
+    fs->kind    = kind;
+    fs->maxIter = maxIter;
+    fs->level   = FRACTAL_TILE_LEVEL;
+    fs->px = fs->py = 0;
+    fs->done    = false;
+  }
+
+  // refine within time budget, previous picture stays visible where not yet recomputed
+  const uint32_t start  = micros();
+  const uint32_t budget = FRAMETIME * 500; // half of the frame time (us)
+  for (unsigned n = 0; !fs->done; n++) {
+    const unsigned tile = 1 << fs->level;
+    // pixels at even positions of the coarser level were already computed
+    if (fs->level == FRACTAL_TILE_LEVEL || (fs->px | fs->py) & tile) {
+      const fractal_t x = fs->view.x0 + fs->view.dx * (int)fs->px;
+      const fractal_t y = fs->view.y0 + fs->view.dy * (int)fs->py;
+      const uint8_t iter = kind == FRACTAL_JULIA ? fractalEscape(kind, x, y, fs->view.cre, fs->view.cim, maxIter)
+                                                 : fractalEscape(kind, 0, 0, x, y, maxIter);
+      for (unsigned j = fs->py; j < fs->py + tile && j < rows; j++)
+        memset(counts + j * cols + fs->px, iter, min(tile, unsigned(cols - fs->px)));
+    }
+    fs->px += tile;
+    if (fs->px >= cols) {
+      fs->px = 0;
+      fs->py += tile;
+      if (fs->py >= rows) {
+        fs->py = 0;
+        if (fs->level == 0) fs->done = true;
+        else                fs->level--;
+      }
+    }
+    if ((n & 7) == 7 && micros() - start > budget) break;
+  }
+
+  // We color each pixel based on how long it takes to get to infinity, or black if it never gets there.
+  uint32_t lut[256];
+  for (unsigned i = 0; i < maxIter; i++) lut[i] = SEGMENT.color_from_palette(i*255/maxIter + colorShift, false, PALETTE_SOLID_WRAP, 0);
+  lut[maxIter] = 0;
+  for (int j = 0; j < rows; j++) for (int i = 0; i < cols; i++) SEGMENT.setPixelColorXY(i, j, lut[counts[j * cols + i]]);
+
+  return FRAMETIME;
+}
+
+// view centered on cx,cy spanning w horizontally, pixel aspect is kept square
+static void fractalSetView(fractalView &view, float cx, float cy, float w, uint16_t cols, uint16_t rows) {
+  float d = w / cols;
+  view.x0 = FRACTAL_FROM(cx - d * cols / 2);
+  view.y0 = FRACTAL_FROM(cy - d * rows / 2);
+  view.dx = view.dy = FRACTAL_FROM(d);
+  view.cre = view.cim = 0;
+}
+
+
 /////////////////////////
 //     2D Julia        //
 /////////////////////////
@@ -5031,20 +5552,14 @@ static const char _data_FX_MODE_2DHIPHOTIC[] PROGMEM = "Hiphotic@X scale,Y scale
 // Custom1 = Location of X centerpoint
 // Custom2 = Location of Y centerpoint
 // Custom3 = Size of the area (small value = smaller area)
-typedef struct Julia {
-  float xcen;
-  float ycen;
-  float xymag;
-} julia;
-
 uint16_t mode_2DJulia(void) {                           // An animated Julia set by Andrew Tuline.
   if (!strip.isMatrix) return mode_static(); // not a 2D set-up
 
   const uint16_t cols = SEGMENT.virtualWidth();
   const uint16_t rows = SEGMENT.virtualHeight();
 
-  if (!SEGENV.allocateData(sizeof(julia))) return mode_static();
-  Julia* julias = reinterpret_cast<Julia*>(SEGENV.data);
+  fractalState *julias = fractalData(cols, rows);
+  if (!julias) return mode_static();
 
   float reAl;
   float imAg;
@@ -5077,14 +5592,7 @@ uint16_t mode_2DJulia(void) {                           // An animated Julia set
   ymin = constrain(ymin, -0.8f, 1.0f);
   ymax = constrain(ymax, -0.8f, 1.0f);
 
-  float dx;                       // Delta x is mapped to the matrix size.
-  float dy;                       // Delta y is mapped to the matrix size.
-
-  int maxIterations = 15;         // How many iterations per pixel before we give up. Make it 8 bits to match our range of colours.
-  float maxCalc = 16.0;           // How big is each calculation allowed to be before we give up.
-
-  maxIterations = SEGMENT.intensity/2;
-
+  uint8_t maxIterations = SEGMENT.intensity/2; // How many iterations per pixel before we give up.
 
   // Resize section on the fly for some animaton.
   reAl = -0.94299f;               // PixelBlaze example
@@ -5093,51 +5601,64 @@ uint16_t mode_2DJulia(void) {                           // An animated Julia set
   reAl += sin_t((float)millis()/305.f)/20.f;
   imAg += sin_t((float)millis()/405.f)/20.f;
 
-  dx = (xmax - xmin) / (cols);     // Scale the delta x and y values to our matrix size.
-  dy = (ymax - ymin) / (rows);
+  fractalView view;
+  view.x0  = FRACTAL_FROM(xmin);
+  view.y0  = FRACTAL_FROM(ymin);
+  view.dx  = FRACTAL_FROM((xmax - xmin) / cols);  // Scale the delta x and y values to our matrix size.
+  view.dy  = FRACTAL_FROM((ymax - ymin) / rows);
+  view.cre = FRACTAL_FROM(reAl);
+  view.cim = FRACTAL_FROM(imAg);
 
-  // Start y
-  float y = ymin;
-  for (int j = 0; j < rows; j++) {
+  return fractalRender(julias, FRACTAL_JULIA, view, maxIterations, 0);
+} // mode_2DJulia()
+static const char _data_FX_MODE_2DJULIA[] PROGMEM = "Julia@,Max iterations per pixel,X center,Y center,Area size;!;!;2;ix=24,c1=128,c2=128,c3=16";
 
-    // Start x
-    float x = xmin;
-    for (int i = 0; i < cols; i++) {
 
-      // Now we test, as we iterate z = z^2 + c does z tend towards infinity?
-      float a = x;
-      float b = y;
-      int iter = 0;
-
-      while (iter < maxIterations) {    // Here we determine whether or not we're out of bounds.
-        float aa = a * a;
-        float bb = b * b;
-        float len = aa + bb;
-        if (len > maxCalc) {            // |z| = sqrt(a^2+b^2) OR z^2 = a^2+b^2 to save on having to perform a square root.
-          break;  // Bail
-        }
+/////////////////////////
+//   2D Mandelbrot     //
+/////////////////////////
+// Sliders are:
+// speed = Color cycling speed
+// intensity = Maximum number of iterations per pixel.
+// Custom1 = Location of X centerpoint
+// Custom2 = Location of Y centerpoint
+// Custom3 = Zoom
+uint16_t mode_2Dmandelbrot(void) {
+  if (!strip.isMatrix) return mode_static(); // not a 2D set-up
 
-       // This operation corresponds to z -> z^2+c where z=a+ib c=(x,y). Remember to use 'foil'.
-        b = 2*a*b + imAg;
-        a = aa - bb + reAl;
-        iter++;
-      } // while
+  const uint16_t cols = SEGMENT.virtualWidth();
+  const uint16_t rows = SEGMENT.virtualHeight();
 
-      // We color each pixel based on how long it takes to get to infinity, or black if it never gets there.
-      if (iter == maxIterations) {
-        SEGMENT.setPixelColorXY(i, j, 0);
-      } else {
-        SEGMENT.setPixelColorXY(i, j, SEGMENT.color_from_palette(iter*255/maxIterations, false, PALETTE_SOLID_WRAP, 0));
-      }
-      x += dx;
-    }
-    y += dy;
-  }
-//  SEGMENT.blur(64);
+  fractalState *fs = fractalData(cols, rows);
+  if (!fs) return mode_static();
 
-  return FRAMETIME;
-} // mode_2DJulia()
-static const char _data_FX_MODE_2DJULIA[] PROGMEM = "Julia@,Max iterations per pixel,X center,Y center,Area size;!;!;2;ix=24,c1=128,c2=128,c3=16";
+  fractalView view;
+  fractalSetView(view, -0.75f + (SEGMENT.custom1 - 128) / 85.f, (SEGMENT.custom2 - 128) / 106.f,
+                 3.0f / powf(1.25f, SEGMENT.custom3), cols, rows);
+  return fractalRender(fs, FRACTAL_MANDELBROT, view, max(8, (int)SEGMENT.intensity), (strip.now * SEGMENT.speed) >> 14);
+} // mode_2Dmandelbrot()
+static const char _data_FX_MODE_2DMANDELBROT[] PROGMEM = "Mandelbrot@Color speed,Max iterations per pixel,X center,Y center,Zoom;!;!;2;sx=32,ix=48,c1=128,c2=128,c3=0";
+
+
+/////////////////////////
+//   2D Burning Ship   //
+/////////////////////////
+// Sliders as in Mandelbrot
+uint16_t mode_2Dburningship(void) {
+  if (!strip.isMatrix) return mode_static(); // not a 2D set-up
+
+  const uint16_t cols = SEGMENT.virtualWidth();
+  const uint16_t rows = SEGMENT.virtualHeight();
+
+  fractalState *fs = fractalData(cols, rows);
+  if (!fs) return mode_static();
+
+  fractalView view;
+  fractalSetView(view, -0.5f + (SEGMENT.custom1 - 128) / 64.f, -0.5f + (SEGMENT.custom2 - 128) / 85.f,
+                 3.5f / powf(1.25f, SEGMENT.custom3), cols, rows);
+  return fractalRender(fs, FRACTAL_BURNINGSHIP, view, max(8, (int)SEGMENT.intensity), (strip.now * SEGMENT.speed) >> 14);
+} // mode_2Dburningship()
+static const char _data_FX_MODE_2DBURNINGSHIP[] PROGMEM = "Burning Ship@Color speed,Max iterations per pixel,X center,Y center,Zoom;!;!;2;sx=32,ix=48,c1=128,c2=128,c3=0";
 
 
 //////////////////////////////
@@ -5313,9 +5834,11 @@ uint16_t mode_2Dnoise(void) {                  // By Andrew Tuline
 
   const uint16_t scale  = SEGMENT.intensity+2;
 
+  uint8_t noise[cols];
   for (int y = 0; y < rows; y++) {
+    fillNoise8(noise, cols, 0, scale << 8, (y * scale) << 8, 0, (millis() / (16 - SEGMENT.speed/16)) << 8);
     for (int x = 0; x < cols; x++) {
-      uint8_t pixelHue8 = inoise8(x * scale, y * scale, millis() / (16 - SEGMENT.speed/16));
+      uint8_t pixelHue8 = noise[x];
       SEGMENT.setPixelColorXY(x, y, ColorFromPalette(SEGPALETTE, pixelHue8));
     }
   }
@@ -5336,11 +5859,14 @@ uint16_t mode_2DPlasmaball(void) {                   // By: Stepko https://edito
 
   SEGMENT.fadeToBlackBy(SEGMENT.custom1>>2);
   uint_fast32_t t = (millis() * 8) / (256 - SEGMENT.speed);  // optimized to avoid float
+  uint8_t noiseX[cols], noiseY[rows];
+  fillNoise8(noiseX, cols, 0, 30 << 8, (t & 0xFFFF) << 8, 0, (t & 0xFFFF) << 8);
+  fillNoise8(noiseY, rows, (t & 0xFFFF) << 8, 0, 0, 30 << 8, (t & 0xFFFF) << 8);
   for (int i = 0; i < cols; i++) {
-    uint16_t thisVal = inoise8(i * 30, t, t);
+    uint16_t thisVal = noiseX[i];
     uint16_t thisMax = map(thisVal, 0, 255, 0, cols-1);
     for (int j = 0; j < rows; j++) {
-      uint16_t thisVal_ = inoise8(t, j * 30, t);
+      uint16_t thisVal_ = noiseY[j];
       uint16_t thisMax_ = map(thisVal_, 0, 255, 0, rows-1);
       uint16_t x = (i + thisMax_ - cols / 2);
       uint16_t y = (j + thisMax - cols / 2);
@@ -5401,6 +5927,7 @@ uint16_t mode_2DPolarLights(void) {        // By: Kostyantyn Matviyevskyy  https
   uint16_t _scale = map(SEGMENT.intensity, 0, 255, 30, adjScale);
   byte _speed = map(SEGMENT.speed, 0, 255, 128, 16);
 
+  // step advances per pixel (x jitter, y offset and z all depend on it), so noise is sampled one pixel at a time
   for (int x = 0; x < cols; x++) {
     for (int y = 0; y < rows; y++) {
       SEGENV.step++;
@@ -6034,7 +6561,8 @@ static const char _data_FX_MODE_2DDRIFTROSE[] PROGMEM = "Drift Rose@Fade,Blur;;;
   bool      samplePeak = false;
   float     FFT_MajorPeak = 1.0;
   uint8_t  *fftResult = nullptr;
-  float    *fftBin = nullptr;
+  float     beatBpm = 120.0f, beatPhase = 0.0f;
+  uint8_t   beatConfidence = 0;
   um_data_t *um_data;
   if (usermods.getUMData(&um_data, USERMOD_ID_AUDIOREACTIVE)) {
     volumeSmth    = *(float*)   um_data->u_data[0];
@@ -6045,7 +6573,9 @@ static const char _data_FX_MODE_2DDRIFTROSE[] PROGMEM = "Drift Rose@Fade,Blur;;;
     my_magnitude  = *(float*)   um_data->u_data[5];
     maxVol        =  (uint8_t*) um_data->u_data[6];  // requires UI element (SEGMENT.customX?), changes source element
     binNum        =  (uint8_t*) um_data->u_data[7];  // requires UI element (SEGMENT.customX?), changes source element
-    fftBin        =  (float*)   um_data->u_data[8];
+    beatBpm        = *(float*)   um_data->u_data[8];  // tempo estimate
+    beatPhase      = *(float*)   um_data->u_data[9];  // 0..1, 0 = on the beat
+    beatConfidence = *(uint8_t*) um_data->u_data[10]; // 0..255
   } else {
     // add support for no audio data
     um_data = simulateSound(SEGMENT.soundSim);
@@ -6212,8 +6742,10 @@ uint16_t mode_2DWaverly(void) {
   SEGMENT.fadeToBlackBy(SEGMENT.speed);
 
   long t = millis() / 2;
+  uint8_t noise[cols];
+  fillNoise8(noise, cols, 0, 45 << 8, (t & 0xFFFF) << 8, 0, (t & 0xFFFF) << 8);
   for (int i = 0; i < cols; i++) {
-    uint16_t thisVal = (1 + SEGMENT.intensity/64) * inoise8(i * 45 , t , t)/2;
+    uint16_t thisVal = (1 + SEGMENT.intensity/64) * noise[i]/2;
     // use audio if available
     if (um_data) {
       thisVal /= 32; // reduce intensity of inoise8()
@@ -6272,8 +6804,10 @@ uint16_t mode_gravcenter(void) {                // Gravcenter. By Andrew Tuline.
   uint16_t tempsamp = constrain(mySampleAvg, 0, SEGLEN/2);     // Keep the sample from overflowing.
   uint8_t gravity = 8 - SEGMENT.speed/32;
 
+  uint8_t noise[NOISE_BLOCK];
   for (int i=0; i<tempsamp; i++) {
-    uint8_t index = inoise8(i*segmentSampleAvg+millis(), 5000+i*segmentSampleAvg);
+    if (i % NOISE_BLOCK == 0) fillNoise8(noise, MIN(tempsamp - i, NOISE_BLOCK), uint32_t(i*segmentSampleAvg+millis()) << 8, segmentSampleAvg*256, uint32_t(5000+i*segmentSampleAvg) << 8, segmentSampleAvg*256);
+    uint8_t index = noise[i % NOISE_BLOCK];
     SEGMENT.setPixelColor(i+SEGLEN/2, color_blend(SEGCOLOR(1), SEGMENT.color_from_palette(index, false, PALETTE_SOLID_WRAP, 0), segmentSampleAvg*8));
     SEGMENT.setPixelColor(SEGLEN/2-i-1, color_blend(SEGCOLOR(1), SEGMENT.color_from_palette(index, false, PALETTE_SOLID_WRAP, 0), segmentSampleAvg*8));
   }
@@ -6373,8 +6907,10 @@ uint16_t mode_gravimeter(void) {                // Gravmeter. By Andrew Tuline.
   int tempsamp = constrain(mySampleAvg,0,SEGLEN-1);       // Keep the sample from overflowing.
   uint8_t gravity = 8 - SEGMENT.speed/32;
 
+  uint8_t noise[NOISE_BLOCK];
   for (int i=0; i<tempsamp; i++) {
-    uint8_t index = inoise8(i*segmentSampleAvg+millis(), 5000+i*segmentSampleAvg);
+    if (i % NOISE_BLOCK == 0) fillNoise8(noise, MIN(tempsamp - i, NOISE_BLOCK), uint32_t(i*segmentSampleAvg+millis()) << 8, segmentSampleAvg*256, uint32_t(5000+i*segmentSampleAvg) << 8, segmentSampleAvg*256);
+    uint8_t index = noise[i % NOISE_BLOCK];
     SEGMENT.setPixelColor(i, color_blend(SEGCOLOR(1), SEGMENT.color_from_palette(index, false, PALETTE_SOLID_WRAP, 0), segmentSampleAvg*8));
   }
 
@@ -6472,8 +7008,11 @@ uint16_t mode_midnoise(void) {                  // Midnoise. By Andrew Tuline.
   int maxLen = mapf(tmpSound2, 0, 127, 0, SEGLEN/2);
   if (maxLen >SEGLEN/2) maxLen = SEGLEN/2;
 
+  uint8_t noise[NOISE_BLOCK];
   for (int i=(SEGLEN/2-maxLen); i<(SEGLEN/2+maxLen); i++) {
-    uint8_t index = inoise8(i*volumeSmth+SEGENV.aux0, SEGENV.aux1+i*volumeSmth);  // Get a value from the noise function. I'm using both x and y axis.
+    int k = i - (SEGLEN/2-maxLen);
+    if (k % NOISE_BLOCK == 0) fillNoise8(noise, MIN(2*maxLen - k, NOISE_BLOCK), uint32_t(i*volumeSmth+SEGENV.aux0) << 8, volumeSmth*256, uint32_t(SEGENV.aux1+i*volumeSmth) << 8, volumeSmth*256);
+    uint8_t index = noise[k % NOISE_BLOCK];                                       // Get a value from the noise function. I'm using both x and y axis.
     SEGMENT.setPixelColor(i, SEGMENT.color_from_palette(index, false, PALETTE_SOLID_WRAP, 0));
   }
 
@@ -6504,8 +7043,11 @@ uint16_t mode_noisefire(void) {                 // Noisefire. By Andrew Tuline.
 
   if (SEGENV.call == 0) SEGMENT.fill(BLACK);
 
+  uint8_t noise[NOISE_BLOCK];
   for (int i = 0; i < SEGLEN; i++) {
-    uint16_t index = inoise8(i*SEGMENT.speed/64,millis()*SEGMENT.speed/64*SEGLEN/255);  // X location is constant, but we move along the Y at the rate of millis(). By Andrew Tuline.
+    // X location is constant, but we move along the Y at the rate of millis(). By Andrew Tuline.
+    if (i % NOISE_BLOCK == 0) fillNoise8(noise, MIN(SEGLEN - i, NOISE_BLOCK), uint32_t(i*SEGMENT.speed) << 2, SEGMENT.speed << 2, uint32_t(millis()*SEGMENT.speed/64*SEGLEN/255) << 8);
+    uint16_t index = noise[i % NOISE_BLOCK];
     index = (255 - i*256/SEGLEN) * index/(256-SEGMENT.intensity);                       // Now we need to scale index so that it gets blacker as we get close to one of the ends.
                                                                                         // This is a simple y=mx+b equation that's been scaled. index/128 is another scaling.
 
@@ -6540,8 +7082,10 @@ uint16_t mode_noisemeter(void) {                // Noisemeter. By Andrew Tuline.
   if (maxLen <0) maxLen = 0;
   if (maxLen >SEGLEN) maxLen = SEGLEN;
 
+  uint8_t noise[NOISE_BLOCK];
   for (int i=0; i<maxLen; i++) {                                    // The louder the sound, the wider the soundbar. By Andrew Tuline.
-    uint8_t index = inoise8(i*volumeSmth+SEGENV.aux0, SEGENV.aux1+i*volumeSmth);  // Get a value from the noise function. I'm using both x and y axis.
+    if (i % NOISE_BLOCK == 0) fillNoise8(noise, MIN(maxLen - i, NOISE_BLOCK), uint32_t(i*volumeSmth+SEGENV.aux0) << 8, volumeSmth*256, uint32_t(SEGENV.aux1+i*volumeSmth) << 8, volumeSmth*256);
+    uint8_t index = noise[i % NOISE_BLOCK];                                       // Get a value from the noise function. I'm using both x and y axis.
     SEGMENT.setPixelColor(i, SEGMENT.color_from_palette(index, false, PALETTE_SOLID_WRAP, 0));
   }
 
@@ -7077,8 +7621,10 @@ uint16_t mode_noisemove(void) {                 // Noisemove.    By: Andrew Tuli
   if ((fadeoutDelay <= 1 ) || ((SEGENV.call % fadeoutDelay) == 0)) SEGMENT.fadeToBlackBy(4+ SEGMENT.speed/4);
 
   uint8_t numBins = map(SEGMENT.intensity,0,255,0,16);    // Map slider to fftResult bins.
+  uint16_t noise[16];
+  fillNoise16(noise, numBins, millis()*SEGMENT.speed, 50000, millis()*SEGMENT.speed); // Get new pixel locations from moving noise.
   for (int i=0; i<numBins; i++) {                         // How many active bins are we using.
-    uint16_t locn = inoise16(millis()*SEGMENT.speed+i*50000, millis()*SEGMENT.speed);   // Get a new pixel location from moving noise.
+    uint16_t locn = noise[i];
     locn = map(locn, 7500, 58000, 0, SEGLEN-1);           // Map that to the length of the strand, and ensure we don't go over.
     SEGMENT.setPixelColor(locn, color_blend(SEGCOLOR(1), SEGMENT.color_from_palette(i*64, false, PALETTE_SOLID_WRAP, 0), fftResult[i % 16]*4));
   }
@@ -7485,11 +8031,12 @@ uint16_t mode_2Dsoap() {
     *noise32_z += mov;
   }
 
+  uint8_t noise[rows];
   for (int i = 0; i < cols; i++) {
     int32_t ioffset = scale32_x * (i - cols / 2);
+    fillNoise8(noise, rows, *noise32_x + ioffset, 0, *noise32_y - scale32_y * (rows / 2), scale32_y, *noise32_z);
     for (int j = 0; j < rows; j++) {
-      int32_t joffset = scale32_y * (j - rows / 2);
-      uint8_t data = inoise16(*noise32_x + ioffset, *noise32_y + joffset, *noise32_z) >> 8;
+      uint8_t data = noise[j];
       noise3d[XY(i,j)] = scale8(noise3d[XY(i,j)], smoothness) + scale8(data, 255 - smoothness);
     }
   }
@@ -7848,6 +8395,7 @@ void WS2812FX::setupEffectData() {
   addEffect(FX_MODE_2DNOISE, &mode_2Dnoise, _data_FX_MODE_2DNOISE);
 
   addEffect(FX_MODE_2DFIRENOISE, &mode_2Dfirenoise, _data_FX_MODE_2DFIRENOISE);
+  addEffect(FX_MODE_2DFIRE, &mode_2Dfire, _data_FX_MODE_2DFIRE);
   addEffect(FX_MODE_2DSQUAREDSWIRL, &mode_2Dsquaredswirl, _data_FX_MODE_2DSQUAREDSWIRL);
 
   //non audio
@@ -7863,6 +8411,8 @@ void WS2812FX::setupEffectData() {
   addEffect(FX_MODE_2DSUNRADIATION, &mode_2DSunradiation, _data_FX_MODE_2DSUNRADIATION);
   addEffect(FX_MODE_2DCOLOREDBURSTS, &mode_2DColoredBursts, _data_FX_MODE_2DCOLOREDBURSTS);
   addEffect(FX_MODE_2DJULIA, &mode_2DJulia, _data_FX_MODE_2DJULIA);
+  addEffect(FX_MODE_2DMANDELBROT, &mode_2Dmandelbrot, _data_FX_MODE_2DMANDELBROT);
+  addEffect(FX_MODE_2DBURNINGSHIP, &mode_2Dburningship, _data_FX_MODE_2DBURNINGSHIP);
 
   addEffect(FX_MODE_2DGAMEOFLIFE, &mode_2Dgameoflife, _data_FX_MODE_2DGAMEOFLIFE);
   addEffect(FX_MODE_2DTARTAN, &mode_2Dtartan, _data_FX_MODE_2DTARTAN);
@@ -319,8 +319,11 @@
 #define FX_MODE_WAVESINS               184
 #define FX_MODE_ROCKTAVES              185
 #define FX_MODE_2DAKEMI                186
+#define FX_MODE_2DFIRE                 187
+#define FX_MODE_2DMANDELBROT           188
+#define FX_MODE_2DBURNINGSHIP          189
 
-#define MODE_COUNT                     187
+#define MODE_COUNT                     190
 
 typedef enum mapping1D2D {
   M12_Pixels = 0,
@@ -405,6 +408,19 @@ typedef struct Segment {
       {}
     } tmpsegd_t;
 
+    // compact copy of the user-visible segment settings, used for change detection
+    // without copying the whole segment (no name or effect data allocation)
+    typedef struct SegmentSnapshot {
+      uint16_t start, stop, offset;
+      uint16_t options;
+      uint32_t colors[NUM_COLORS];
+      uint8_t  speed, intensity, palette, mode;
+      uint8_t  grouping, spacing, opacity, cct;
+      uint8_t  custom1, custom2;
+      uint8_t  custom3checks;       // custom3 + check1-3 bitfield
+      uint8_t  startY, stopY;
+    } segsnap_t;
+
   private:
     union {
       uint8_t  _capabilities;
@@ -544,7 +560,8 @@ typedef struct Segment {
     void    setOption(uint8_t n, bool val);
     void    setMode(uint8_t fx, bool loadDefaults = false);
     void    setPalette(uint8_t pal);
-    uint8_t differs(Segment& b) const;
+    void    snapshot(segsnap_t &snap) const;
+    uint8_t differs(const segsnap_t &b) const; // SEG_DIFFERS_* flags of settings changed since snapshot
     void    refreshLightCapabilities(void);
 
     // runtime data functions
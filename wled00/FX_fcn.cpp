@@ -859,29 +859,45 @@ uint32_t Segment::getPixelColor(int i)
   return strip.getPixelColor(i);
 }
 
-uint8_t Segment::differs(Segment& b) const {
+void Segment::snapshot(segsnap_t &snap) const {
+  snap.start     = start;
+  snap.stop      = stop;
+  snap.offset    = offset;
+  snap.options   = options;
+  for (unsigned i = 0; i < NUM_COLORS; i++) snap.colors[i] = colors[i];
+  snap.speed     = speed;
+  snap.intensity = intensity;
+  snap.palette   = palette;
+  snap.mode      = mode;
+  snap.grouping  = grouping;
+  snap.spacing   = spacing;
+  snap.opacity   = opacity;
+  snap.cct       = cct;
+  snap.custom1   = custom1;
+  snap.custom2   = custom2;
+  snap.custom3checks = custom3 | (check1 << 5) | (check2 << 6) | (check3 << 7);
+  snap.startY    = startY;
+  snap.stopY     = stopY;
+}
+
+uint8_t Segment::differs(const segsnap_t &b) const {
   uint8_t d = 0;
-  if (start != b.start)         d |= SEG_DIFFERS_BOUNDS;
-  if (stop != b.stop)           d |= SEG_DIFFERS_BOUNDS;
-  if (offset != b.offset)       d |= SEG_DIFFERS_GSO;
-  if (grouping != b.grouping)   d |= SEG_DIFFERS_GSO;
-  if (spacing != b.spacing)     d |= SEG_DIFFERS_GSO;
-  if (opacity != b.opacity)     d |= SEG_DIFFERS_BRI;
-  if (mode != b.mode)           d |= SEG_DIFFERS_FX;
-  if (speed != b.speed)         d |= SEG_DIFFERS_FX;
-  if (intensity != b.intensity) d |= SEG_DIFFERS_FX;
-  if (palette != b.palette)     d |= SEG_DIFFERS_FX;
-  if (custom1 != b.custom1)     d |= SEG_DIFFERS_FX;
-  if (custom2 != b.custom2)     d |= SEG_DIFFERS_FX;
-  if (custom3 != b.custom3)     d |= SEG_DIFFERS_FX;
-  if (startY != b.startY)       d |= SEG_DIFFERS_BOUNDS;
-  if (stopY != b.stopY)         d |= SEG_DIFFERS_BOUNDS;
-
-  //bit pattern: (msb first) set:2, sound:1, mapping:3, transposed, mirrorY, reverseY, [transitional, reset,] paused, mirrored, on, reverse, [selected]
+  if (start != b.start || stop != b.stop)       d |= SEG_DIFFERS_BOUNDS;
+  if (startY != b.startY || stopY != b.stopY)   d |= SEG_DIFFERS_BOUNDS;
+  if (offset != b.offset)                       d |= SEG_DIFFERS_GSO;
+  if (grouping != b.grouping)                   d |= SEG_DIFFERS_GSO;
+  if (spacing != b.spacing)                     d |= SEG_DIFFERS_GSO;
+  if (opacity != b.opacity)                     d |= SEG_DIFFERS_BRI;
+  if (mode != b.mode || speed != b.speed)       d |= SEG_DIFFERS_FX;
+  if (intensity != b.intensity)                 d |= SEG_DIFFERS_FX;
+  if (palette != b.palette)                     d |= SEG_DIFFERS_FX;
+  if (custom1 != b.custom1)                     d |= SEG_DIFFERS_FX;
+  if (custom2 != b.custom2)                     d |= SEG_DIFFERS_FX;
+  if ((custom3 | (check1 << 5) | (check2 << 6) | (check3 << 7)) != b.custom3checks) d |= SEG_DIFFERS_FX;
   if ((options & 0b1111111110011110U) != (b.options & 0b1111111110011110U)) d |= SEG_DIFFERS_OPT;
   if ((options & 0x0001U) != (b.options & 0x0001U))                         d |= SEG_DIFFERS_SEL;
-  for (uint8_t i = 0; i < NUM_COLORS; i++) if (colors[i] != b.colors[i])    d |= SEG_DIFFERS_COL;
-
+  if (cct != b.cct)                                                         d |= SEG_DIFFERS_COL;
+  for (unsigned i = 0; i < NUM_COLORS; i++) if (colors[i] != b.colors[i])   d |= SEG_DIFFERS_COL;
   return d;
 }
 
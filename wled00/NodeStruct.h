@@ -5,7 +5,6 @@
 * NodeStruct from the ESP Easy project (https://github.com/letscontrolit/ESPEasy)
 \*********************************************************************************************/
 
-#include <map>
 #include <IPAddress.h>
 
 #define NODE_TYPE_ID_UNDEFINED        0
@@ -15,14 +14,25 @@
 #define NODE_TYPE_ID_ESP32S3         34
 #define NODE_TYPE_ID_ESP32C3         35
 
+#define NODE_FLAG_TIMESYNC         0x01 // takes part in effect clock synchronisation
+
+#define NODE_NAME_LEN                32 // as sent in node info packets
+#define NODE_AGE_TICK             30000 // ms per age unit (node info is broadcast every 30s)
+#define NODE_EXPIRE                  10 // nodes not heard of for this many ticks are dropped
+
+// open addressing slots, ~80% max. load keeps linear probe sequences short
+#define WLED_NODE_SLOTS (WLED_MAX_NODES + WLED_MAX_NODES/4)
+#define WLED_NODE_SLOTS_MIN 8 // initial slots, doubled (up to WLED_NODE_SLOTS) when load exceeds 80%
+
 /*********************************************************************************************\
 * NodeStruct
 \*********************************************************************************************/
 struct NodeStruct
 {
-  String    nodeName;
-  IPAddress ip;
-  uint8_t   age;
+  uint32_t  ip;         // IPAddress as uint32_t, 0 marks a free slot
+  uint32_t  lastSeen;   // millis() of last node info
+  uint32_t  build;
+  char      nodeName[NODE_NAME_LEN+1];
   union {
     uint8_t nodeType;   // a waste of space as we only have 5 types
     struct {
@@ -30,13 +40,45 @@ struct NodeStruct
       bool    on   : 1;
     };
   };
-  uint32_t  build;
+  uint8_t   flags;      // NODE_FLAG_*
+
+  inline IPAddress address() const { return IPAddress(ip); }
+  // ticks since last node info, kept for compatibility with the old age counter
+  inline uint8_t age() const { uint32_t a = (millis() - lastSeen) / NODE_AGE_TICK; return a > 255 ? 255 : a; }
+};
+
+/*********************************************************************************************\
+* NodeTable: open addressed (linear probing) table of nodes keyed by IP, up to WLED_MAX_NODES.
+* Starts with WLED_NODE_SLOTS_MIN slots on first use and grows (rehashing) as nodes appear, names
+* are stored inline. Removal shifts following entries back (no tombstones).
+* Modified by the main loop only. Iterate there with:
+*   for (size_t i = 0; i < Nodes.slots(); i++) { NodeStruct *n = Nodes.at(i); if (!n) continue; ... }
+* async handlers use get() which copies a slot while the table can not be reallocated.
+\*********************************************************************************************/
+class NodeTable
+{
+  public:
+    NodeTable() : _nodes(nullptr), _slots(0), _count(0), _cursor(0) {}
+
+    NodeStruct* find(IPAddress ip);
+    NodeStruct* add(IPAddress ip);          // finds or creates entry, nullptr if full
+    void        clear();
+    void        refresh(uint16_t slots);    // drops expired nodes, checking at most slots entries per call
+    bool        get(uint16_t i, NodeStruct &node); // copies the node in slot i, false if empty
+
+    inline uint16_t    size() const  { return _count; }
+    inline uint16_t    slots() const { return _slots; }
+    inline NodeStruct* at(uint16_t i) { return (_nodes && i < _slots && _nodes[i].ip) ? &_nodes[i] : nullptr; }
+
+  private:
+    NodeStruct *_nodes;
+    uint16_t    _slots;
+    uint16_t    _count;
+    uint16_t    _cursor;                    // ageing position
 
-  NodeStruct() : age(0), nodeType(0), build(0)
-  {
-    for (uint8_t i = 0; i < 4; ++i) { ip[i] = 0; }
-  }
+    static inline uint16_t home(uint32_t ip, uint16_t slots) { return (ip * 2654435761UL) % slots; }
+    bool grow();
+    void removeSlot(uint16_t i);
 };
-typedef std::map<uint8_t, NodeStruct> NodesMap;
 
 #endif // WLED_NODESTRUCT_H
@@ -0,0 +1,205 @@
+#include "wled.h"
+
+/*
+ * Binary control API
+ *
+ * Compact fixed layout commands for high rate parameter streaming (show control software), accepted
+ * as binary websocket messages and as UDP datagrams on the notifier port. Commands are applied to
+ * segments directly, without JSON and without taking the JSON buffer lock. Websocket messages arrive in
+ * the async web server task (ESP32) and are only copied into a short queue there, they are applied
+ * (and acknowledged) in order by the main loop so segments are never changed while being rendered.
+ *
+ * Message: [0] BINAPI_MAGIC
+ *          [1] flags: bit 0 request acknowledge, bit 1 no sync notification
+ *          [2-3] sequence number (big endian, echoed in acknowledge)
+ *          [4-] any number of ops: [opcode] [segment id] [payload of fixed length]
+ *                segment id 255 applies to all selected segments (global for BRI/ON)
+ * Ops:     0x01 BRI  bri                  brightness (global) or segment opacity
+ *          0x02 ON   on                   0 = off, 1 = on
+ *          0x03 COL  slot, r, g, b, w     segment color slot 0-2
+ *          0x04 FX   fx                   effect
+ *          0x05 SX   speed
+ *          0x06 IX   intensity
+ *          0x07 PAL  palette
+ *          0x08 CUST slot, value          custom slider 1-3 (slot 3 is 0-31)
+ *          0x09 CCT  cct hi, cct lo       0-255 or Kelvin
+ *          0x0A PAR  fx, sx, ix, pal, c1, c2, c3 (all effect parameters at once)
+ *          0x0B TT   tt hi, tt lo         transition for this message (100ms units), should be first
+ * Acknowledge: [BINAPI_MAGIC] [flags] [sequence hi] [sequence lo] [ops applied] [status]
+ *          status 0 = ok, 1 = unknown opcode or truncated op (ops up to that point are applied),
+ *          2 = queue full, nothing applied
+ */
+
+#define BINAPI_FLAG_ACK      0x01
+#define BINAPI_FLAG_NONOTIFY 0x02
+#define BINAPI_HEADER        4
+
+#ifdef ESP8266
+  #define BINAPI_QUEUE_LEN   4
+#else
+  #define BINAPI_QUEUE_LEN   8
+#endif
+
+#define BINOP_BRI   0x01
+#define BINOP_ON    0x02
+#define BINOP_COL   0x03
+#define BINOP_FX    0x04
+#define BINOP_SX    0x05
+#define BINOP_IX    0x06
+#define BINOP_PAL   0x07
+#define BINOP_CUST  0x08
+#define BINOP_CCT   0x09
+#define BINOP_PAR   0x0A
+#define BINOP_TT    0x0B
+
+// payload length per opcode
+static const uint8_t binOpLen[] PROGMEM = { 0, 1, 1, 5, 1, 1, 1, 1, 2, 2, 7, 2 };
+
+static inline void binSet(uint8_t &field, uint8_t v) {
+  if (field == v) return;
+  field = v;
+  stateChanged = true; // send UDP/WS broadcast
+}
+
+static void binApplySeg(Segment &seg, uint8_t op, const uint8_t *p) {
+  switch (op) {
+    case BINOP_BRI: seg.setOpacity(p[0]); break;
+    case BINOP_ON:  seg.setOption(SEG_OPTION_ON, p[0]); break;
+    case BINOP_COL: if (p[0] < NUM_COLORS) seg.setColor(p[0], RGBW32(p[1], p[2], p[3], p[4])); break;
+    case BINOP_FX:  seg.setMode(p[0]); break;
+    case BINOP_SX:  binSet(seg.speed, p[0]); break;
+    case BINOP_IX:  binSet(seg.intensity, p[0]); break;
+    case BINOP_PAL: seg.setPalette(p[0]); break;
+    case BINOP_CUST:
+      if      (p[0] == 1) binSet(seg.custom1, p[1]);
+      else if (p[0] == 2) binSet(seg.custom2, p[1]);
+      else if (p[0] == 3 && seg.custom3 != min(p[1], (uint8_t)31)) { seg.custom3 = min(p[1], (uint8_t)31); stateChanged = true; }
+      break;
+    case BINOP_CCT: seg.setCCT((p[0] << 8) | p[1]); break;
+    case BINOP_PAR:
+      seg.setMode(p[0]);
+      binSet(seg.speed, p[1]);
+      binSet(seg.intensity, p[2]);
+      seg.setPalette(p[3]);
+      binSet(seg.custom1, p[4]);
+      binSet(seg.custom2, p[5]);
+      if (seg.custom3 != min(p[6], (uint8_t)31)) { seg.custom3 = min(p[6], (uint8_t)31); stateChanged = true; }
+      break;
+  }
+}
+
+// applies a binary control message, returns the length of the acknowledge written to reply (BINAPI_ACK_LEN bytes) if requested
+size_t handleBinaryControl(const uint8_t *msg, size_t len, uint8_t *reply, byte callMode) {
+  if (len < BINAPI_HEADER || msg[0] != BINAPI_MAGIC) return 0;
+  const uint8_t flags = msg[1];
+  uint8_t applied = 0, status = 0;
+
+  for (size_t i = BINAPI_HEADER; i < len; ) {
+    uint8_t op = msg[i];
+    if (op == 0 || op >= sizeof(binOpLen) || i + 2 + pgm_read_byte(binOpLen + op) > len) { status = 1; break; }
+    uint8_t id = msg[i+1];
+    const uint8_t *p = msg + i + 2;
+    i += 2 + pgm_read_byte(binOpLen + op);
+    applied++;
+
+    if (op == BINOP_TT) {
+      transitionDelayTemp = min(((uint32_t)p[0] << 8 | p[1]) * 100, (uint32_t)65535);
+      jsonTransitionOnce = true;
+      strip.setTransition(transitionDelayTemp);
+      continue;
+    }
+    if (id == 255 && op == BINOP_BRI) { bri = p[0]; continue; }
+    if (id == 255 && op == BINOP_ON)  { if (bool(p[0]) != (bri > 0)) toggleOnOff(); continue; }
+
+    if (id != 255) {
+      if (id < strip.getSegmentsNum() && strip.getSegment(id).isActive()) binApplySeg(strip.getSegment(id), op, p);
+      continue;
+    }
+    for (size_t s = 0; s < strip.getSegmentsNum(); s++) {
+      Segment &seg = strip.getSegment(s);
+      if (seg.isActive() && seg.isSelected()) binApplySeg(seg, op, p);
+    }
+  }
+
+  if (applied) {
+    strip.trigger();
+    stateUpdated((flags & BINAPI_FLAG_NONOTIFY) ? CALL_MODE_NO_NOTIFY : callMode);
+  }
+
+  if (!(flags & BINAPI_FLAG_ACK) || !reply) return 0;
+  reply[0] = BINAPI_MAGIC;
+  reply[1] = flags;
+  reply[2] = msg[2];
+  reply[3] = msg[3];
+  reply[4] = applied;
+  reply[5] = status;
+  return BINAPI_ACK_LEN;
+}
+
+// websocket messages waiting for the main loop, copies are allocated by the sender
+typedef struct BinApiQueued {
+  uint8_t *msg;
+  uint16_t len;
+  uint32_t client;
+} binapiq_t;
+
+static binapiq_t        binQueue[BINAPI_QUEUE_LEN] = {};
+static uint8_t          binQueueHead  = 0;
+static volatile uint8_t binQueueCount = 0;  // only decreased by the main loop
+WLED_ASYNC_MUX(binQueueMux);
+
+// queues a copy of a binary control message received by websocket client (async web server task), false if full
+bool queueBinaryControl(const uint8_t *msg, size_t len, uint32_t client) {
+  if (len < BINAPI_HEADER || len > UINT16_MAX || msg[0] != BINAPI_MAGIC) return false;
+  uint8_t *copy = (uint8_t*) malloc(len);
+  if (!copy) return false;
+  memcpy(copy, msg, len);
+  bool queued = false;
+  WLED_ASYNC_LOCK(binQueueMux);
+  if (binQueueCount < BINAPI_QUEUE_LEN) {
+    binapiq_t &q = binQueue[(binQueueHead + binQueueCount) % BINAPI_QUEUE_LEN];
+    q.msg    = copy;
+    q.len    = len;
+    q.client = client;
+    binQueueCount++;
+    queued = true;
+  }
+  WLED_ASYNC_UNLOCK(binQueueMux);
+  if (!queued) {
+    free(copy);
+    DEBUG_PRINTLN(F("Binary control queue full."));
+  }
+  return queued;
+}
+
+// fills the acknowledge for a message that could not be queued
+size_t binaryControlBusy(const uint8_t *msg, size_t len, uint8_t *reply) {
+  if (len < BINAPI_HEADER || !(msg[1] & BINAPI_FLAG_ACK)) return 0;
+  reply[0] = BINAPI_MAGIC;
+  reply[1] = msg[1];
+  reply[2] = msg[2];
+  reply[3] = msg[3];
+  reply[4] = 0;
+  reply[5] = 2;
+  return BINAPI_ACK_LEN;
+}
+
+// applies queued websocket messages in order of arrival, called from the main loop
+void handleBinaryQueue() {
+  while (binQueueCount) {
+    WLED_ASYNC_LOCK(binQueueMux);
+    binapiq_t q = binQueue[binQueueHead];
+    binQueueHead = (binQueueHead + 1) % BINAPI_QUEUE_LEN;
+    binQueueCount--;
+    WLED_ASYNC_UNLOCK(binQueueMux);
+
+    uint8_t ack[BINAPI_ACK_LEN];
+    if (handleBinaryControl(q.msg, q.len, ack)) {
+      #ifdef WLED_ENABLE_WEBSOCKETS
+      AsyncWebSocketClient *wsc = ws.client(q.client);
+      if (wsc) wsc->binary(ack, sizeof(ack));
+      #endif
+    }
+    free(q.msg);
+  }
+}
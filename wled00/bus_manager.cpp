@@ -3,6 +3,7 @@
  */
 
 #include <Arduino.h>
+#include <new>
 #include <IPAddress.h>
 #include "const.h"
 #include "pin_manager.h"
@@ -15,7 +16,9 @@ uint16_t approximateKelvinFromRGB(uint32_t rgb);
 void colorRGBtoRGBW(byte* rgb);
 
 //udp.cpp
-uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, byte *buffer, uint8_t bri=255, bool isRGBW=false);
+uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, byte *buffer, uint8_t bri=255, bool isRGBW=false, uint16_t universe=0, uint16_t startChannel=0, bool deferLatch=false);
+uint8_t realtimeBroadcastSync(uint8_t type, IPAddress client, uint16_t universe=0);
+uint16_t realtimeSyncUniverse(uint8_t type, bool isRGBW, uint16_t universe, uint16_t startChannel);
 
 // enable additional debug output
 #if defined(WLED_DEBUG_HOST)
@@ -467,6 +470,7 @@ uint8_t BusOnOff::getPins(uint8_t* pinArray) {
 BusNetwork::BusNetwork(BusConfig &bc)
 : Bus(bc.type, bc.start, bc.autoWhite, bc.count)
 , _broadcastLock(false)
+, _sent(false)
 {
   switch (bc.type) {
     case TYPE_NET_ARTNET_RGB:
@@ -484,6 +488,8 @@ BusNetwork::BusNetwork(BusConfig &bc)
   }
   _UDPchannels = _rgbw ? 4 : 3;
   _client = IPAddress(bc.pins[0],bc.pins[1],bc.pins[2],bc.pins[3]);
+  _universe = bc.universe;
+  _startChannel = bc.startChannel;
   _valid = (allocData(_len * _UDPchannels) != nullptr);
 }
 
@@ -505,12 +511,23 @@ uint32_t BusNetwork::getPixelColor(uint16_t pix) {
 }
 
 void BusNetwork::show() {
+  _sent = false;
   if (!_valid || !canShow()) return;
   _broadcastLock = true;
-  realtimeBroadcast(_UDPtype, _client, _len, _data, _bri, _rgbw);
+  _sent = (realtimeBroadcast(_UDPtype, _client, _len, _data, _bri, _rgbw, _universe, _startChannel, _syncOutput) == 0);
   _broadcastLock = false;
 }
 
+// sent by BusManager::show() once all busses have been updated, only if this bus sent a frame
+// artSync: an ArtSync (broadcast) has already been sent for this frame
+void BusNetwork::sync(bool &artSync) {
+  if (!_valid || !_syncOutput || !_sent) return;
+  _sent = false;
+  if (_UDPtype == 2 && artSync) return;
+  if (_UDPtype == 2) artSync = true;
+  realtimeBroadcastSync(_UDPtype, _client, realtimeSyncUniverse(_UDPtype, _rgbw, _universe, _startChannel));
+}
+
 uint8_t BusNetwork::getPins(uint8_t* pinArray) {
   for (uint8_t i = 0; i < 4; i++) {
     pinArray[i] = _client[i];
@@ -525,6 +542,99 @@ void BusNetwork::cleanup() {
 }
 
 
+BusNetworkMap::BusNetworkMap(uint16_t start, bool rgbw, const NetworkOutput *outputs, uint8_t count, uint16_t spreadMs)
+: Bus(TYPE_NET_MAP, start, RGBW_MODE_MANUAL_ONLY)
+, _outputs(nullptr)
+, _frame(nullptr)
+, _frameStart(0)
+, _lastShow(0)
+, _spread(spreadMs)
+, _period(0)
+, _count(0)
+, _next(0)
+, _rgbw(rgbw)
+{
+  _UDPchannels = _rgbw ? 4 : 3;
+  _len = 0;
+  for (uint8_t i = 0; i < count; i++) if (outputs[i].start + outputs[i].len > _len) _len = outputs[i].start + outputs[i].len;
+  if (!_len || !count) return;
+  _outputs = new (std::nothrow) NetworkOutput[count];
+  _frame = (uint8_t *)calloc(_len * _UDPchannels, sizeof(uint8_t));
+  if (!_outputs || !_frame || !allocData(_len * _UDPchannels)) {
+    cleanup();
+    return;
+  }
+  for (uint8_t i = 0; i < count; i++) _outputs[i] = outputs[i]; // IPAddress is not trivially copyable
+  _count = count;
+  _next = _count; // nothing to send yet
+  _valid = true;
+}
+
+void BusNetworkMap::setPixelColor(uint16_t pix, uint32_t c) {
+  if (!_valid || pix >= _len) return;
+  if (_rgbw) c = autoWhiteCalc(c);
+  if (_cct >= 1900) c = colorBalanceFromKelvin(_cct, c); //color correction from CCT
+  uint16_t offset = pix * _UDPchannels;
+  _data[offset]   = R(c);
+  _data[offset+1] = G(c);
+  _data[offset+2] = B(c);
+  if (_rgbw) _data[offset+3] = W(c);
+}
+
+uint32_t BusNetworkMap::getPixelColor(uint16_t pix) {
+  if (!_valid || pix >= _len) return 0;
+  uint16_t offset = pix * _UDPchannels;
+  return RGBW32(_data[offset], _data[offset+1], _data[offset+2], (_rgbw ? _data[offset+3] : 0));
+}
+
+void BusNetworkMap::sendNext() {
+  const NetworkOutput &o = _outputs[_next++];
+  realtimeBroadcast(o.type, o.ip, o.len, _frame + o.start * _UDPchannels, _bri, _rgbw, o.universe, o.channel, BusNetwork::getSyncOutput());
+  if (_next < _count || !BusNetwork::getSyncOutput()) return;
+  // whole frame sent, latch all receivers: one sync per receiver and sync address (a single ArtSync for all)
+  for (uint8_t i = 0; i < _count; i++) {
+    const NetworkOutput &out = _outputs[i];
+    uint16_t uni = realtimeSyncUniverse(out.type, _rgbw, out.universe, out.channel);
+    bool sent = false;
+    for (uint8_t j = 0; j < i && !sent; j++) {
+      const NetworkOutput &prev = _outputs[j];
+      sent = prev.type == out.type && (out.type == 2 || (prev.ip == out.ip && realtimeSyncUniverse(prev.type, _rgbw, prev.universe, prev.channel) == uni));
+    }
+    if (!sent) realtimeBroadcastSync(out.type, out.ip, uni);
+  }
+}
+
+void BusNetworkMap::show() {
+  if (!_valid) return;
+  unsigned long now = millis();
+  _period = min(now - _lastShow, 1000UL);
+  _lastShow = now;
+  while (_next < _count) sendNext(); // previous frame still in progress (frame period shorter than spread), flush it
+  memcpy(_frame, _data, _len * _UDPchannels);
+  _frameStart = now;
+  _next = 0;
+  service();
+}
+
+// sends outputs that are due, output i is due at i/count of the spread period
+void BusNetworkMap::service() {
+  if (!_valid || _next >= _count) return;
+  uint32_t spread = _spread ? _spread : (_period * 3) / 4;
+  uint32_t elapsed = millis() - _frameStart;
+  while (_next < _count && (uint32_t)_next * spread <= elapsed * _count) sendNext();
+}
+
+void BusNetworkMap::cleanup() {
+  _type = I_NONE;
+  _valid = false;
+  _count = _next = 0;
+  delete[] _outputs; _outputs = nullptr;
+  if (_frame) free(_frame);
+  _frame = nullptr;
+  freeData();
+}
+
+
 //utility to get the approx. memory usage of a given BusConfig
 uint32_t BusManager::memUsage(BusConfig &bc) {
   uint8_t type = bc.type;
@@ -547,6 +657,26 @@ uint32_t BusManager::memUsage(BusConfig &bc) {
   return len*3; //RGB
 }
 
+uint32_t BusManager::memUsage(uint16_t len, bool rgbw, uint8_t outputs) {
+  return 2 * len * (rgbw ? 4 : 3) + outputs * sizeof(NetworkOutput); // pixel data and frame being sent
+}
+
+uint32_t BusManager::getTotalMemory() {
+  uint32_t mem = 0;
+  for (uint8_t i = 0; i < numBusses; i++) {
+    Bus *bus = busses[i];
+    if (bus->getType() == TYPE_NET_MAP) {
+      mem += memUsage(bus->getLength(), bus->hasWhite(), static_cast<BusNetworkMap*>(bus)->getOutputCount());
+      continue;
+    }
+    uint8_t pins[5] = {255, 255, 255, 255, 255};
+    bus->getPins(pins);
+    BusConfig bc(bus->getType(), pins, bus->getStart(), bus->getLength(), COL_ORDER_GRB, false, bus->skippedLeds());
+    mem += memUsage(bc);
+  }
+  return mem;
+}
+
 int BusManager::add(BusConfig &bc) {
   if (getNumBusses() - getNumVirtualBusses() >= WLED_MAX_BUSSES) return -1;
   if (bc.type >= TYPE_NET_DDP_RGB && bc.type < 96) {
@@ -561,6 +691,24 @@ int BusManager::add(BusConfig &bc) {
   return numBusses++;
 }
 
+int BusManager::addNetworkMap(uint16_t start, bool rgbw, const NetworkOutput *outputs, uint8_t count, uint16_t spreadMs) {
+  if (numBusses >= WLED_MAX_BUSSES+WLED_MIN_VIRTUAL_BUSSES+1) return -1;
+  for (uint8_t i = 0; i < numBusses; i++) if (busses[i]->getType() == TYPE_NET_MAP) return -1; // only one map
+  uint16_t len = 0;
+  for (uint8_t i = 0; i < count; i++) if (outputs[i].start + outputs[i].len > len) len = outputs[i].start + outputs[i].len;
+  if (getTotalMemory() + memUsage(len, rgbw, count) > MAX_LED_MEMORY) {
+    DEBUG_PRINTLN(F("Network output map exceeds LED memory."));
+    return -1;
+  }
+  BusNetworkMap *map = new BusNetworkMap(start, rgbw, outputs, count, spreadMs);
+  if (!map->isOk()) {
+    delete map;
+    return -1;
+  }
+  busses[numBusses] = map;
+  return numBusses++;
+}
+
 //do not call this method from system context (network callback)
 void BusManager::removeAll() {
   DEBUG_PRINTLN(F("Removing all."));
@@ -571,8 +719,23 @@ void BusManager::removeAll() {
 }
 
 void BusManager::show() {
+  bool network = false;
   for (uint8_t i = 0; i < numBusses; i++) {
     busses[i]->show();
+    if (busses[i]->getType() >= TYPE_NET_DDP_RGB && busses[i]->getType() < 96) network = true;
+  }
+  if (network && BusNetwork::getSyncOutput()) {
+    bool artSync = false;
+    for (uint8_t i = 0; i < numBusses; i++) {
+      if (busses[i]->getType() >= TYPE_NET_DDP_RGB && busses[i]->getType() < 96) static_cast<BusNetwork*>(busses[i])->sync(artSync);
+    }
+  }
+}
+
+// paced output of busses that spread sending over time
+void BusManager::service() {
+  for (uint8_t i = 0; i < numBusses; i++) {
+    if (busses[i]->getType() == TYPE_NET_MAP) static_cast<BusNetworkMap*>(busses[i])->service();
   }
 }
 
@@ -639,3 +802,4 @@ uint16_t BusManager::getTotalLength() {
 int16_t Bus::_cct = -1;
 uint8_t Bus::_cctBlend = 0;
 uint8_t Bus::_gAWM = 255;
+bool BusNetwork::_syncOutput = false;
@@ -35,6 +35,8 @@ struct BusConfig {
   uint8_t pins[5] = {LEDPIN, 255, 255, 255, 255};
   uint16_t frequency;
   bool doubleBuffer;
+  uint16_t universe = 0;      // network busses: first E1.31/Art-Net universe (0 = protocol default)
+  uint16_t startChannel = 0;  // network busses: 0-based channel offset of the first pixel
 
   BusConfig(uint8_t busType, uint8_t* ppins, uint16_t pstart, uint16_t len = 1, uint8_t pcolorOrder = COL_ORDER_GRB, bool rev = false, uint8_t skip = 0, byte aw=RGBW_MODE_MANUAL_ONLY, uint16_t clock_kHz=0U, bool dblBfr=false)
   : count(len)
@@ -132,6 +134,8 @@ class Bus {
     virtual uint8_t  getColorOrder()             { return COL_ORDER_RGB; }
     virtual uint8_t  skippedLeds()               { return 0; }
     virtual uint16_t getFrequency()              { return 0U; }
+    virtual uint16_t getUniverse()               { return 0U; }
+    virtual uint16_t getStartChannel()           { return 0U; }
     inline  void     setReversed(bool reversed)  { _reversed = reversed; }
     inline  uint16_t getStart()                  { return _start; }
     inline  void     setStart(uint16_t start)    { _start = start; }
@@ -289,15 +293,68 @@ class BusNetwork : public Bus {
     void setPixelColor(uint16_t pix, uint32_t c);
     uint32_t getPixelColor(uint16_t pix);
     uint8_t  getPins(uint8_t* pinArray);
+    uint16_t getUniverse()     { return _universe; }
+    uint16_t getStartChannel() { return _startChannel; }
     void show();
+    void sync(bool &artSync);
     void cleanup();
 
+    inline static void setSyncOutput(bool s) { _syncOutput = s; }
+    inline static bool getSyncOutput()       { return _syncOutput; }
+
   private:
     IPAddress _client;
+    uint16_t  _universe;
+    uint16_t  _startChannel;
     uint8_t   _UDPtype;
     uint8_t   _UDPchannels;
     bool      _rgbw;
     bool      _broadcastLock;
+    bool      _sent;         // data of the last show() went out, a sync packet may latch it
+
+    static bool _syncOutput; // latch all network outputs with a sync packet after all data has been sent
+};
+
+
+// one destination of a network output map
+struct NetworkOutput {
+  IPAddress ip;
+  uint32_t  channel;    // DDP data offset or DMX channel offset
+  uint16_t  start;      // first pixel, relative to map start
+  uint16_t  len;
+  uint16_t  universe;   // E1.31/Art-Net first universe (0 = protocol default)
+  uint8_t   type;       // 0=DDP, 1=E1.31, 2=Art-Net
+};
+
+// drives many network receivers from a single bus; packets are spread over the frame period
+// (paced by BusManager::service()) so the TX queue does not get flooded
+class BusNetworkMap : public Bus {
+  public:
+    BusNetworkMap(uint16_t start, bool rgbw, const NetworkOutput *outputs, uint8_t count, uint16_t spreadMs = 0);
+    ~BusNetworkMap() { cleanup(); }
+
+    bool hasRGB()   { return true; }
+    bool hasWhite() { return _rgbw; }
+    void setPixelColor(uint16_t pix, uint32_t c);
+    uint32_t getPixelColor(uint16_t pix);
+    void show();
+    void service();
+    void cleanup();
+    uint8_t getOutputCount() { return _count; }
+
+  private:
+    NetworkOutput *_outputs;
+    uint8_t       *_frame;      // copy of the frame being sent, effects may render the next one meanwhile
+    unsigned long  _frameStart;
+    unsigned long  _lastShow;
+    uint16_t       _spread;     // ms to spread packets over, 0 = 3/4 of measured frame period
+    uint16_t       _period;
+    uint8_t        _count;
+    uint8_t        _next;       // next output to send
+    uint8_t        _UDPchannels;
+    bool           _rgbw;
+
+    void sendNext();
 };
 
 
@@ -307,13 +364,19 @@ class BusManager {
 
     //utility to get the approx. memory usage of a given BusConfig
     static uint32_t memUsage(BusConfig &bc);
+    //approx. memory usage of a network output map
+    static uint32_t memUsage(uint16_t len, bool rgbw, uint8_t outputs);
+    //approx. memory usage of all busses
+    uint32_t getTotalMemory();
 
     int add(BusConfig &bc);
+    int addNetworkMap(uint16_t start, bool rgbw, const NetworkOutput *outputs, uint8_t count, uint16_t spreadMs = 0);
 
     //do not call this method from system context (network callback)
     void removeAll();
 
     void show();
+    void service();
     bool canAllShow();
     void setStatusPixel(uint32_t c);
     void setPixelColor(uint16_t pix, uint32_t c);
@@ -332,12 +395,12 @@ class BusManager {
 
   private:
     uint8_t numBusses;
-    Bus* busses[WLED_MAX_BUSSES+WLED_MIN_VIRTUAL_BUSSES];
+    Bus* busses[WLED_MAX_BUSSES+WLED_MIN_VIRTUAL_BUSSES+1]; // +1 for network output map
     ColorOrderMap colorOrderMap;
 
     inline uint8_t getNumVirtualBusses() {
       int j = 0;
-      for (int i=0; i<numBusses; i++) if (busses[i]->getType() >= TYPE_NET_DDP_RGB && busses[i]->getType() < 96) j++;
+      for (int i=0; i<numBusses; i++) if (busses[i]->getType() >= TYPE_NET_DDP_RGB && busses[i]->getType() <= TYPE_NET_MAP) j++;
       return j;
     }
 };
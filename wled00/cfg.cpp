@@ -13,13 +13,8 @@ void getStringFromJson(char* dest, const char* src, size_t len) {
   if (src != nullptr) strlcpy(dest, src, len);
 }
 
-bool deserializeConfig(JsonObject doc, bool fromFS) {
-  bool needsSave = false;
-  //int rev_major = doc["rev"][0]; // 1
-  //int rev_minor = doc["rev"][1]; // 0
-
-  //long vid = doc[F("vid")]; // 2010020
-
+// LED outputs and what the first frame depends on: "eth" (takes priority over other use of pins), "hw", "light" and "def"
+static void deserializeConfigLeds(JsonObject doc, bool fromFS) {
   #ifdef WLED_USE_ETHERNET
   JsonObject ethernet = doc[F("eth")];
   CJSON(ethernetType, ethernet["type"]);
@@ -27,55 +22,6 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   WLED::instance().initEthernet();
   #endif
 
-  JsonObject id = doc["id"];
-  getStringFromJson(cmDNS, id[F("mdns")], 33);
-  getStringFromJson(serverDescription, id[F("name")], 33);
-  getStringFromJson(alexaInvocationName, id[F("inv")], 33);
-#ifdef WLED_ENABLE_SIMPLE_UI
-  CJSON(simplifiedUI, id[F("sui")]);
-#endif
-
-  JsonObject nw_ins_0 = doc["nw"]["ins"][0];
-  getStringFromJson(clientSSID, nw_ins_0[F("ssid")], 33);
-  //int nw_ins_0_pskl = nw_ins_0[F("pskl")];
-  //The WiFi PSK is normally not contained in the regular file for security reasons.
-  //If it is present however, we will use it
-  getStringFromJson(clientPass, nw_ins_0["psk"], 65);
-
-  JsonArray nw_ins_0_ip = nw_ins_0["ip"];
-  JsonArray nw_ins_0_gw = nw_ins_0["gw"];
-  JsonArray nw_ins_0_sn = nw_ins_0["sn"];
-
-  for (byte i = 0; i < 4; i++) {
-    CJSON(staticIP[i], nw_ins_0_ip[i]);
-    CJSON(staticGateway[i], nw_ins_0_gw[i]);
-    CJSON(staticSubnet[i], nw_ins_0_sn[i]);
-  }
-
-  JsonObject ap = doc["ap"];
-  getStringFromJson(apSSID, ap[F("ssid")], 33);
-  getStringFromJson(apPass, ap["psk"] , 65); //normally not present due to security
-  //int ap_pskl = ap[F("pskl")];
-
-  CJSON(apChannel, ap[F("chan")]);
-  if (apChannel > 13 || apChannel < 1) apChannel = 1;
-
-  CJSON(apHide, ap[F("hide")]);
-  if (apHide > 1) apHide = 1;
-
-  CJSON(apBehavior, ap[F("behav")]);
-
-  /*
-  JsonArray ap_ip = ap["ip"];
-  for (byte i = 0; i < 4; i++) {
-    apIP[i] = ap_ip;
-  }
-  */
-
-  noWifiSleep = doc[F("wifi")][F("sleep")] | !noWifiSleep; // inverted
-  noWifiSleep = !noWifiSleep;
-  //int wifi_phy = doc[F("wifi")][F("phy")]; //force phy mode n?
-
   JsonObject hw = doc[F("hw")];
 
   // initialize LED pins and lengths prior to other HW (except for ethernet)
@@ -91,6 +37,7 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   Bus::setCCTBlend(strip.cctBlending);
   strip.setTargetFps(hw_led["fps"]); //NOP if 0, default 42 FPS
   CJSON(useGlobalLedBuffer, hw_led[F("ld")]);
+  BusNetwork::setSyncOutput(hw_led[F("nsync")] | BusNetwork::getSyncOutput());
 
   #ifndef WLED_DISABLE_2D
   // 2D Matrix Settings
@@ -160,8 +107,12 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
       uint16_t freqkHz = elm[F("freq")] | 0;  // will be in kHz for DotStar and Hz for PWM (not yet implemented fully)
       ledType |= refresh << 7; // hack bit 7 to indicate strip requires off refresh
       uint8_t AWmode = elm[F("rgbwm")] | autoWhiteMode;
+      uint16_t universe = elm[F("uni")] | 0;   // network busses only
+      uint16_t startChannel = elm[F("ch")] | 0;
       if (fromFS) {
         BusConfig bc = BusConfig(ledType, pins, start, length, colorOrder, reversed, skipFirst, AWmode, freqkHz, useGlobalLedBuffer);
+        bc.universe = universe;
+        bc.startChannel = startChannel;
         mem += BusManager::memUsage(bc);
         if (useGlobalLedBuffer && start + length > maxlen) {
           maxlen = start + length;
@@ -171,6 +122,8 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
       } else {
         if (busConfigs[s] != nullptr) delete busConfigs[s];
         busConfigs[s] = new BusConfig(ledType, pins, start, length, colorOrder, reversed, skipFirst, AWmode, freqkHz, useGlobalLedBuffer);
+        busConfigs[s]->universe = universe;
+        busConfigs[s]->startChannel = startChannel;
         busesChanged = true;
       }
       s++;
@@ -375,6 +328,60 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   CJSON(bootPreset, def["ps"]);
   CJSON(turnOnAtBoot, def["on"]); // true
   CJSON(briS, def["bri"]); // 128
+}
+
+// everything else, returns true if usermods are missing settings (file needs saving)
+static bool deserializeConfigOther(JsonObject doc) {
+  bool needsSave = false;
+
+  JsonObject id = doc["id"];
+  getStringFromJson(cmDNS, id[F("mdns")], 33);
+  getStringFromJson(serverDescription, id[F("name")], 33);
+  getStringFromJson(alexaInvocationName, id[F("inv")], 33);
+#ifdef WLED_ENABLE_SIMPLE_UI
+  CJSON(simplifiedUI, id[F("sui")]);
+#endif
+
+  JsonObject nw_ins_0 = doc["nw"]["ins"][0];
+  getStringFromJson(clientSSID, nw_ins_0[F("ssid")], 33);
+  //int nw_ins_0_pskl = nw_ins_0[F("pskl")];
+  //The WiFi PSK is normally not contained in the regular file for security reasons.
+  //If it is present however, we will use it
+  getStringFromJson(clientPass, nw_ins_0["psk"], 65);
+
+  JsonArray nw_ins_0_ip = nw_ins_0["ip"];
+  JsonArray nw_ins_0_gw = nw_ins_0["gw"];
+  JsonArray nw_ins_0_sn = nw_ins_0["sn"];
+
+  for (byte i = 0; i < 4; i++) {
+    CJSON(staticIP[i], nw_ins_0_ip[i]);
+    CJSON(staticGateway[i], nw_ins_0_gw[i]);
+    CJSON(staticSubnet[i], nw_ins_0_sn[i]);
+  }
+
+  JsonObject ap = doc["ap"];
+  getStringFromJson(apSSID, ap[F("ssid")], 33);
+  getStringFromJson(apPass, ap["psk"] , 65); //normally not present due to security
+  //int ap_pskl = ap[F("pskl")];
+
+  CJSON(apChannel, ap[F("chan")]);
+  if (apChannel > 13 || apChannel < 1) apChannel = 1;
+
+  CJSON(apHide, ap[F("hide")]);
+  if (apHide > 1) apHide = 1;
+
+  CJSON(apBehavior, ap[F("behav")]);
+
+  /*
+  JsonArray ap_ip = ap["ip"];
+  for (byte i = 0; i < 4; i++) {
+    apIP[i] = ap_ip;
+  }
+  */
+
+  noWifiSleep = doc[F("wifi")][F("sleep")] | !noWifiSleep; // inverted
+  noWifiSleep = !noWifiSleep;
+  //int wifi_phy = doc[F("wifi")][F("phy")]; //force phy mode n?
 
   JsonObject interfaces = doc["if"];
 
@@ -393,7 +400,7 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   receiveNotifications = (receiveNotificationBrightness || receiveNotificationColor || receiveNotificationEffects || receiveSegmentOptions);
 
   JsonObject if_sync_send = if_sync["send"];
-  prev = notifyDirectDefault;
+  byte prev = notifyDirectDefault;
   CJSON(notifyDirectDefault, if_sync_send[F("dir")]);
   if (notifyDirectDefault != prev) notifyDirect = notifyDirectDefault;
   CJSON(notifyButton, if_sync_send["btn"]);
@@ -403,10 +410,16 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   CJSON(syncGroups, if_sync_send["grp"]);
   if (if_sync_send[F("twice")]) udpNumRetries = 1; // import setting from 0.13 and earlier
   CJSON(udpNumRetries, if_sync_send["ret"]);
+  CJSON(notifyDelta, if_sync_send[F("delta")]);
+
+  JsonArray if_sync_mc = if_sync[F("mc")];
+  for (byte i = 0; i < 4; i++)
+    CJSON(syncMulticastIP[i], if_sync_mc[i]);
 
   JsonObject if_nodes = interfaces["nodes"];
   CJSON(nodeListEnabled, if_nodes[F("list")]);
   CJSON(nodeBroadcastEnabled, if_nodes[F("bcast")]);
+  CJSON(timeSyncEnabled, if_nodes["ts"]);
 
   JsonObject if_live = interfaces["live"];
   CJSON(receiveDirect, if_live["en"]);
@@ -418,6 +431,7 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   JsonObject if_live_dmx = if_live[F("dmx")];
   CJSON(e131Universe, if_live_dmx[F("uni")]);
   CJSON(e131SkipOutOfSequence, if_live_dmx[F("seqskip")]);
+  CJSON(e131FrameTimeout, if_live_dmx[F("ftout")]);
   CJSON(DMXAddress, if_live_dmx[F("addr")]);
   if (!DMXAddress || DMXAddress > 510) DMXAddress = 1;
   CJSON(DMXSegmentSpacing, if_live_dmx[F("dss")]);
@@ -426,11 +440,13 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   if (e131Priority > 200) e131Priority = 200;
   CJSON(DMXMode, if_live_dmx["mode"]);
 
-  tdd = if_live[F("timeout")] | -1;
+  int tdd = if_live[F("timeout")] | -1;
   if (tdd >= 0) realtimeTimeoutMs = tdd * 100;
   CJSON(arlsForceMaxBri, if_live[F("maxbri")]);
   CJSON(arlsDisableGammaCorrection, if_live[F("no-gc")]); // false
   CJSON(arlsOffset, if_live[F("offset")]); // 0
+  CJSON(realtimeJitterMs, if_live[F("jitter")]); // 0 = off
+  CJSON(realtimeInterpolate, if_live[F("interp")]);
 
   CJSON(alexaEnabled, interfaces["va"][F("alexa")]); // false
 
@@ -577,6 +593,17 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   if (!usermods_settings.isNull()) {
     needsSave = !usermods.readFromConfig(usermods_settings);
   }
+  return needsSave;
+}
+
+bool deserializeConfig(JsonObject doc, bool fromFS) {
+  //int rev_major = doc["rev"][0]; // 1
+  //int rev_minor = doc["rev"][1]; // 0
+
+  //long vid = doc[F("vid")]; // 2010020
+
+  deserializeConfigLeds(doc, fromFS);
+  bool needsSave = deserializeConfigOther(doc);
 
   if (fromFS) return needsSave;
   // if from /json/cfg
@@ -585,6 +612,13 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   return (doc["sv"] | true);
 }
 
+/*
+ * At boot only what the LED outputs and the first frame need ("eth", "hw", "light", "def") is read from
+ * /cfg.json, the rest is read by deserializeConfigDeferred() once the strip is running.
+ */
+
+static bool cfgDeferred = false; // settings other than the LED outputs still need to be read
+
 void deserializeConfigFromFS() {
   bool success = deserializeConfigSec();
   if (!success) { //if file does not exist, try reading from EEPROM
@@ -598,7 +632,12 @@ void deserializeConfigFromFS() {
 
   DEBUG_PRINTLN(F("Reading settings from /cfg.json..."));
 
-  success = readObjectFromFile("/cfg.json", nullptr, &doc);
+  StaticJsonDocument<JSON_OBJECT_SIZE(4)> filter;
+  filter["eth"]   = true;
+  filter["hw"]    = true;
+  filter["light"] = true;
+  filter["def"]   = true;
+  success = readObjectFromFile("/cfg.json", nullptr, &doc, &filter);
   if (!success) { // if file does not exist, optionally try reading from EEPROM and then save defaults to FS
     releaseJSONBufferLock();
     #ifdef WLED_ADD_EEPROM_SUPPORT
@@ -619,18 +658,33 @@ void deserializeConfigFromFS() {
 
   // NOTE: This routine deserializes *and* applies the configuration
   //       Therefore, must also initialize ethernet from this function
-  bool needsSave = deserializeConfig(doc.as<JsonObject>(), true);
+  deserializeConfigLeds(doc.as<JsonObject>(), true);
+  releaseJSONBufferLock();
+  cfgDeferred = true;
+}
+
+// remaining settings (network, interfaces, timers, usermods...), called after the strip has been started
+void deserializeConfigDeferred() {
+  if (!cfgDeferred || !requestJSONBufferLock(24)) return;
+  cfgDeferred = false;
+
+  DEBUG_PRINTLN(F("Reading remaining settings from /cfg.json..."));
+
+  bool needsSave = false;
+  if (readObjectFromFile("/cfg.json", nullptr, &doc)) needsSave = deserializeConfigOther(doc.as<JsonObject>());
   releaseJSONBufferLock();
 
   if (needsSave) serializeConfig(); // usermods required new parameters
 }
 
 void serializeConfig() {
+  if (cfgDeferred) deserializeConfigDeferred(); // do not overwrite settings that have not been read yet
   serializeConfigSec();
 
   DEBUG_PRINTLN(F("Writing settings to /cfg.json..."));
 
   if (!requestJSONBufferLock(2)) return;
+  invalidateFileETags();
 
   JsonArray rev = doc.createNestedArray("rev");
   rev.add(1); //major settings revision
@@ -716,6 +770,7 @@ void serializeConfig() {
   hw_led[F("cb")] = strip.cctBlending;
   hw_led["fps"] = strip.getTargetFps();
   hw_led[F("rgbwm")] = Bus::getGlobalAWMode(); // global auto white mode override
+  hw_led[F("nsync")] = BusNetwork::getSyncOutput(); // latch network outputs with DDP push/E1.31 sync/ArtSync
   hw_led[F("ld")] = useGlobalLedBuffer;
 
   #ifndef WLED_DISABLE_2D
@@ -743,6 +798,7 @@ void serializeConfig() {
   for (uint8_t s = 0; s < busses.getNumBusses(); s++) {
     Bus *bus = busses.getBus(s);
     if (!bus || bus->getLength()==0) break;
+    if (bus->getType() == TYPE_NET_MAP) continue; // loaded from /netmap.json
     JsonObject ins = hw_led_ins.createNestedObject();
     ins["start"] = bus->getStart();
     ins["len"] = bus->getLength();
@@ -757,6 +813,8 @@ void serializeConfig() {
     ins["ref"] = bus->isOffRefreshRequired();
     ins[F("rgbwm")] = bus->getAutoWhiteMode();
     ins[F("freq")] = bus->getFrequency();
+    if (bus->getUniverse())     ins[F("uni")] = bus->getUniverse();
+    if (bus->getStartChannel()) ins[F("ch")]  = bus->getStartChannel();
   }
 
   JsonArray hw_com = hw.createNestedArray(F("com"));
@@ -864,10 +922,17 @@ void serializeConfig() {
   if_sync_send["macro"] = notifyMacro;
   if_sync_send["grp"] = syncGroups;
   if_sync_send["ret"] = udpNumRetries;
+  if_sync_send[F("delta")] = notifyDelta;
+
+  JsonArray if_sync_mc = if_sync.createNestedArray(F("mc"));
+  for (byte i = 0; i < 4; i++) {
+    if_sync_mc.add(syncMulticastIP[i]);
+  }
 
   JsonObject if_nodes = interfaces.createNestedObject("nodes");
   if_nodes[F("list")] = nodeListEnabled;
   if_nodes[F("bcast")] = nodeBroadcastEnabled;
+  if_nodes["ts"] = timeSyncEnabled;
 
   JsonObject if_live = interfaces.createNestedObject("live");
   if_live["en"] = receiveDirect;
@@ -878,6 +943,7 @@ void serializeConfig() {
   JsonObject if_live_dmx = if_live.createNestedObject("dmx");
   if_live_dmx[F("uni")] = e131Universe;
   if_live_dmx[F("seqskip")] = e131SkipOutOfSequence;
+  if_live_dmx[F("ftout")] = e131FrameTimeout;
   if_live_dmx[F("e131prio")] = e131Priority;
   if_live_dmx[F("addr")] = DMXAddress;
   if_live_dmx[F("dss")] = DMXSegmentSpacing;
@@ -887,6 +953,8 @@ void serializeConfig() {
   if_live[F("maxbri")] = arlsForceMaxBri;
   if_live[F("no-gc")] = arlsDisableGammaCorrection;
   if_live[F("offset")] = arlsOffset;
+  if_live[F("jitter")] = realtimeJitterMs;
+  if_live[F("interp")] = realtimeInterpolate;
 
   JsonObject if_va = interfaces.createNestedObject("va");
   if_va[F("alexa")] = alexaEnabled;
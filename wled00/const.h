@@ -80,6 +80,14 @@
 #define WLED_MAX_COLOR_ORDER_MAPPINGS 10
 #endif
 
+#ifndef WLED_MAX_NET_OUTPUTS
+  #ifdef ESP8266
+    #define WLED_MAX_NET_OUTPUTS 16     // destinations in /netmap.json
+  #else
+    #define WLED_MAX_NET_OUTPUTS 64
+  #endif
+#endif
+
 #if defined(WLED_MAX_LEDMAPS) && (WLED_MAX_LEDMAPS > 32 || WLED_MAX_LEDMAPS < 10)
   #undef WLED_MAX_LEDMAPS
 #endif
@@ -172,6 +180,21 @@
 #define CALL_MODE_WS_SEND       11     //special call mode, not for notifier, updates websocket only
 #define CALL_MODE_BUTTON_PRESET 12     //button/IR JSON preset/macro
 
+// binary control API (binapi.cpp)
+#define BINAPI_MAGIC   0xBC  // first byte of binary control messages (WS binary frame or UDP on notifier port)
+#define BINAPI_ACK_LEN 6
+
+// JSON request queue sources (jsonqueue.cpp)
+#define JSONQ_HTTP     0
+#define JSONQ_WS       1
+#define JSONQ_UDP      2
+#define JSONQ_SOURCES  3
+
+// individual response to a websocket JSON message (ws.cpp)
+#define WS_RESPONSE_NONE  0  // state broadcast follows
+#define WS_RESPONSE_ACK   1  // {"success":true}
+#define WS_RESPONSE_STATE 2  // full state and info
+
 //RGB to RGBW conversion mode
 #define RGBW_MODE_MANUAL_ONLY     0    // No automatic white channel calculation. Manual white channel slider
 #define RGBW_MODE_AUTO_BRIGHTER   1    // New algorithm. Adds as much white as the darkest RGBW channel
@@ -252,9 +275,10 @@
 #define TYPE_LPD6803             54
 //Network types (master broadcast) (80-95)
 #define TYPE_NET_DDP_RGB         80            //network DDP RGB bus (master broadcast bus)
-#define TYPE_NET_E131_RGB        81            //network E131 RGB bus (master broadcast bus, unused)
+#define TYPE_NET_E131_RGB        81            //network E131 RGB bus (master broadcast bus)
 #define TYPE_NET_ARTNET_RGB      82            //network ArtNet RGB bus (master broadcast bus, unused)
 #define TYPE_NET_DDP_RGBW        88            //network DDP RGBW bus (master broadcast bus)
+#define TYPE_NET_MAP             96            //network output map (loaded from /netmap.json, not user configurable, not a 80-95 network bus)
 
 #define IS_DIGITAL(t) ((t) & 0x10) //digital are 16-31 and 48-63
 #define IS_PWM(t)     ((t) > 40 && (t) < 46)
@@ -321,8 +345,8 @@
 //Segment differs return byte
 #define SEG_DIFFERS_BRI        0x01 // opacity
 #define SEG_DIFFERS_OPT        0x02 // all segment options except: selected, reset & transitional
-#define SEG_DIFFERS_COL        0x04 // colors
-#define SEG_DIFFERS_FX         0x08 // effect/mode parameters
+#define SEG_DIFFERS_COL        0x04 // colors & CCT
+#define SEG_DIFFERS_FX         0x08 // effect/mode parameters (incl. checkmarks)
 #define SEG_DIFFERS_BOUNDS     0x10 // segment start/stop ounds
 #define SEG_DIFFERS_GSO        0x20 // grouping, spacing & offset
 #define SEG_DIFFERS_SEL        0x80 // selected
@@ -449,11 +473,19 @@
 //#define MIN_HEAP_SIZE (8k for AsyncWebServer)
 #define MIN_HEAP_SIZE 8192
 
-// Maximum size of node map (list of other WLED instances)
+// Maximum size of node table (list of other WLED instances)
+#ifndef WLED_MAX_NODES
+  #ifdef ESP8266
+    #define WLED_MAX_NODES 24
+  #else
+    #define WLED_MAX_NODES 500
+  #endif
+#endif
+#define NODE_REFRESH_SLOTS 4 // node table slots checked for expiry per loop
 #ifdef ESP8266
-  #define WLED_MAX_NODES 24
+  #define NODES_PER_PAGE WLED_MAX_NODES // /json/nodes page size
 #else
-  #define WLED_MAX_NODES 150
+  #define NODES_PER_PAGE 64
 #endif
 
 //this is merely a default now and can be changed at runtime
@@ -1051,9 +1051,9 @@ function populateNodes(i,n)
 	gId('kn').innerHTML = cn;
 }
 
-function loadNodes()
+function loadNodes(page=0, list=[])
 {
-	fetch(getURL('/json/nodes'), {
+	fetch(getURL(`/json/nodes?page=${page}`), {
 		method: 'get'
 	})
 	.then((res)=>{
@@ -1061,8 +1061,10 @@ function loadNodes()
 		return res.json();
 	})
 	.then((json)=>{
+		if (json.nodes) list = list.concat(json.nodes);
+		if (json.m && page < json.m) { loadNodes(page+1, list); return; } // large node lists come in pages
 		clearErrorToast(100);
-		populateNodes(lastinfo, json);
+		populateNodes(lastinfo, {nodes: list});
 	})
 	.catch((e)=>{
 		showToast(e, true);
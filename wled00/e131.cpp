@@ -8,19 +8,252 @@
  * E1.31 handler
  */
 
+/*
+ * Frame assembly for DMX_MODE_MULTIPLE_* modes spanning several universes and for DDP:
+ * with e131FrameTimeout set, packets are written into a staging buffer instead of the strip.
+ * A frame is complete once all expected universes have arrived (or on E1.31 sync / ArtSync
+ * if the sender uses it, on DDP push), or when e131FrameTimeout expires after its first packet.
+ * The main loop then copies the complete frame to the strip and shows it, while the next one is
+ * assembled in another buffer, so universes of two frames never end up in the same show.
+ */
+#define E131_SYNC_HOLD 1000 // ms after last sync packet during which complete frames wait for sync
+#ifdef ARDUINO_ARCH_ESP32
+  #define E131_STAGE_BUFS 3 // assembling, complete, being shown (async UDP runs in its own task)
+#else
+  #define E131_STAGE_BUFS 2 // assembling, complete (shown from its buffer, callbacks never preempt the loop)
+#endif
+
+static uint32_t      e131FrameMask = 0;     // universes received for the current frame (bit 0 = e131Universe)
+static unsigned long e131FrameStart = 0;    // arrival of the first universe of the current frame
+static unsigned long e131LastSync = 0;      // last accepted sync packet
+static uint16_t      e131SyncUniverse = 0;  // sync address announced by E1.31 data packets
+static uint8_t       e131FrameSeq = 0;      // sequence number of the first universe of the current frame
+static bool          e131FrameSeqSame = true; // all universes of the current frame had the same sequence number
+static bool          e131SharedSeq = false; // sender numbers frames, not universes (a new number starts a new frame)
+static struct {
+  uint32_t frames;      // frames shown
+  uint32_t incomplete;  // frames shown with missing universes
+  uint32_t dropped;     // universes missing from shown frames
+  uint32_t late;        // out of sequence universes
+  uint32_t duplicate;   // universes received twice
+} e131Stats = {};
+
+static uint32_t *e131Stage[E131_STAGE_BUFS] = {nullptr}; // RGBW32 pixels before gamma and arlsOffset
+static int16_t   e131StageBri[E131_STAGE_BUFS];         // DRGB dimmer of the frame, -1 if none
+static uint16_t  e131StageLen = 0;
+static uint16_t  e131StageMin = 0;      // range of pixels written since allocation, others are left alone
+static uint16_t  e131StageMax = 0;
+static uint8_t   e131Assembling = 0;    // buffer indices
+static uint8_t   e131Complete = 1;
+static uint8_t   e131Showing = E131_STAGE_BUFS - 1;
+static bool      e131FrameDone = false; // e131Complete holds a frame that has not been shown yet
+static bool      e131StageWanted = false; // buffers requested by a packet, allocated by the main loop
+static bool      e131StageFailed = false; // not enough memory, packets are written to the strip directly
+WLED_ASYNC_MUX(e131Mux);                // guards everything above against async UDP on ESP32
+
+static bool isMultiUniverseMode()
+{
+  return DMXMode == DMX_MODE_MULTIPLE_RGB || DMXMode == DMX_MODE_MULTIPLE_DRGB || DMXMode == DMX_MODE_MULTIPLE_RGBW;
+}
+
+// number of consecutive universes needed for the current DMX mode and strip length
+static uint16_t e131UniverseCount()
+{
+  if (!isMultiUniverseMode()) return 1;  // 1 universe is enough
+  bool is4Chan = (DMXMode == DMX_MODE_MULTIPLE_RGBW);
+  const uint16_t dmxChannelsPerLed = is4Chan ? 4 : 3;
+  const uint16_t dimmerOffset = (DMXMode == DMX_MODE_MULTIPLE_DRGB) ? 1 : 0;
+  const uint16_t dmxLenOffset = (DMXAddress == 0) ? 0 : 1; // For legacy DMX start address 0
+  const uint16_t ledsInFirstUniverse = (((MAX_CHANNELS_PER_UNIVERSE - DMXAddress) + dmxLenOffset) - dimmerOffset) / dmxChannelsPerLed;
+  const uint16_t totalLen = strip.getLengthTotal();
+  uint16_t count = 1;
+
+  if (totalLen > ledsInFirstUniverse) {
+    const uint16_t ledsPerUniverse = is4Chan ? MAX_4_CH_LEDS_PER_UNIVERSE : MAX_3_CH_LEDS_PER_UNIVERSE;
+    count += (totalLen - ledsInFirstUniverse + ledsPerUniverse - 1) / ledsPerUniverse;
+  }
+  return min(count, (uint16_t)E131_MAX_UNIVERSE_COUNT);
+}
+
+// hand the frame being assembled over to the main loop (e131Mux held)
+static void finishE131Frame()
+{
+  uint32_t expected = (1UL << e131UniverseCount()) - 1;
+  uint32_t missing = expected & ~e131FrameMask;
+  if (missing) {
+    e131Stats.incomplete++;
+    while (missing) { e131Stats.dropped += missing & 1; missing >>= 1; }
+  }
+  if (e131FrameMask & (e131FrameMask - 1)) e131SharedSeq = e131FrameSeqSame; // more than one universe
+  e131Stats.frames++;
+  e131FrameMask = 0;
+  if (!e131Stage[0]) return;
+  uint8_t b = e131Complete; e131Complete = e131Assembling; e131Assembling = b;
+  e131FrameDone = true;
+  // universes missing from the next frame keep their last values
+  memcpy(e131Stage[e131Assembling], e131Stage[e131Complete], e131StageLen * sizeof(uint32_t));
+  e131StageBri[e131Assembling] = -1;
+}
+
+// takes e131Mux if packets are staged; direct is set if staging is unavailable and packets go to the strip
+static bool lockE131Stage(bool &direct)
+{
+  direct = false;
+  if (!e131Stage[0]) {
+    if (e131StageFailed) direct = true;
+    else e131StageWanted = true; // the first frame is lost while the main loop allocates
+    return false;
+  }
+  WLED_ASYNC_LOCK(e131Mux);
+  if (e131Stage[0]) return true;
+  WLED_ASYNC_UNLOCK(e131Mux);    // freed by the main loop in the meantime
+  return false;
+}
+
+// decides which frame universe u belongs to, false if it is to be dropped (e131Mux held)
+static bool acceptE131Universe(uint8_t u, uint8_t seq)
+{
+  uint8_t last = e131LastSequenceNumber[u];
+  // universes of a frame that was already handed over are never applied
+  if (seq < last && seq > 20 && last < 250) {
+    e131Stats.late++;
+    return false;
+  }
+  if (e131FrameMask & (1UL << u)) {
+    if (seq && seq == last) {
+      e131Stats.duplicate++;
+      return false;
+    }
+    finishE131Frame(); // universe of the next frame arrived before the current one was complete
+  } else if (e131FrameMask && e131SharedSeq && seq != e131FrameSeq) {
+    finishE131Frame(); // first universe of a newer frame
+  }
+  e131LastSequenceNumber[u] = seq;
+  if (!e131FrameMask) {
+    e131FrameStart = millis();
+    e131FrameSeq = seq;
+    e131FrameSeqSame = true;
+  } else if (seq != e131FrameSeq) e131FrameSeqSame = false;
+  e131FrameMask |= 1UL << u;
+  return true;
+}
+
+// writes pixels [from, to) of the frame being assembled (e131Mux held)
+static void stageE131Pixels(uint16_t from, uint16_t to, const uint8_t *data, uint8_t channels)
+{
+  if (to > e131StageLen) to = e131StageLen;
+  if (from >= to) return;
+  uint32_t *px = e131Stage[e131Assembling];
+  for (uint16_t i = from; i < to; i++, data += channels)
+    px[i] = RGBW32(data[0], data[1], data[2], channels > 3 ? data[3] : 0);
+  if (from < e131StageMin) e131StageMin = from;
+  if (to > e131StageMax) e131StageMax = to;
+}
+
+static void freeE131Stage()
+{
+  uint32_t *bufs[E131_STAGE_BUFS];
+  WLED_ASYNC_LOCK(e131Mux);
+  for (uint8_t b = 0; b < E131_STAGE_BUFS; b++) { bufs[b] = e131Stage[b]; e131Stage[b] = nullptr; }
+  e131StageLen = 0;
+  e131FrameMask = 0;
+  e131FrameDone = false;
+  WLED_ASYNC_UNLOCK(e131Mux);
+  for (uint8_t b = 0; b < E131_STAGE_BUFS; b++) free(bufs[b]);
+}
+
+static void allocE131Stage(uint16_t len)
+{
+  uint32_t *bufs[E131_STAGE_BUFS];
+  bool ok = len;
+  for (uint8_t b = 0; b < E131_STAGE_BUFS; b++) {
+    bufs[b] = ok ? (uint32_t*)calloc(len, sizeof(uint32_t)) : nullptr;
+    if (!bufs[b]) ok = false;
+  }
+  if (!ok) {
+    for (uint8_t b = 0; b < E131_STAGE_BUFS; b++) free(bufs[b]);
+    DEBUG_PRINTLN(F("E1.31 frame staging: not enough memory"));
+    e131StageFailed = true;
+    return;
+  }
+  WLED_ASYNC_LOCK(e131Mux);
+  for (uint8_t b = 0; b < E131_STAGE_BUFS; b++) { e131Stage[b] = bufs[b]; e131StageBri[b] = -1; }
+  e131StageLen = len;
+  e131StageMin = len;
+  e131StageMax = 0;
+  e131Assembling = 0;
+  e131Complete = 1;
+  e131Showing = E131_STAGE_BUFS - 1;
+  e131FrameMask = 0;
+  e131FrameDone = false;
+  e131StageWanted = false;
+  WLED_ASYNC_UNLOCK(e131Mux);
+}
+
+static void handleE131Sync()
+{
+  WLED_ASYNC_LOCK(e131Mux);
+  e131LastSync = millis();
+  if (e131FrameMask) finishE131Frame();
+  WLED_ASYNC_UNLOCK(e131Mux);
+}
+
+// called from the main loop: manages the staging buffers, closes timed out frames and shows complete ones
+void handleE131Frames()
+{
+  bool staging = e131FrameTimeout && (realtimeMode == REALTIME_MODE_E131 || realtimeMode == REALTIME_MODE_ARTNET || realtimeMode == REALTIME_MODE_DDP);
+  uint16_t len = strip.getLengthTotal();
+  if (e131Stage[0] && (!staging || e131StageLen != len)) freeE131Stage();
+  if (!staging) e131StageWanted = e131StageFailed = false;
+  else if (e131StageWanted && !e131Stage[0] && !e131StageFailed) allocE131Stage(len);
+  if (!e131Stage[0]) return;
+
+  WLED_ASYNC_LOCK(e131Mux);
+  if (e131FrameMask && millis() - e131FrameStart > e131FrameTimeout) finishE131Frame();
+  bool done = e131FrameDone;
+  e131FrameDone = false;
+  #if E131_STAGE_BUFS > 2
+  if (done) { uint8_t b = e131Showing; e131Showing = e131Complete; e131Complete = b; }
+  #else
+  e131Showing = e131Complete;
+  #endif
+  uint16_t from = e131StageMin, to = e131StageMax;
+  WLED_ASYNC_UNLOCK(e131Mux);
+  if (!done) return;
+
+  // the showing buffer is not touched by the packet handlers until the next handover
+  if (e131StageBri[e131Showing] >= 0 && bri != e131StageBri[e131Showing]) {
+    bri = e131StageBri[e131Showing];
+    strip.setBrightness(bri, true);
+  }
+  const uint32_t *px = e131Stage[e131Showing];
+  for (uint16_t i = from; i < to; i++) setRealtimePixel(i, R(px[i]), G(px[i]), B(px[i]), W(px[i]));
+  realtimeShow();
+}
+
+void serializeE131Stats(JsonObject root)
+{
+  root[F("frames")] = e131Stats.frames;
+  root[F("inc")]    = e131Stats.incomplete;
+  root[F("drop")]   = e131Stats.dropped;
+  root[F("late")]   = e131Stats.late;
+  root[F("dup")]    = e131Stats.duplicate;
+}
+
 //DDP protocol support, called by handleE131Packet
 //handles RGB data only
 void handleDDPPacket(e131_packet_t* p) {
   int lastPushSeq = e131LastSequenceNumber[0];
+  byte sn = p->sequenceNum & 0xF;
 
   //reject late packets belonging to previous frame (assuming 4 packets max. before push)
-  if (e131SkipOutOfSequence && lastPushSeq) {
-    int sn = p->sequenceNum & 0xF;
+  //always when staging, a frame that was already shown must not be mixed into the next one
+  if ((e131SkipOutOfSequence || e131FrameTimeout) && lastPushSeq) {
     if (sn) {
-      if (lastPushSeq > 5) {
-        if (sn > (lastPushSeq -5) && sn < lastPushSeq) return;
-      } else {
-        if (sn > (10 + lastPushSeq) || sn < lastPushSeq) return;
+      bool late = (lastPushSeq > 5) ? (sn > (lastPushSeq -5) && sn < lastPushSeq) : (sn > (10 + lastPushSeq) || sn < lastPushSeq);
+      if (late) {
+        if (e131FrameTimeout) e131Stats.late++;
+        return;
       }
     }
   }
@@ -36,17 +269,31 @@ void handleDDPPacket(e131_packet_t* p) {
 
   realtimeLock(realtimeTimeoutMs, REALTIME_MODE_DDP);
 
-  if (!realtimeOverride || (realtimeMode && useMainSegmentOnly)) {
-    for (uint16_t i = start; i < stop; i++) {
-      setRealtimePixel(i, data[c], data[c+1], data[c+2], ddpChannelsPerLed >3 ? data[c+3] : 0);
-      c += ddpChannelsPerLed;
+  if (realtimeOverride && !(realtimeMode && useMainSegmentOnly)) return;
+
+  bool push = p->flags & DDP_PUSH_FLAG;
+  bool direct = !e131FrameTimeout;
+  if (!direct && lockE131Stage(direct)) {
+    // DDP numbers pushes, not packets: the frame is tracked as universe 0
+    if (!e131FrameMask) e131FrameStart = millis();
+    e131FrameMask = 1;
+    stageE131Pixels(start, stop, data + c, ddpChannelsPerLed);
+    if (push) {
+      if (sn) e131LastSequenceNumber[0] = sn;
+      finishE131Frame();
     }
+    WLED_ASYNC_UNLOCK(e131Mux);
+    return;
+  }
+  if (!direct) return;
+
+  for (uint16_t i = start; i < stop; i++) {
+    setRealtimePixel(i, data[c], data[c+1], data[c+2], ddpChannelsPerLed >3 ? data[c+3] : 0);
+    c += ddpChannelsPerLed;
   }
 
-  bool push = p->flags & DDP_PUSH_FLAG;
   if (push) {
     e131NewData = true;
-    byte sn = p->sequenceNum & 0xF;
     if (sn) e131LastSequenceNumber[0] = sn;
   }
 }
@@ -64,12 +311,22 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
       handleArtnetPollReply(clientIP);
       return;
     }
+    if (p->art_opcode == ARTNET_OPCODE_OPSYNC) {
+      if (e131FrameTimeout) handleE131Sync();
+      return;
+    }
     uni = p->art_universe;
     dmxChannels = htons(p->art_length);
     e131_data = p->art_data;
     seq = p->art_sequence_number;
     mde = REALTIME_MODE_ARTNET;
   } else if (protocol == P_E131) {
+    if (htonl(p->root_vector) == E131_VECTOR_ROOT_EXTENDED) {
+      // synchronization packet: sequence at 44, sync address at 45-46
+      uint16_t syncUni = (p->raw[45] << 8) | p->raw[46];
+      if (e131FrameTimeout && syncUni && syncUni == e131SyncUniverse) handleE131Sync();
+      return;
+    }
     // Ignore PREVIEW data (E1.31: 6.2.6)
     if ((p->options & 0x80) != 0) return;
     dmxChannels = htons(p->property_value_count) - 1;
@@ -78,6 +335,7 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
     uni = htons(p->universe);
     e131_data = p->property_values;
     seq = p->sequence_number;
+    e131SyncUniverse = htons(p->reserved); // synchronization address (0 = no sync)
     if (e131Priority != 0) {
       if (p->priority < e131Priority ) return;
       // track highest priority & skip all lower priorities
@@ -103,19 +361,22 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
   if (uni < e131Universe || uni >= (e131Universe + E131_MAX_UNIVERSE_COUNT)) return;
 
   uint8_t previousUniverses = uni - e131Universe;
-
-  if (e131SkipOutOfSequence)
-    if (seq < e131LastSequenceNumber[previousUniverses] && seq > 20 && e131LastSequenceNumber[previousUniverses] < 250){
-      DEBUG_PRINT(F("skipping E1.31 frame (last seq="));
-      DEBUG_PRINT(e131LastSequenceNumber[previousUniverses]);
-      DEBUG_PRINT(F(", current seq="));
-      DEBUG_PRINT(seq);
-      DEBUG_PRINT(F(", universe="));
-      DEBUG_PRINT(uni);
-      DEBUG_PRINTLN(")");
-      return;
-    }
-  e131LastSequenceNumber[previousUniverses] = seq;
+  bool assemble = e131FrameTimeout && isMultiUniverseMode(); // universes are staged, see acceptE131Universe()
+
+  if (!assemble || e131StageFailed) {
+    if (e131SkipOutOfSequence)
+      if (seq < e131LastSequenceNumber[previousUniverses] && seq > 20 && e131LastSequenceNumber[previousUniverses] < 250){
+        DEBUG_PRINT(F("skipping E1.31 frame (last seq="));
+        DEBUG_PRINT(e131LastSequenceNumber[previousUniverses]);
+        DEBUG_PRINT(F(", current seq="));
+        DEBUG_PRINT(seq);
+        DEBUG_PRINT(F(", universe="));
+        DEBUG_PRINT(uni);
+        DEBUG_PRINTLN(")");
+        return;
+      }
+    e131LastSequenceNumber[previousUniverses] = seq;
+  }
 
   // update status info
   realtimeIP = clientIP;
@@ -301,6 +562,23 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
           ledsTotal = totalLen;
         }
 
+        if (assemble) {
+          bool direct;
+          if (lockE131Stage(direct)) {
+            if (acceptE131Universe(previousUniverses, seq)) {
+              stageE131Pixels(previousLeds, ledsTotal, e131_data + dmxOffset, dmxChannelsPerLed);
+              if (DMXMode == DMX_MODE_MULTIPLE_DRGB && previousUniverses == 0) e131StageBri[e131Assembling] = stripBrightness;
+              uint32_t expected = (1UL << e131UniverseCount()) - 1;
+              // with sync in use the frame is handed over on sync (or timeout)
+              bool syncActive = e131LastSync && millis() - e131LastSync < E131_SYNC_HOLD;
+              if ((e131FrameMask & expected) == expected && !syncActive) finishE131Frame();
+            }
+            WLED_ASYNC_UNLOCK(e131Mux);
+            return;
+          }
+          if (!direct) return;
+        }
+
         if (DMXMode == DMX_MODE_MULTIPLE_DRGB && previousUniverses == 0) {
           if (bri != stripBrightness) {
             bri = stripBrightness;
@@ -354,30 +632,8 @@ void handleArtnetPollReply(IPAddress ipAddress) {
     case DMX_MODE_MULTIPLE_DRGB:
     case DMX_MODE_MULTIPLE_RGB:
     case DMX_MODE_MULTIPLE_RGBW:
-      {
-        bool is4Chan = (DMXMode == DMX_MODE_MULTIPLE_RGBW);
-        const uint16_t dmxChannelsPerLed = is4Chan ? 4 : 3;
-        const uint16_t dimmerOffset = (DMXMode == DMX_MODE_MULTIPLE_DRGB) ? 1 : 0;
-        const uint16_t dmxLenOffset = (DMXAddress == 0) ? 0 : 1; // For legacy DMX start address 0
-        const uint16_t ledsInFirstUniverse = (((MAX_CHANNELS_PER_UNIVERSE - DMXAddress) + dmxLenOffset) - dimmerOffset) / dmxChannelsPerLed;
-        const uint16_t totalLen = strip.getLengthTotal();
-
-        if (totalLen > ledsInFirstUniverse) {
-          const uint16_t ledsPerUniverse = is4Chan ? MAX_4_CH_LEDS_PER_UNIVERSE : MAX_3_CH_LEDS_PER_UNIVERSE;
-          const uint16_t remainLED = totalLen - ledsInFirstUniverse;
-
-          endUniverse += (remainLED / ledsPerUniverse);
-
-          if ((remainLED % ledsPerUniverse) > 0) {
-            endUniverse++;
-          }
-
-          if ((endUniverse - startUniverse) > E131_MAX_UNIVERSE_COUNT) {
-            endUniverse = startUniverse + E131_MAX_UNIVERSE_COUNT - 1;
-          }
-        }
-        break;
-      }
+      endUniverse = startUniverse + e131UniverseCount() - 1;
+      break;
     default:
       DEBUG_PRINTLN(F("unknown E1.31 DMX mode"));
       return;  // nothing to do
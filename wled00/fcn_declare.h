@@ -13,6 +13,12 @@ void handleAlexa();
 void onAlexaChange(EspalexaDevice* dev);
 #endif
 
+//binapi.cpp
+size_t handleBinaryControl(const uint8_t *msg, size_t len, uint8_t *reply, byte callMode = CALL_MODE_DIRECT_CHANGE);
+bool queueBinaryControl(const uint8_t *msg, size_t len, uint32_t client);
+size_t binaryControlBusy(const uint8_t *msg, size_t len, uint8_t *reply);
+void handleBinaryQueue();
+
 //button.cpp
 void shortPressAction(uint8_t b=0);
 void longPressAction(uint8_t b=0);
@@ -24,6 +30,7 @@ void handleIO();
 //cfg.cpp
 bool deserializeConfig(JsonObject doc, bool fromFS = false);
 void deserializeConfigFromFS();
+void deserializeConfigDeferred();
 bool deserializeConfigSec();
 void serializeConfig();
 void serializeConfigSec();
@@ -84,14 +91,17 @@ void handleDMX();
 void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol);
 void handleArtnetPollReply(IPAddress ipAddress);
 void prepareArtnetPollReply(ArtPollReply* reply);
+void handleE131Frames();
+void serializeE131Stats(JsonObject root);
 void sendArtnetPollReply(ArtPollReply* reply, IPAddress ipAddress, uint16_t portAddress);
 
 //file.cpp
 bool handleFileRead(AsyncWebServerRequest*, String path);
+void invalidateFileETags();
 bool writeObjectToFileUsingId(const char* file, uint16_t id, JsonDocument* content);
 bool writeObjectToFile(const char* file, const char* key, JsonDocument* content);
 bool readObjectFromFileUsingId(const char* file, uint16_t id, JsonDocument* dest);
-bool readObjectFromFile(const char* file, const char* key, JsonDocument* dest);
+bool readObjectFromFile(const char* file, const char* key, JsonDocument* dest, const JsonDocument* filter = nullptr);
 void updateFSInfo();
 void closeFile();
 
@@ -176,10 +186,22 @@ bool parseLx(int lxValue, byte* rgbw);
 void parseLxJson(int lxValue, byte segId, bool secondary);
 #endif
 
+//jsonqueue.cpp
+bool queueJsonState(const char *json, size_t len, uint8_t source, uint32_t wsClient = 0);
+bool jsonQueuePending(uint8_t source);
+void handleJsonQueue();
+void serializeJsonQueueStats(JsonObject root);
+
 //mqtt.cpp
 bool initMqtt();
+void handleMqtt();
 void publishMqtt();
 
+//noise.cpp
+void fillNoise16(uint16_t *dst, uint16_t len, uint32_t x, int32_t dx, uint32_t y = 0, int32_t dy = 0, uint32_t z = 0, uint8_t octaves = 1);
+void fillNoise8(uint8_t *dst, uint16_t len, uint32_t x, int32_t dx, uint32_t y = 0, int32_t dy = 0, uint32_t z = 0, uint8_t octaves = 1);
+uint16_t noise16(uint32_t x, uint32_t y, uint32_t z);
+
 //ntp.cpp
 void handleTime();
 void handleNetworkTime();
@@ -225,16 +247,35 @@ bool isAsterisksOnly(const char* str, byte maxLen);
 void handleSettingsSet(AsyncWebServerRequest *request, byte subPage);
 bool handleSet(AsyncWebServerRequest *request, const String& req, bool apply=true);
 
+//timesync.cpp
+bool handleTimeSyncPacket(const byte *p, size_t len, IPAddress remote);
+void handleTimeSync();
+bool timeSyncFollowing();
+void serializeTimeSync(JsonObject root);
+
 //udp.cpp
+bool beginSyncUdp();
 void notify(byte callMode, bool followUp=false);
-uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, uint8_t *buffer, uint8_t bri=255, bool isRGBW=false);
+uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, uint8_t *buffer, uint8_t bri=255, bool isRGBW=false, uint16_t universe=0, uint16_t startChannel=0, bool deferLatch=false);
+uint8_t realtimeBroadcastSync(uint8_t type, IPAddress client, uint16_t universe=0);
+uint16_t realtimeSyncUniverse(uint8_t type, bool isRGBW, uint16_t universe, uint16_t startChannel);
+bool loadNetworkOutputMap();
 void realtimeLock(uint32_t timeoutMs, byte md = REALTIME_MODE_GENERIC);
 void exitRealtime();
 void handleNotifications();
+void serializeUdpStats(JsonObject root);
 void setRealtimePixel(uint16_t i, byte r, byte g, byte b, byte w);
 void refreshNodeList();
 void sendSysInfoUDP();
 
+//jitter.cpp
+bool jitterBufferActive();
+bool jitterCapture(uint16_t pix, uint32_t c);
+void realtimeShow();
+void handleJitterBuffer();
+void resetJitterBuffer(bool release=false);
+void serializeJitterStats(JsonObject root);
+
 //network.cpp
 int getSignalQuality(int rssi);
 void WiFiEvent(WiFiEvent_t event);
@@ -405,6 +446,7 @@ void serveSettingsJS(AsyncWebServerRequest* request);
 void handleWs();
 void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data, size_t len);
 void sendDataWs(AsyncWebSocketClient * client = nullptr);
+uint8_t applyWsJson(uint32_t id, JsonObject root);
 
 //xml.cpp
 void XML_response(AsyncWebServerRequest *request, char* dest = nullptr);
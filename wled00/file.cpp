@@ -272,6 +272,7 @@ bool writeObjectToFile(const char* file, const char* key, JsonDocument* content)
   #endif
 
   size_t pos = 0;
+  invalidateFileETags();
   f = WLED_FS.open(file, "r+");
   if (!f && !WLED_FS.exists(file)) f = WLED_FS.open(file, "w+");
   if (!f) {
@@ -333,7 +334,8 @@ bool readObjectFromFileUsingId(const char* file, uint16_t id, JsonDocument* dest
 }
 
 //if the key is a nullptr, deserialize entire object
-bool readObjectFromFile(const char* file, const char* key, JsonDocument* dest)
+//if a filter is given, only the fields it contains are deserialized
+bool readObjectFromFile(const char* file, const char* key, JsonDocument* dest, const JsonDocument* filter)
 {
   if (doCloseFile) closeFile();
   #ifdef WLED_DEBUG_FS
@@ -351,7 +353,8 @@ bool readObjectFromFile(const char* file, const char* key, JsonDocument* dest)
     return false;
   }
 
-  deserializeJson(*dest, f);
+  if (filter) deserializeJson(*dest, f, DeserializationOption::Filter(*filter));
+  else        deserializeJson(*dest, f);
 
   f.close();
   DEBUGFS_PRINTF("Read, took %d ms\n", millis() - s);
@@ -394,19 +397,117 @@ static String getContentType(AsyncWebServerRequest* request, String filename){
   return "text/plain";
 }
 
+static uint32_t fileETagSeed = 0; // differs per boot
+static uint32_t fileETagGen  = 0; // bumped by every file write, catches rewrites of equal size and time
+
+// FNV-1a
+static uint32_t fnv1a(uint32_t h, const uint8_t *p, size_t len) {
+  while (len--) { h ^= *p++; h *= 16777619UL; }
+  return h;
+}
+
+// all ETags handed out so far become invalid, called whenever a file is written
+void invalidateFileETags() {
+  fileETagGen++;
+}
+
+// validator of a file version from path, size and write time, no need to read the file
+static uint32_t fileETag(File &f, const String &path) {
+  if (!fileETagSeed) {
+    #ifdef ESP8266
+    fileETagSeed = RANDOM_REG32 | 1;
+    #else
+    fileETagSeed = esp_random() | 1;
+    #endif
+  }
+  uint32_t v[4] = { fileETagSeed, fileETagGen, (uint32_t)f.size(), (uint32_t)f.getLastWrite() };
+  uint32_t h = fnv1a(2166136261UL, (const uint8_t*)path.c_str(), path.length());
+  return fnv1a(h, (const uint8_t*)v, sizeof(v));
+}
+
+// parses a single "bytes=" range, returns false if the header is not usable (multiple ranges, other units)
+static bool parseRange(const String &range, size_t size, size_t &start, size_t &end) {
+  if (!range.startsWith(F("bytes=")) || range.indexOf(',') >= 0) return false;
+  const char *p = range.c_str() + 6;
+  char *e;
+  if (*p == '-') { // suffix: last n bytes
+    size_t n = strtoul(p + 1, &e, 10);
+    if (e == p + 1) return false;
+    start = n < size ? size - n : 0;
+    end = size ? size - 1 : 0;
+    return true;
+  }
+  start = strtoul(p, &e, 10);
+  if (e == p || *e != '-') return false;
+  p = e + 1;
+  end = *p ? strtoul(p, &e, 10) : size - 1;
+  if (end >= size) end = size - 1;
+  return true;
+}
+
 bool handleFileRead(AsyncWebServerRequest* request, String path){
   DEBUG_PRINTLN("WS FileRead: " + path);
   if(path.endsWith("/")) path += "index.htm";
   if(path.indexOf("sec") > -1) return false;
   String contentType = getContentType(request, path);
-  /*String pathWithGz = path + ".gz";
-  if(WLED_FS.exists(pathWithGz)){
-    request->send(WLED_FS, pathWithGz, contentType);
-    return true;
-  }*/
-  if(WLED_FS.exists(path)) {
-    request->send(WLED_FS, path, contentType);
-    return true;
+  bool download = request->hasArg("download");
+  bool ranged   = request->hasHeader(F("Range"));
+
+  // precompressed variant if the client accepts it (or if it is the only one), byte ranges are served from the plain file
+  bool plain = WLED_FS.exists(path);
+  String pathWithGz = path + ".gz";
+  AsyncWebHeader* enc = request->getHeader(F("Accept-Encoding"));
+  bool gz = !download && (!plain || (!ranged && enc && enc->value().indexOf(F("gzip")) >= 0)) && WLED_FS.exists(pathWithGz);
+  if (!plain && !gz) return false;
+  if (gz && plain) {
+    // the FS editor saves the plain file without touching its .gz, so a newer plain file wins
+    File fp = WLED_FS.open(path, "r");
+    File fg = WLED_FS.open(pathWithGz, "r");
+    if (fp && fg && fp.getLastWrite() > fg.getLastWrite()) gz = false;
+    fp.close(); fg.close();
   }
-  return false;
+  const String &file = gz ? pathWithGz : path;
+
+  File f = WLED_FS.open(file, "r");
+  if (!f) return false;
+  size_t size = f.size();
+  char etag[12];
+  sprintf_P(etag, PSTR("\"%08x\""), fileETag(f, file));
+
+  AsyncWebServerResponse *response;
+  AsyncWebHeader* inm = request->getHeader(F("If-None-Match"));
+  size_t start = 0, end = 0;
+  if (inm && inm->value().indexOf(etag) >= 0) {
+    f.close();
+    response = request->beginResponse(304);
+  } else if (!gz && ranged && parseRange(request->getHeader(F("Range"))->value(), size, start, end)) {
+    char tmp[40];
+    if (start >= size || start > end) {
+      f.close();
+      sprintf_P(tmp, PSTR("bytes */%u"), (unsigned)size);
+      response = request->beginResponse(416);
+      response->addHeader(F("Content-Range"), tmp);
+      request->send(response);
+      return true;
+    }
+    size_t len = end - start + 1;
+    response = request->beginResponse(contentType, len, [f, start, len](uint8_t *buf, size_t maxLen, size_t index) mutable -> size_t {
+      if (index >= len) return 0;
+      f.seek(start + index);
+      return f.read(buf, min(maxLen, len - index));
+    });
+    response->setCode(206);
+    sprintf_P(tmp, PSTR("bytes %u-%u/%u"), (unsigned)start, (unsigned)end, (unsigned)size);
+    response->addHeader(F("Content-Range"), tmp);
+  } else {
+    f.close();
+    response = request->beginResponse(WLED_FS, file, contentType, download);
+    if (gz) response->addHeader(F("Content-Encoding"), "gzip");
+  }
+  response->addHeader(F("Accept-Ranges"), "bytes");
+  response->addHeader(F("Vary"), "Accept-Encoding");
+  response->addHeader(F("Cache-Control"), "no-cache"); // revalidate using the ETag
+  response->addHeader(F("ETag"), etag);
+  request->send(response);
+  return true;
 }
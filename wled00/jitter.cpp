@@ -0,0 +1,234 @@
+#include "wled.h"
+
+/*
+ * Realtime jitter buffer
+ *
+ * With a latency target set (realtimeJitterMs) frames from realtime sources (E1.31, Art-Net, DDP,
+ * UDP realtime, Hyperion, TPM2.NET, Adalight) are captured instead of being shown on arrival and
+ * played out realtimeJitterMs later. Arrival times are smoothed by a simple PLL tracking the source
+ * frame interval, so frames are shown at a steady cadence even if Wi-Fi delivers them in bursts.
+ * If realtimeInterpolate is set the output is blended between consecutive frames at the strip
+ * frame rate, which helps sources slower than the LEDs can be refreshed.
+ * Only used if realtime data covers the whole strip (not with "use main segment only").
+ */
+
+#ifdef ESP8266
+  #define JB_FRAMES   4       // ring slots (one of them is being captured)
+#else
+  #define JB_FRAMES   8
+#endif
+#define JB_MIN_FRAMES 3       // capture slot + 2 frames to interpolate between
+#define JB_PLL_DIV    8       // arrival phase error applied per frame
+#define JB_IV_DIV     8       // source interval averaging
+#define JB_RESYNC_US  250000  // arrivals this far off the expected time restart timing (source paused or changed rate)
+
+static uint32_t *jbPixels   = nullptr;  // jbSlots frames of jbLen pixels
+static uint32_t  jbStamp[JB_FRAMES];    // smoothed source time (us) of each buffered frame
+static uint16_t  jbLen      = 0;
+static uint8_t   jbSlots    = 0;
+static uint8_t   jbTail     = 0;        // oldest buffered frame
+static uint8_t   jbCount    = 0;        // buffered frames
+static uint8_t   jbCap      = 0;        // slot being captured, follows the newest frame
+static uint8_t   jbShown    = 255;      // slot shown last without interpolation
+static bool      jbFailed   = false;    // allocation failed, pass frames through until released
+static bool      jbHolding  = false;    // ran out of frames (counted as underrun once)
+static volatile bool jbWanted  = false; // a pixel was passed through for lack of a buffer
+static volatile bool jbReset   = false; // requested by resetJitterBuffer(), handled by the main loop
+static volatile bool jbRelease = false;
+static uint32_t  jbArrival  = 0;        // us of last commit, 0 = timing not started
+static uint32_t  jbLastStamp = 0;
+static int32_t   jbInterval = 0;        // averaged source frame interval (us)
+static uint32_t  jbLastOut  = 0;
+// Pixels may be captured from async UDP (E1.31 without frame staging) on ESP32, everything else
+// (allocation, commit, playout) runs in the main loop. The lock covers the buffer pointer, its length
+// and the capture slot, which the main loop only changes while holding it.
+WLED_ASYNC_MUX(jbMux);
+
+static struct {
+  uint32_t frames;    // frames buffered
+  uint32_t underruns; // buffer ran empty (source late or latency too low)
+  uint32_t overflows; // frames dropped because the buffer was full (latency too high for buffer size)
+} jbStats = {};
+
+static inline bool jitterEnabled() {
+  return realtimeJitterMs && !useMainSegmentOnly && !realtimeOverride;
+}
+
+static inline uint32_t *jitterFrame(uint8_t slot) {
+  return jbPixels + (size_t)slot * jbLen;
+}
+
+static void freeJitterBuffer() {
+  uint32_t *p = jbPixels;
+  WLED_ASYNC_LOCK(jbMux);
+  jbPixels = nullptr;
+  jbLen = 0;
+  WLED_ASYNC_UNLOCK(jbMux);
+  free(p);
+  jbTail = jbCount = jbCap = 0;
+}
+
+static void allocJitterBuffer() {
+  freeJitterBuffer();
+  uint16_t len = strip.getLengthTotal();
+  uint32_t *p = nullptr;
+  uint8_t slots;
+  // fewer frames are better than none if memory is short
+  for (slots = JB_FRAMES; slots >= JB_MIN_FRAMES && len; slots--) {
+    p = (uint32_t*) calloc((size_t)slots * len, sizeof(uint32_t));
+    if (p) break;
+  }
+  if (!p) {
+    DEBUG_PRINTLN(F("Jitter buffer allocation failed!"));
+    jbFailed = true;
+    return;
+  }
+  jbSlots = slots;
+  jbShown = 255;
+  jbArrival = 0;
+  WLED_ASYNC_LOCK(jbMux);
+  jbPixels = p;
+  jbLen = len;
+  WLED_ASYNC_UNLOCK(jbMux);
+}
+
+// drops buffered frames and restarts timing (main loop)
+static void clearJitterBuffer() {
+  WLED_ASYNC_LOCK(jbMux);
+  jbTail = jbCount = jbCap = 0;
+  if (jbPixels) memset(jbPixels, 0, jbLen * sizeof(uint32_t)); // partial updates build on this
+  WLED_ASYNC_UNLOCK(jbMux);
+  jbShown = 255;
+  jbArrival = 0;
+  jbInterval = 0;
+  jbHolding = false;
+}
+
+// drops buffered frames (memory is kept unless release is set), done by the next handleJitterBuffer()
+// so it may be called from async handlers (realtimeLock(), exitRealtime())
+void resetJitterBuffer(bool release) {
+  if (release) jbRelease = true;
+  else         jbReset = true;
+}
+
+bool jitterBufferActive() {
+  return jbPixels && jitterEnabled();
+}
+
+// stores a realtime pixel in the frame being captured, returns false if the jitter buffer is not in use
+bool jitterCapture(uint16_t pix, uint32_t c) {
+  if (!jitterEnabled()) return false;
+  bool captured = false;
+  WLED_ASYNC_LOCK(jbMux);
+  if (jbPixels && jbLen == strip.getLengthTotal()) {
+    if (pix < jbLen) jitterFrame(jbCap)[pix] = c;
+    captured = true;
+  }
+  WLED_ASYNC_UNLOCK(jbMux);
+  if (!captured && !jbFailed) jbWanted = true; // pixels go to the strip until the main loop allocated a buffer
+  return captured;
+}
+
+// completes the captured frame, time stamped with the smoothed arrival time (main loop)
+static void jitterCommit() {
+  uint32_t now = micros();
+  uint32_t stamp = now;
+  if (jbArrival) {
+    int32_t d = now - jbArrival;
+    int32_t err = now - (jbLastStamp + jbInterval);
+    if (!jbInterval || err > JB_RESYNC_US || err < -JB_RESYNC_US) {
+      jbInterval = d; // (re)start timing from the last interval seen
+    } else {
+      jbInterval += (d - jbInterval) / JB_IV_DIV;
+      stamp = jbLastStamp + jbInterval + err / JB_PLL_DIV;
+      if ((int32_t)(stamp - jbLastStamp) <= 0) stamp = jbLastStamp + 1; // keep order
+    }
+  }
+  jbArrival = now;
+  jbLastStamp = stamp;
+
+  WLED_ASYNC_LOCK(jbMux);
+  jbStamp[jbCap] = stamp;
+  if (jbCount == jbSlots - 1) { // full, drop oldest
+    jbTail = (jbTail + 1) % jbSlots;
+    jbCount--;
+    jbStats.overflows++;
+  }
+  jbCount++;
+  uint8_t next = (jbTail + jbCount) % jbSlots;
+  // partial updates (WARLS, DNRGB, several universes) build on the latest frame
+  memcpy(jitterFrame(next), jitterFrame(jbCap), jbLen * sizeof(uint32_t));
+  jbCap = next;
+  WLED_ASYNC_UNLOCK(jbMux);
+  jbStats.frames++;
+  jbHolding = false;
+}
+
+// realtime frame complete: buffer it or show it right away (main loop)
+void realtimeShow() {
+  if (jitterBufferActive() && jbLen == strip.getLengthTotal()) jitterCommit();
+  else strip.show();
+}
+
+// plays out buffered frames, called from the main loop
+void handleJitterBuffer() {
+  // buffer memory is only allocated and freed here
+  bool release = jbRelease, reset = jbReset;
+  jbRelease = jbReset = false;
+  if (release || (jbPixels && (!realtimeMode || !realtimeJitterMs))) {
+    if (jbPixels) freeJitterBuffer();
+    jbFailed = false;
+  } else if (reset) {
+    clearJitterBuffer();
+  }
+  if (jbWanted) {
+    jbWanted = false;
+    if (realtimeMode && jitterEnabled() && !jbFailed && (!jbPixels || jbLen != strip.getLengthTotal())) allocJitterBuffer();
+  }
+
+  if (!jbPixels || !jbCount || !realtimeMode || !jitterEnabled()) return;
+  uint32_t now = micros();
+  uint32_t t = now - realtimeJitterMs * 1000UL; // source time to show
+
+  // frames superseded at t are not needed any more
+  while (jbCount > 1 && (int32_t)(t - jbStamp[(jbTail + 1) % jbSlots]) >= 0) {
+    jbTail = (jbTail + 1) % jbSlots;
+    jbCount--;
+  }
+  uint8_t a = jbTail;
+  if ((int32_t)(t - jbStamp[a]) < 0) return; // not due yet (filling up)
+  const uint32_t *A = jitterFrame(a);
+
+  if (realtimeInterpolate && jbCount > 1) {
+    if (now - jbLastOut < strip.getFrameTime() * 1000UL) return;
+    uint8_t b = (a + 1) % jbSlots;
+    const uint32_t *B = jitterFrame(b);
+    uint32_t span = jbStamp[b] - jbStamp[a];
+    uint8_t w = ((uint64_t)(t - jbStamp[a]) * 255) / span; // t < stamp[b], so < 255
+    for (size_t i = 0; i < jbLen; i++) strip.setPixelColor(i, color_blend(A[i], B[i], w));
+    jbShown = 255;
+  } else {
+    if (a == jbShown) {
+      // holding the newest frame, count a missed frame once
+      if (jbCount == 1 && !jbHolding && jbInterval && (int32_t)(t - jbStamp[a]) > jbInterval + jbInterval/2) {
+        jbHolding = true;
+        jbStats.underruns++;
+      }
+      return;
+    }
+    for (size_t i = 0; i < jbLen; i++) strip.setPixelColor(i, A[i]);
+    jbShown = a;
+  }
+  jbLastOut = now;
+  strip.show();
+}
+
+void serializeJitterStats(JsonObject root) {
+  if (!realtimeJitterMs) return;
+  JsonObject jb = root.createNestedObject(F("jb"));
+  jb[F("n")]  = jbCount;               // frames buffered
+  jb[F("iv")] = (jbInterval + 500) / 1000; // source frame interval (ms)
+  jb[F("fr")] = jbStats.frames;
+  jb[F("ur")] = jbStats.underruns;
+  jb[F("ov")] = jbStats.overflows;
+}
@@ -34,8 +34,8 @@ bool deserializeSegment(JsonObject elem, byte it, byte presetId)
   //DEBUG_PRINTLN("-- JSON deserialize segment.");
   Segment& seg = strip.getSegment(id);
   //DEBUG_PRINTF("--  Original segment: %p\n", &seg);
-  Segment prev = seg; //make a backup so we can tell if something changed
-  //DEBUG_PRINTF("--  Duplicate segment: %p\n", &prev);
+  Segment::segsnap_t prev; //remember settings so we can tell if something changed (copying the segment would copy its effect data)
+  seg.snapshot(prev);
 
   uint16_t start = elem["start"] | seg.start;
   if (stop < 0) {
@@ -680,12 +680,21 @@ void serializeInfo(JsonObject root)
     root[F("lip")] = realtimeIP.toString();
   }
 
+  if (e131FrameTimeout && (DMXMode == DMX_MODE_MULTIPLE_RGB || DMXMode == DMX_MODE_MULTIPLE_DRGB || DMXMode == DMX_MODE_MULTIPLE_RGBW || realtimeMode == REALTIME_MODE_DDP)) {
+    JsonObject e131Info = root.createNestedObject(F("e131"));
+    serializeE131Stats(e131Info);
+  }
+
   #ifdef WLED_ENABLE_WEBSOCKETS
   root[F("ws")] = ws.count();
   #else
   root[F("ws")] = -1;
   #endif
 
+  #ifdef WLED_ENABLE_MQTT
+  if (mqttDropped) root[F("mqttdrop")] = mqttDropped;
+  #endif
+
   root[F("fxcount")] = strip.getModeCount();
   root[F("palcount")] = strip.getPaletteCount();
   root[F("cpalcount")] = strip.customPalettes.size(); //number of custom palettes
@@ -714,6 +723,10 @@ void serializeInfo(JsonObject root)
   fs_info[F("pmt")] = presetsModifiedTime;
 
   root[F("ndc")] = nodeListEnabled ? (int)Nodes.size() : -1;
+  serializeTimeSync(root);
+  serializeUdpStats(root);
+  serializeJitterStats(root);
+  serializeJsonQueueStats(root);
 
   #ifdef ARDUINO_ARCH_ESP32
   #ifdef WLED_DEBUG
@@ -967,21 +980,27 @@ void serializeNetworks(JsonObject root)
   }
 }
 
-void serializeNodes(JsonObject root)
+void serializeNodes(JsonObject root, int page)
 {
+  int maxPage = Nodes.size() ? (Nodes.size() - 1) / NODES_PER_PAGE : 0;
+  page = constrain(page, 0, maxPage);
+  root[F("m")] = maxPage; // inform caller how many pages there are
   JsonArray nodes = root.createNestedArray("nodes");
 
-  for (NodesMap::iterator it = Nodes.begin(); it != Nodes.end(); ++it)
+  // pages are runs of occupied slots, stable as long as no node joins or expires in between
+  // (runs in the async web server, so nodes are copied out of the table maintained by the main loop)
+  int skip = page * NODES_PER_PAGE, count = 0;
+  NodeStruct n;
+  for (size_t i = 0; i < Nodes.slots() && count < NODES_PER_PAGE; i++)
   {
-    if (it->second.ip[0] != 0)
-    {
-      JsonObject node = nodes.createNestedObject();
-      node[F("name")] = it->second.nodeName;
-      node["type"]    = it->second.nodeType;
-      node["ip"]      = it->second.ip.toString();
-      node[F("age")]  = it->second.age;
-      node[F("vid")]  = it->second.build;
-    }
+    if (!Nodes.get(i, n) || skip-- > 0) continue;
+    JsonObject node = nodes.createNestedObject();
+    node[F("name")] = n.nodeName;
+    node["type"]    = n.nodeType;
+    node["ip"]      = n.address().toString();
+    node[F("age")]  = n.age();
+    node[F("vid")]  = n.build;
+    count++;
   }
 }
 
@@ -1061,7 +1080,7 @@ void serveJson(AsyncWebServerRequest* request)
     case JSON_PATH_INFO:
       serializeInfo(lDoc); break;
     case JSON_PATH_NODES:
-      serializeNodes(lDoc); break;
+      serializeNodes(lDoc, request->hasParam("page") ? request->getParam("page")->value().toInt() : 0); break;
     case JSON_PATH_PALETTES:
       serializePalettes(lDoc, request->hasParam("page") ? request->getParam("page")->value().toInt() : 0); break;
     case JSON_PATH_EFFECTS:
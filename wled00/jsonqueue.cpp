@@ -0,0 +1,152 @@
+#include "wled.h"
+
+/*
+ * JSON state request queue
+ *
+ * JSON state changes arriving while the JSON buffer is locked (HTTP POST /json/state, websocket, UDP)
+ * are copied into a small bounded queue and applied by the main loop once the buffer is free,
+ * instead of blocking the sender or failing with {"error":3}. Sources are served round robin so a
+ * busy client can not starve others. A source with requests waiting keeps queuing (see jsonQueuePending())
+ * so its requests are applied in order of arrival. Queued requests only change state and their response is
+ * the regular WS/UDP/MQTT state broadcast, except websocket messages which are applied like direct ones
+ * (incl. {"v":true}, "lv" and "dlt") and answered to their client if needed.
+ */
+
+#ifdef ESP8266
+  #define JSONQ_SLOTS     4
+  #define JSONQ_MAX_BYTES 4096  // all queued requests together
+#else
+  #define JSONQ_SLOTS     8
+  #define JSONQ_MAX_BYTES 16384
+#endif
+
+#define JSONQ_FREE    0
+#define JSONQ_CLAIMED 1  // being filled
+#define JSONQ_READY   2
+
+typedef struct JsonQueueSlot {
+  volatile uint32_t state;
+  uint8_t          source;
+  uint16_t         len;
+  uint32_t         seq;
+  uint32_t         client; // websocket client id
+  char            *data;
+} jsonqslot_t;
+
+static jsonqslot_t       jsonQueue[JSONQ_SLOTS] = {};
+static volatile uint32_t jsonQueueSeq   = 0;
+static volatile uint32_t jsonQueueBytes = 0;
+static uint8_t           jsonQueueLastSource = JSONQ_SOURCES - 1;
+
+static struct {
+  uint32_t queued[JSONQ_SOURCES];  // requests queued per source
+  uint32_t dropped[JSONQ_SOURCES]; // queue full or request too large
+  uint8_t  peak;                   // max. depth
+} jsonQueueStats = {};
+
+// the async web server runs in its own task on ESP32, on ESP8266 its callbacks never preempt the main loop
+#ifdef ARDUINO_ARCH_ESP32
+static inline bool jsonQueueCas(volatile uint32_t *p, uint32_t from, uint32_t to) { return __sync_bool_compare_and_swap(p, from, to); }
+static inline uint32_t jsonQueueAdd(volatile uint32_t *p, int32_t v) { return __sync_fetch_and_add(p, v); }
+#else
+static inline bool jsonQueueCas(volatile uint32_t *p, uint32_t from, uint32_t to) { if (*p != from) return false; *p = to; return true; }
+static inline uint32_t jsonQueueAdd(volatile uint32_t *p, int32_t v) { uint32_t o = *p; *p = o + v; return o; }
+#endif
+
+static uint8_t jsonQueueDepth() {
+  uint8_t n = 0;
+  for (size_t i = 0; i < JSONQ_SLOTS; i++) if (jsonQueue[i].state != JSONQ_FREE) n++;
+  return n;
+}
+
+// true if requests of source are waiting, a new request of that source has to be queued behind them
+bool jsonQueuePending(uint8_t source) {
+  for (size_t i = 0; i < JSONQ_SLOTS; i++) if (jsonQueue[i].state != JSONQ_FREE && jsonQueue[i].source == source) return true;
+  return false;
+}
+
+// queues a copy of a JSON state request (may be called from async web server callbacks), false if full
+bool queueJsonState(const char *json, size_t len, uint8_t source, uint32_t wsClient) {
+  if (source >= JSONQ_SOURCES) return false;
+  if (!len || jsonQueueBytes + len > JSONQ_MAX_BYTES) {
+    jsonQueueStats.dropped[source]++;
+    return false;
+  }
+  for (size_t i = 0; i < JSONQ_SLOTS; i++) {
+    jsonqslot_t &slot = jsonQueue[i];
+    if (!jsonQueueCas(&slot.state, JSONQ_FREE, JSONQ_CLAIMED)) continue; // async web server and main loop may both queue
+    slot.data = (char*) malloc(len + 1);
+    if (!slot.data) {
+      slot.state = JSONQ_FREE;
+      break;
+    }
+    memcpy(slot.data, json, len);
+    slot.data[len] = '\0';
+    slot.len    = len;
+    slot.source = source;
+    slot.client = wsClient;
+    slot.seq    = jsonQueueAdd(&jsonQueueSeq, 1);
+    jsonQueueAdd(&jsonQueueBytes, len);
+    jsonQueueStats.queued[source]++;
+    slot.state = JSONQ_READY;
+    uint8_t depth = jsonQueueDepth();
+    if (depth > jsonQueueStats.peak) jsonQueueStats.peak = depth;
+    DEBUG_PRINT(F("JSON request queued from source ")); DEBUG_PRINTLN(source);
+    return true;
+  }
+  jsonQueueStats.dropped[source]++;
+  return false;
+}
+
+// applies the next queued request if the JSON buffer is free, called from the main loop
+void handleJsonQueue() {
+  if (jsonBufferLock) return;
+
+  // next source (round robin) with a request waiting, oldest request of that source
+  int8_t next = -1;
+  for (size_t k = 1; k <= JSONQ_SOURCES && next < 0; k++) {
+    uint8_t src = (jsonQueueLastSource + k) % JSONQ_SOURCES;
+    for (size_t i = 0; i < JSONQ_SLOTS; i++) {
+      const jsonqslot_t &slot = jsonQueue[i];
+      if (slot.state != JSONQ_READY || slot.source != src) continue;
+      if (next < 0 || (int32_t)(slot.seq - jsonQueue[next].seq) < 0) next = i;
+    }
+  }
+  if (next < 0) return;
+  if (!requestJSONBufferLock(23)) return;
+
+  jsonqslot_t &slot = jsonQueue[next];
+  jsonQueueLastSource = slot.source;
+  DeserializationError error = deserializeJson(doc, slot.data, slot.len);
+  JsonObject root = doc.as<JsonObject>();
+  uint8_t response = WS_RESPONSE_NONE;
+  if (!error && !root.isNull()) {
+    if (slot.source == JSONQ_WS) response = applyWsJson(slot.client, root);
+    else deserializeState(root);
+  }
+  releaseJSONBufferLock();
+
+  #ifdef WLED_ENABLE_WEBSOCKETS
+  if (response == WS_RESPONSE_STATE) { // acknowledge has been sent when queued
+    AsyncWebSocketClient *wsc = ws.client(slot.client);
+    if (wsc) sendDataWs(wsc);
+  }
+  #endif
+
+  jsonQueueAdd(&jsonQueueBytes, -(int32_t)slot.len);
+  free(slot.data);
+  slot.data = nullptr;
+  slot.state = JSONQ_FREE;
+}
+
+void serializeJsonQueueStats(JsonObject root) {
+  JsonObject jq = root.createNestedObject(F("jq"));
+  jq[F("n")]  = jsonQueueDepth();
+  jq[F("pk")] = jsonQueueStats.peak;
+  JsonArray queued  = jq.createNestedArray(F("q"));    // http, ws, udp
+  JsonArray dropped = jq.createNestedArray(F("drop"));
+  for (size_t i = 0; i < JSONQ_SOURCES; i++) {
+    queued.add(jsonQueueStats.queued[i]);
+    dropped.add(jsonQueueStats.dropped[i]);
+  }
+}
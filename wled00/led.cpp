@@ -28,9 +28,10 @@ void setValuesFromSegment(uint8_t s)
 // problem: if the first selected segment already has the value to be set, other selected segments are not updated
 void applyValuesToSelectedSegs()
 {
-  // copy of first selected segment to tell if value was updated
+  // snapshot of first selected segment to tell if value was updated
   uint8_t firstSel = strip.getFirstSelectedSegId();
-  Segment selsegPrev = strip.getSegment(firstSel);
+  Segment::segsnap_t selsegPrev;
+  strip.getSegment(firstSel).snapshot(selsegPrev);
   for (uint8_t i = 0; i < strip.getSegmentsNum(); i++) {
     Segment& seg = strip.getSegment(i);
     if (i != firstSel && (!seg.isActive() || !seg.isSelected())) continue;
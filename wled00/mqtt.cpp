@@ -6,6 +6,22 @@
 
 #ifdef WLED_ENABLE_MQTT
 #define MQTT_KEEP_ALIVE_TIME 60    // contact the MQTT broker every 60 seconds
+#define MQTT_PUBLISH_INTERVAL 250  // ms, state is published at most 4 times a second
+#ifdef ESP8266
+  #define MQTT_QUEUE_LEN   4       // received messages waiting to be processed, more are dropped
+#else
+  #define MQTT_QUEUE_LEN   8
+#endif
+
+static char            *mqttQueue[MQTT_QUEUE_LEN] = {}; // "topic\0payload\0", allocated per message
+static char            *mqttMsg   = nullptr;  // message being received (partial packets)
+static volatile uint8_t mqttQHead = 0;        // written by the async client only
+static volatile uint8_t mqttQTail = 0;        // written by the main loop only
+static unsigned long    mqttLastPublish = 0;
+static bool             mqttPublished = false; // everything has been published since (re)connect
+static uint8_t          mqttPubBri = 0;
+static uint32_t         mqttPubCol = 0;
+static uint16_t         mqttPubXml = 0;
 
 void parseMQTTBriPayload(char* payload)
 {
@@ -47,38 +63,15 @@ void onMqttConnect(bool sessionPresent)
 
   usermods.onMqttConnect(sessionPresent);
 
+  mqttPublished = false; // publish all topics
   doPublishMqtt = true;
   DEBUG_PRINTLN(F("MQTT ready"));
 }
 
 
-void onMqttMessage(char* topic, char* payload, AsyncMqttClientMessageProperties properties, size_t len, size_t index, size_t total) {
-  static char *payloadStr;
-
-  DEBUG_PRINT(F("MQTT msg: "));
-  DEBUG_PRINTLN(topic);
-
-  // paranoia check to avoid npe if no payload
-  if (payload==nullptr) {
-    DEBUG_PRINTLN(F("no payload -> leave"));
-    return;
-  }
-
-  if (index == 0) {                       // start (1st partial packet or the only packet)
-    if (payloadStr) delete[] payloadStr;  // fail-safe: release buffer
-    payloadStr = new char[total+1];       // allocate new buffer
-  }
-  if (payloadStr == nullptr) return;      // buffer not allocated
-
-  // copy (partial) packet to buffer and 0-terminate it if it is last packet
-  char* buff = payloadStr + index;
-  memcpy(buff, payload, len);
-  if (index + len >= total) { // at end
-    payloadStr[total] = '\0'; // terminate c style string
-  } else {
-    DEBUG_PRINTLN(F("Partial packet received."));
-    return; // process next packet
-  }
+// applies a received message, returns false if it has to be retried (JSON buffer busy)
+static bool processMqttMessage(char *topic, char *payloadStr)
+{
   DEBUG_PRINTLN(payloadStr);
 
   size_t topicPrefixLen = strlen(mqttDeviceTopic);
@@ -91,9 +84,7 @@ void onMqttMessage(char* topic, char* payload, AsyncMqttClientMessageProperties
     } else {
       // Non-Wled Topic used here. Probably a usermod subscribed to this topic.
       usermods.onMqttMessage(topic, payloadStr);
-      delete[] payloadStr;
-      payloadStr = nullptr;
-      return;
+      return true;
     }
   }
 
@@ -103,11 +94,7 @@ void onMqttMessage(char* topic, char* payload, AsyncMqttClientMessageProperties
     colorFromDecOrHexString(col, payloadStr);
     colorUpdated(CALL_MODE_DIRECT_CHANGE);
   } else if (strcmp_P(topic, PSTR("/api")) == 0) {
-    if (!requestJSONBufferLock(15)) {
-      delete[] payloadStr;
-      payloadStr = nullptr;
-      return;
-    }
+    if (jsonBufferLock || !requestJSONBufferLock(15)) return false; // keep queued, retry on next loop
     if (payloadStr[0] == '{') { //JSON API
       deserializeJson(doc, payloadStr);
       deserializeState(doc.as<JsonObject>());
@@ -124,40 +111,118 @@ void onMqttMessage(char* topic, char* payload, AsyncMqttClientMessageProperties
     // topmost topic (just wled/MAC)
     parseMQTTBriPayload(payloadStr);
   }
-  delete[] payloadStr;
-  payloadStr = nullptr;
+  return true;
 }
 
 
+// Received messages are assembled in a buffer allocated per message and handed to the main loop through a short
+// queue, so /api commands arriving while the JSON buffer is locked wait instead of being dropped. Messages are
+// always applied in the order received: if the queue is full the new message is dropped and counted (info.mqttdrop).
+void onMqttMessage(char* topic, char* payload, AsyncMqttClientMessageProperties properties, size_t len, size_t index, size_t total) {
+  DEBUG_PRINT(F("MQTT msg: "));
+  DEBUG_PRINTLN(topic);
+
+  // paranoia check to avoid npe if no payload
+  if (payload==nullptr) {
+    DEBUG_PRINTLN(F("no payload -> leave"));
+    return;
+  }
+
+  if (index == 0) {                       // start (1st partial packet or the only packet)
+    free(mqttMsg);                        // fail-safe: release buffer
+    mqttMsg = (char*) malloc(strlen(topic) + total + 2);
+    if (mqttMsg) strcpy(mqttMsg, topic);
+    else {
+      DEBUG_PRINTLN(F("MQTT message too large, dropped."));
+      mqttDropped++;
+    }
+  }
+  if (mqttMsg == nullptr) return;         // buffer not allocated
+
+  // copy (partial) packet behind the topic and 0-terminate it if it is last packet
+  char *payloadStr = mqttMsg + strlen(mqttMsg) + 1;
+  memcpy(payloadStr + index, payload, len);
+  if (index + len < total) {
+    DEBUG_PRINTLN(F("Partial packet received."));
+    return; // process next packet
+  }
+  payloadStr[total] = '\0';             // terminate c style string
+
+  if (uint8_t(mqttQHead - mqttQTail) < MQTT_QUEUE_LEN) {
+    mqttQueue[mqttQHead % MQTT_QUEUE_LEN] = mqttMsg;
+    mqttQHead++;                          // hand over to main loop
+  } else {
+    DEBUG_PRINTLN(F("MQTT queue full, dropped."));
+    mqttDropped++;
+    free(mqttMsg);
+  }
+  mqttMsg = nullptr;
+}
+
+// processes queued messages in order, called from the main loop
+void handleMqtt()
+{
+  while (mqttQTail != mqttQHead) {
+    char *msg = mqttQueue[mqttQTail % MQTT_QUEUE_LEN];
+    if (!processMqttMessage(msg, msg + strlen(msg) + 1)) return; // keep order, retry on next loop
+    free(msg);
+    mqttQTail++;
+  }
+}
+
+
+// publishes changed values only, at most once per MQTT_PUBLISH_INTERVAL (state changes in between are coalesced)
 void publishMqtt()
 {
+  if (!WLED_MQTT_CONNECTED) {
+    doPublishMqtt = false;
+    return;
+  }
+  if (millis() - mqttLastPublish < MQTT_PUBLISH_INTERVAL) return; // doPublishMqtt stays set
   doPublishMqtt = false;
-  if (!WLED_MQTT_CONNECTED) return;
+  mqttLastPublish = millis();
   DEBUG_PRINTLN(F("Publish MQTT"));
 
   #ifndef USERMOD_SMARTNEST
   char s[10];
   char subuf[38];
 
-  sprintf_P(s, PSTR("%u"), bri);
-  strlcpy(subuf, mqttDeviceTopic, 33);
-  strcat_P(subuf, PSTR("/g"));
-  mqtt->publish(subuf, 0, retainMqttMsg, s);         // optionally retain message (#2263)
-
-  sprintf_P(s, PSTR("#%06X"), (col[3] << 24) | (col[0] << 16) | (col[1] << 8) | (col[2]));
-  strlcpy(subuf, mqttDeviceTopic, 33);
-  strcat_P(subuf, PSTR("/c"));
-  mqtt->publish(subuf, 0, retainMqttMsg, s);         // optionally retain message (#2263)
-
-  strlcpy(subuf, mqttDeviceTopic, 33);
-  strcat_P(subuf, PSTR("/status"));
-  mqtt->publish(subuf, 0, true, "online");          // retain message for a LWT
-
-  char apires[1024];                                // allocating 1024 bytes from stack can be risky
-  XML_response(nullptr, apires);
-  strlcpy(subuf, mqttDeviceTopic, 33);
-  strcat_P(subuf, PSTR("/v"));
-  mqtt->publish(subuf, 0, retainMqttMsg, apires);   // optionally retain message (#2263)
+  if (!mqttPublished || bri != mqttPubBri) {
+    sprintf_P(s, PSTR("%u"), bri);
+    strlcpy(subuf, mqttDeviceTopic, 33);
+    strcat_P(subuf, PSTR("/g"));
+    mqtt->publish(subuf, 0, retainMqttMsg, s);         // optionally retain message (#2263)
+    mqttPubBri = bri;
+  }
+
+  uint32_t c = (col[3] << 24) | (col[0] << 16) | (col[1] << 8) | (col[2]);
+  if (!mqttPublished || c != mqttPubCol) {
+    sprintf_P(s, PSTR("#%06X"), c);
+    strlcpy(subuf, mqttDeviceTopic, 33);
+    strcat_P(subuf, PSTR("/c"));
+    mqtt->publish(subuf, 0, retainMqttMsg, s);         // optionally retain message (#2263)
+    mqttPubCol = c;
+  }
+
+  if (!mqttPublished) {
+    strlcpy(subuf, mqttDeviceTopic, 33);
+    strcat_P(subuf, PSTR("/status"));
+    mqtt->publish(subuf, 0, true, "online");          // retain message for a LWT
+  }
+
+  char *apires = (char*) malloc(1024);               // only while publishing, too large for the stack
+  if (apires) {
+    XML_response(nullptr, apires);
+    uint16_t h = crc16((const unsigned char*)apires, strlen(apires));
+    if (!mqttPublished || h != mqttPubXml) {
+      strlcpy(subuf, mqttDeviceTopic, 33);
+      strcat_P(subuf, PSTR("/v"));
+      mqtt->publish(subuf, 0, retainMqttMsg, apires);  // optionally retain message (#2263)
+      mqttPubXml = h;
+    }
+    free(apires);
+  }
+  mqttPublished = true;
   #endif
 }
 
@@ -0,0 +1,165 @@
+#include "wled.h"
+
+/*
+ * Batched gradient (Perlin) noise used by noise based effects.
+ *
+ * Effects sample noise along a line (a row of a matrix or a strip) in a plane of constant z.
+ * For a given z each lattice point (X,Y) can be collapsed into a 2D linear function of the
+ * position within its cell (a*x + b*y + c), which is kept in a small cache, so consecutive
+ * samples, rows and frames (as long as z does not change) reuse lattice corners instead of
+ * re-hashing and re-interpolating 8 corners per pixel.
+ * Values follow FastLED inoise16()/inoise8() in range and character (improved Perlin gradients,
+ * quadratic easing, 16.16 fixed point lattice coordinates) but are not bit identical.
+ */
+
+#ifdef ESP8266
+  #define NOISE_CACHE_BITS 4 // lattice columns cached per row
+#else
+  #define NOISE_CACHE_BITS 7
+#endif
+#define NOISE_CACHE_MASK ((1<<NOISE_CACHE_BITS)-1)
+#define NOISE_CHUNK      32  // samples accumulated at once when summing octaves
+
+// Ken Perlin's permutation table
+static const uint8_t noisePerm[256] PROGMEM = {
+  151,160,137, 91, 90, 15,131, 13,201, 95, 96, 53,194,233,  7,225,140, 36,103, 30, 69,142,  8, 99, 37,240, 21, 10, 23,190,  6,148,
+  247,120,234, 75,  0, 26,197, 62, 94,252,219,203,117, 35, 11, 32, 57,177, 33, 88,237,149, 56, 87,174, 20,125,136,171,168, 68,175,
+   74,165, 71,134,139, 48, 27,166, 77,146,158,231, 83,111,229,122, 60,211,133,230,220,105, 92, 41, 55, 46,245, 40,244,102,143, 54,
+   65, 25, 63,161,  1,216, 80, 73,209, 76,132,187,208, 89, 18,169,200,196,135,130,116,188,159, 86,164,100,109,198,173,186,  3, 64,
+   52,217,226,250,124,123,  5,202, 38,147,118,126,255, 82, 85,212,207,206, 59,227, 47, 16, 58, 17,182,189, 28, 42,223,183,170,213,
+  119,248,152,  2, 44,154,163, 70,221,153,101,155,167, 43,172,  9,129, 22, 39,253, 19, 98,108,110, 79,113,224,232,178,185,112,104,
+  218,246, 97,228,251, 34,242,193,238,210,144, 12,191,179,162,241, 81, 51,145,235,249, 14,239,107, 49,192,214, 31,181,199,106,157,
+  184, 84,204,176,115,121, 50, 45,127,  4,150,254,138,236,205, 93,222,114, 67, 29, 24, 72,243,141,128,195, 78, 66,215, 61,156,180
+};
+#define NP(i) pgm_read_byte(noisePerm + ((i) & 0xFF))
+
+// lattice point collapsed for current z: gradient contribution is (a*xx + b*yy) >> 15 + c
+typedef struct NoiseLattice {
+  int32_t  a, b, c;
+  uint16_t gen;      // z generation the entry was computed for
+  uint8_t  x, y;     // lattice coordinates (tag)
+} noiseLattice;
+
+static noiseLattice noiseCache[2 << NOISE_CACHE_BITS]; // indexed by X and parity of Y
+static uint32_t noiseZ   = 0;
+static uint16_t noiseGen = 0;    // 0 = nothing cached
+static uint8_t  noiseZc  = 0;    // lattice z
+static int32_t  noiseZz  = 0;    // position within cell (15 bit)
+static int32_t  noiseZw  = 0;    // eased position within cell (15 bit weight)
+
+// quadratic ease in/out (as FastLED ease16InOutQuad), result scaled to 15 bits
+static inline int32_t noiseEase(uint16_t i) {
+  uint16_t j = (i & 0x8000) ? 65535 - i : i;
+  uint16_t jj = ((uint32_t)j * j) >> 15;
+  return ((i & 0x8000) ? 65535 - jj : jj) >> 1;
+}
+
+// axis coefficients of improved Perlin noise gradient for a hash
+static inline void noiseGrad(uint8_t hash, int8_t &cx, int8_t &cy, int8_t &cz) {
+  hash &= 15;
+  int8_t u = (hash & 1) ? -1 : 1;
+  int8_t v = (hash & 2) ? -1 : 1;
+  cx = cy = cz = 0;
+  if (hash < 8) cx = u; else cy = u;
+  if (hash < 4) cy = v; else if (hash == 12 || hash == 14) cx = v; else cz = v;
+}
+
+static void noiseSetZ(uint32_t z) {
+  if (noiseGen && z == noiseZ) return;
+  noiseZ  = z;
+  noiseZc = z >> 16;
+  noiseZz = (z & 0xFFFF) >> 1;
+  noiseZw = noiseEase(z);
+  if (++noiseGen == 0) { // wrapped, drop stale entries
+    memset(noiseCache, 0, sizeof(noiseCache));
+    noiseGen = 1;
+  }
+}
+
+static const noiseLattice *noiseLatticePoint(uint8_t X, uint8_t Y) {
+  noiseLattice *p = &noiseCache[(X & NOISE_CACHE_MASK) | ((Y & 1) << NOISE_CACHE_BITS)];
+  if (p->gen == noiseGen && p->x == X && p->y == Y) return p;
+  uint8_t h = NP(NP(X) + Y) + noiseZc;
+  int8_t cx0, cy0, cz0, cx1, cy1, cz1;
+  noiseGrad(NP(h),   cx0, cy0, cz0);
+  noiseGrad(NP(h+1), cx1, cy1, cz1);
+  const int32_t w1 = noiseZw, w0 = 32768 - w1;
+  p->a = cx0 * w0 + cx1 * w1;
+  p->b = cy0 * w0 + cy1 * w1;
+  p->c = (cz0 * noiseZz * w0 + cz1 * (noiseZz - 32768) * w1) >> 15;
+  p->gen = noiseGen;
+  p->x = X;
+  p->y = Y;
+  return p;
+}
+
+static inline int32_t noiseEval(const noiseLattice *p, int32_t xx, int32_t yy) {
+  return (((p->a * xx) >> 15) + ((p->b * yy) >> 15) + p->c) >> 1;
+}
+
+// raw noise (about -19000..19000) along a line in the current z plane, added to acc after >> shift
+static void noiseLine(int32_t *acc, uint16_t len, uint32_t x, int32_t dx, uint32_t y, int32_t dy, uint8_t shift) {
+  const noiseLattice *c00 = nullptr, *c10 = nullptr, *c01 = nullptr, *c11 = nullptr;
+  uint8_t X = 0, Y = 0;
+  for (unsigned i = 0; i < len; i++, x += dx, y += dy) {
+    if (!c00 || X != uint8_t(x >> 16) || Y != uint8_t(y >> 16)) { // entered a new cell
+      X = x >> 16;
+      Y = y >> 16;
+      c00 = noiseLatticePoint(X,   Y);
+      c10 = noiseLatticePoint(X+1, Y);
+      c01 = noiseLatticePoint(X,   Y+1);
+      c11 = noiseLatticePoint(X+1, Y+1);
+    }
+    const int32_t xx = (x & 0xFFFF) >> 1, yy = (y & 0xFFFF) >> 1;
+    const int32_t u  = noiseEase(x),      v  = noiseEase(y);
+    const int32_t g00 = noiseEval(c00, xx, yy),         g10 = noiseEval(c10, xx - 32768, yy);
+    const int32_t g01 = noiseEval(c01, xx, yy - 32768), g11 = noiseEval(c11, xx - 32768, yy - 32768);
+    const int32_t l0 = g00 + (((g10 - g00) * u) >> 15);
+    const int32_t l1 = g01 + (((g11 - g01) * u) >> 15);
+    acc[i] += (l0 + (((l1 - l0) * v) >> 15)) >> shift;
+  }
+}
+
+// scale raw noise to 16 bit range like inoise16()
+static inline uint16_t noiseScale(int32_t n) {
+  n = ((n + 19052L) * 440L) >> 8;
+  return n < 0 ? 0 : n > 65535 ? 65535 : n;
+}
+
+// samples in chunks so octaves can be summed without extra memory
+template <typename T, uint8_t S>
+static void fillNoise(T *dst, uint16_t len, uint32_t x, int32_t dx, uint32_t y, int32_t dy, uint32_t z, uint8_t octaves) {
+  int32_t acc[NOISE_CHUNK];
+  if (octaves < 1) octaves = 1;
+  if (octaves > 8) octaves = 8;
+  const int32_t norm = (1L << octaves) - 1; // sum of octave amplitudes (in units of the smallest one)
+  noiseSetZ(z);
+  for (unsigned s = 0; s < len; s += NOISE_CHUNK) {
+    const uint16_t n = min((unsigned)NOISE_CHUNK, len - s);
+    memset(acc, 0, sizeof(acc));
+    for (unsigned o = 0; o < octaves; o++) {
+      // each octave doubles frequency and halves amplitude, offset decorrelates octaves
+      noiseLine(acc, n, (x + s*dx) << o, dx << o, ((y + s*dy) << o) + o*0x1A2B3CUL, dy << o, o);
+    }
+    for (unsigned i = 0; i < n; i++) {
+      int32_t v = octaves > 1 ? (acc[i] << (octaves-1)) / norm : acc[i];
+      dst[s+i] = noiseScale(v) >> S;
+    }
+  }
+}
+
+// fill dst with 16 bit noise along a line starting at x,y (16.16 fixed point lattice coordinates) stepping dx,dy per sample
+void fillNoise16(uint16_t *dst, uint16_t len, uint32_t x, int32_t dx, uint32_t y, int32_t dy, uint32_t z, uint8_t octaves) {
+  fillNoise<uint16_t,0>(dst, len, x, dx, y, dy, z, octaves);
+}
+
+// same as fillNoise16() with 8 bit results (inoise8() coordinates need to be shifted left by 8)
+void fillNoise8(uint8_t *dst, uint16_t len, uint32_t x, int32_t dx, uint32_t y, int32_t dy, uint32_t z, uint8_t octaves) {
+  fillNoise<uint8_t,8>(dst, len, x, dx, y, dy, z, octaves);
+}
+
+uint16_t noise16(uint32_t x, uint32_t y, uint32_t z) {
+  uint16_t n;
+  fillNoise16(&n, 1, x, 0, y, 0, z, 1);
+  return n;
+}
@@ -92,6 +92,7 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
     Bus::setGlobalAWMode(request->arg(F("AW")).toInt());
     strip.setTargetFps(request->arg(F("FR")).toInt());
     useGlobalLedBuffer = request->hasArg(F("LD"));
+    BusNetwork::setSyncOutput(request->hasArg(F("NS")));
 
     bool busesChanged = false;
     for (uint8_t s = 0; s < WLED_MAX_BUSSES+WLED_MIN_VIRTUAL_BUSSES; s++) {
@@ -154,6 +155,18 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
       // this may happen even before this loop is finished so we do "doInitBusses" after the loop
       if (busConfigs[s] != nullptr) delete busConfigs[s];
       busConfigs[s] = new BusConfig(type, pins, start, length, colorOrder | (channelSwap<<4), request->hasArg(cv), skip, awmode, freqHz, useGlobalLedBuffer);
+      if ((type & 0x7F) >= TYPE_NET_DDP_RGB && (type & 0x7F) < 96) {
+        // universe/start channel, kept from the existing bus if not sent
+        char un[4] = "UN"; un[2] = 48+s; un[3] = 0; //network bus universe
+        char uc[4] = "UC"; uc[2] = 48+s; uc[3] = 0; //network bus start channel
+        Bus *bus = busses.getBus(s);
+        if (bus && bus->getType() == (type & 0x7F)) {
+          busConfigs[s]->universe = bus->getUniverse();
+          busConfigs[s]->startChannel = bus->getStartChannel();
+        }
+        if (request->hasArg(un)) busConfigs[s]->universe = request->arg(un).toInt();
+        if (request->hasArg(uc)) busConfigs[s]->startChannel = request->arg(uc).toInt();
+      }
       busesChanged = true;
     }
     //doInitBusses = busesChanged; // we will do that below to ensure all input data is processed
@@ -311,11 +324,16 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
 
     t = request->arg(F("UR")).toInt();
     if ((t>=0) && (t<30)) udpNumRetries = t;
+    notifyDelta = request->hasArg(F("SV"));
+    for (int i=0;i<4;i++){
+      String a = "UM"+String(i);
+      syncMulticastIP[i] = request->arg(a).toInt();
+    }
 
 
-    nodeListEnabled = request->hasArg(F("NL"));
-    if (!nodeListEnabled) Nodes.clear();
+    nodeListEnabled = request->hasArg(F("NL")); // table is released by refreshNodeList()
     nodeBroadcastEnabled = request->hasArg(F("NB"));
+    timeSyncEnabled = request->hasArg(F("TS"));
 
     receiveDirect = request->hasArg(F("RD"));
     useMainSegmentOnly = request->hasArg(F("MO"));
@@ -339,6 +357,9 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
     arlsDisableGammaCorrection = request->hasArg(F("RG"));
     t = request->arg(F("WO")).toInt();
     if (t >= -255  && t <= 255) arlsOffset = t;
+    t = request->arg(F("JB")).toInt();
+    if (t >= 0 && t <= 1000) realtimeJitterMs = t;
+    realtimeInterpolate = request->hasArg(F("JI"));
 
     alexaEnabled = request->hasArg(F("AL"));
     strlcpy(alexaInvocationName, request->arg(F("AI")).c_str(), 33);
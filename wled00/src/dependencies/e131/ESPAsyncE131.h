@@ -59,6 +59,10 @@ typedef struct ip_addr ip4_addr_t;
 #define ARTNET_OPCODE_OPDMX 0x5000
 #define ARTNET_OPCODE_OPPOLL 0x2000
 #define ARTNET_OPCODE_OPPOLLREPLY 0x2100
+#define ARTNET_OPCODE_OPSYNC 0x5200
+
+#define E131_VECTOR_ROOT_EXTENDED 0x08 // E1.31 extended packets (sync, discovery)
+#define E131_VECTOR_FRAME_SYNC    0x01 // E1.31 synchronization packet
 
 #define P_E131   0
 #define P_ARTNET 1
@@ -0,0 +1,227 @@
+#include "wled.h"
+
+/*
+ * Effect clock synchronisation between WLED instances
+ *
+ * The instance with the lowest IP among those advertising time sync in their node info
+ * (see sendSysInfoUDP()) is the leader. Every other instance periodically asks the leader
+ * for its effect clock (millis() + strip.timebase) over the node info port and estimates
+ * offset and round trip NTP style: offset = ((t2-t1) + (t3-t4)) / 2, delay = (t4-t1) - (t3-t2).
+ * The sample with the lowest delay out of the last few is used (clock filter), large offsets are
+ * stepped, small ones slewed and a frequency correction is integrated so crystal drift does not
+ * build up between samples.
+ */
+
+#define TIMESYNC_REQUEST     2      // node info channel message ids (1 is node info)
+#define TIMESYNC_REPLY       3
+#define TIMESYNC_SAMPLES     8      // clock filter depth
+#define TIMESYNC_INTERVAL    2000   // ms between requests once locked
+#define TIMESYNC_ACQUIRE     500    // ms between requests while acquiring
+#define TIMESYNC_STEP_US     50000  // larger offsets are stepped instead of slewed
+#define TIMESYNC_SLEW_US     500    // max. phase correction per 100ms (0.5%)
+#define TIMESYNC_MAX_PPM     500    // frequency correction limit
+#define TIMESYNC_GAIN        8      // integral gain divisor (per second of interval)
+#define TIMESYNC_MAX_RTT_US  200000 // replies taking longer are ignored
+#define TIMESYNC_NODE_AGE    3      // nodes not heard of for longer (in 30s node list ticks) can't lead
+
+typedef struct TimeSyncSample {
+  int32_t  offset;  // us, leader - local (kept current by subtracting corrections applied since)
+  uint32_t delay;   // us round trip
+} tsSample;
+
+static tsSample  tsSamples[TIMESYNC_SAMPLES];
+static uint8_t   tsSampleCnt  = 0;
+static uint8_t   tsSampleIdx  = 0;
+static uint8_t   tsBestAge    = TIMESYNC_SAMPLES; // age (in samples) of the sample used last
+static IPAddress tsLeader;               // 0.0.0.0: we lead (or nobody to follow)
+static bool      tsLocked     = false;   // coarse step done, slewing from now on
+static uint8_t   tsSeq        = 0;
+static uint32_t  tsT1         = 0;       // local clock (us) when the outstanding request was sent
+static uint32_t  tsLastRequest = 0;
+static uint32_t  tsLastTick   = 0;
+static uint32_t  tsLastSample = 0;
+static int32_t   tsSlewUs     = 0;       // phase correction still to be applied
+static int32_t   tsFreq       = 0;       // frequency correction (ppm, us per s)
+static int32_t   tsFreqAcc    = 0;       // frequency correction remainder (ppm * ms)
+static int32_t   tsFracUs     = 0;       // applied correction not yet moved into strip.timebase
+static int32_t   tsOffset     = 0;       // last filtered offset (us) for info
+static uint32_t  tsDelay      = 0;       // round trip of the filtered sample (us) for info
+
+// effect clock in us, including sub-millisecond correction not yet moved into strip.timebase
+static inline uint32_t timeSyncMicros() {
+  return micros() + strip.timebase * 1000UL + tsFracUs;
+}
+
+static void timeSyncReset() {
+  tsSampleCnt = tsSampleIdx = 0;
+  tsBestAge = TIMESYNC_SAMPLES;
+  tsSlewUs = tsFreqAcc = 0;
+  tsLocked = false;
+}
+
+// move the local effect clock forward (or back) by us microseconds
+static void timeSyncCorrect(int32_t us) {
+  if (!us) return;
+  for (size_t i = 0; i < tsSampleCnt; i++) tsSamples[i].offset -= us;
+  tsFracUs += us;
+  int32_t ms = tsFracUs / 1000;
+  tsFracUs -= ms * 1000;
+  strip.timebase += ms;
+}
+
+static inline uint32_t ipValue(const IPAddress &ip) {
+  return (uint32_t(ip[0]) << 24) | (uint32_t(ip[1]) << 16) | (uint32_t(ip[2]) << 8) | ip[3];
+}
+
+// lowest IP of all instances taking part wins
+static IPAddress timeSyncElect() {
+  IPAddress self = Network.localIP();
+  IPAddress best = self;
+  for (size_t i = 0; i < Nodes.slots(); i++) {
+    const NodeStruct *n = Nodes.at(i);
+    if (!n || !(n->flags & NODE_FLAG_TIMESYNC) || n->age() > TIMESYNC_NODE_AGE || n->address() == self) continue;
+    if (ipValue(n->address()) < ipValue(best)) best = n->address();
+  }
+  return best == self ? IPAddress(0,0,0,0) : best;
+}
+
+static inline void putU32(byte *p, uint32_t v) {
+  p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+}
+
+static inline uint32_t getU32(const byte *p) {
+  return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+
+static void timeSyncSample(const byte *p, uint32_t t4) {
+  uint32_t t2   = getU32(p + 3);
+  uint32_t t3   = getU32(p + 7);
+  uint32_t t3ms = getU32(p + 11);
+  int32_t  rtt  = t4 - tsT1;
+  if (rtt < 0 || rtt > TIMESYNC_MAX_RTT_US) return;
+  tsLastSample = millis();
+
+  // clocks may be hours apart initially, first align to the millisecond clock
+  int32_t coarse = int32_t(t3ms + rtt / 2000 - (millis() + strip.timebase));
+  if (!tsLocked || coarse > TIMESYNC_STEP_US/1000 || coarse < -TIMESYNC_STEP_US/1000) {
+    DEBUG_PRINTF("Time sync: step %d ms\n", coarse);
+    timeSyncReset();
+    strip.timebase += coarse;
+    tsLocked = true;
+    return;
+  }
+
+  int32_t delay = rtt - int32_t(t3 - t2);
+  tsSample &s = tsSamples[tsSampleIdx];
+  s.offset = (int32_t(t2 - tsT1) + int32_t(t3 - t4)) / 2;
+  s.delay  = delay < 0 ? 0 : delay;
+  tsSampleIdx = (tsSampleIdx + 1) % TIMESYNC_SAMPLES;
+  if (tsSampleCnt < TIMESYNC_SAMPLES) tsSampleCnt++;
+
+  // least delayed sample carries the least asymmetric queuing, an older one than last time is no news
+  uint8_t best = 0;
+  for (size_t i = 1; i < tsSampleCnt; i++) if (tsSamples[i].delay < tsSamples[best].delay) best = i;
+  uint8_t age = (tsSampleIdx + TIMESYNC_SAMPLES - 1 - best) % TIMESYNC_SAMPLES; // 0: newest
+  bool fresh = age < tsBestAge;
+  tsBestAge = age + 1; // its age when the next sample arrives
+  tsOffset = tsSamples[best].offset;
+  tsDelay  = tsSamples[best].delay;
+
+  if (tsOffset > TIMESYNC_STEP_US || tsOffset < -TIMESYNC_STEP_US) {
+    int32_t step = tsOffset;
+    timeSyncReset();
+    timeSyncCorrect(step);
+    tsLocked = true;
+    return;
+  }
+  if (tsSampleCnt < 2 || !fresh) return;
+  // proportional part is slewed until the next sample, integral part adjusts frequency
+  tsSlewUs = tsOffset;
+  tsFreq  += tsOffset / (TIMESYNC_GAIN * TIMESYNC_INTERVAL / 1000);
+  tsFreq   = constrain(tsFreq, -TIMESYNC_MAX_PPM, TIMESYNC_MAX_PPM);
+}
+
+// handles time sync requests and replies received on the node info port, returns true if consumed
+bool handleTimeSyncPacket(const byte *p, size_t len, IPAddress remote) {
+  if (len < 3 || p[0] != 255 || (p[1] != TIMESYNC_REQUEST && p[1] != TIMESYNC_REPLY)) return false;
+  if (!timeSyncEnabled) return true;
+  uint32_t rxUs = timeSyncMicros();
+
+  if (p[1] == TIMESYNC_REQUEST) {
+    // anybody asking gets an answer, whether we are leader is up to the follower
+    byte reply[15];
+    reply[0] = 255;
+    reply[1] = TIMESYNC_REPLY;
+    reply[2] = p[2];
+    putU32(reply + 3, rxUs);
+    putU32(reply + 11, millis() + strip.timebase);
+    putU32(reply + 7, timeSyncMicros());
+    notifier2Udp.beginPacket(remote, udpPort2);
+    notifier2Udp.write(reply, sizeof(reply));
+    notifier2Udp.endPacket();
+  } else if (len >= 15 && p[2] == tsSeq && remote == tsLeader) {
+    tsSeq++; // ignore late duplicates
+    timeSyncSample(p, rxUs);
+  }
+  return true;
+}
+
+void handleTimeSync() {
+  if (!timeSyncEnabled || !udp2Connected) return;
+  uint32_t now = millis();
+
+  // apply frequency and phase correction
+  uint32_t dt = now - tsLastTick;
+  if (dt >= 100) {
+    tsLastTick = now;
+    int32_t corr = 0;
+    if (tsLocked) {
+      tsFreqAcc += tsFreq * int32_t(dt);
+      corr = tsFreqAcc / 1000;
+      tsFreqAcc -= corr * 1000;
+      int32_t slewMax = TIMESYNC_SLEW_US * int32_t(dt) / 100;
+      int32_t slew = constrain(tsSlewUs, -slewMax, slewMax);
+      tsSlewUs -= slew;
+      corr += slew;
+    }
+    timeSyncCorrect(corr);
+  }
+
+  if (now - tsLastRequest < (tsSampleCnt < TIMESYNC_SAMPLES/2 ? TIMESYNC_ACQUIRE : TIMESYNC_INTERVAL)) return;
+  tsLastRequest = now;
+
+  IPAddress leader = timeSyncElect();
+  if (leader != tsLeader) {
+    DEBUG_PRINT(F("Time sync leader: ")); DEBUG_PRINTLN(leader);
+    tsLeader = leader;
+    timeSyncReset();
+    tsFreq = 0;
+  }
+  if (!tsLeader[0]) return;
+  if (tsLocked && now - tsLastSample > 10 * TIMESYNC_INTERVAL) timeSyncReset(); // leader gone quiet, re-acquire when it is back
+
+  byte req[3] = { 255, TIMESYNC_REQUEST, ++tsSeq };
+  tsT1 = timeSyncMicros();
+  notifier2Udp.beginPacket(tsLeader, udpPort2);
+  notifier2Udp.write(req, sizeof(req));
+  notifier2Udp.endPacket();
+}
+
+// true if the effect clock follows another instance (notifications must not touch the timebase)
+bool timeSyncFollowing() {
+  return timeSyncEnabled && tsLeader[0];
+}
+
+void serializeTimeSync(JsonObject root) {
+  if (!timeSyncEnabled) return;
+  JsonObject ts = root.createNestedObject(F("ts"));
+  if (!tsLeader[0]) {
+    ts[F("lead")] = F("self");
+    return;
+  }
+  ts[F("lead")] = tsLeader.toString();
+  ts[F("lock")] = tsLocked;
+  ts[F("ofs")]  = tsOffset;
+  ts[F("rtt")]  = tsDelay;
+  ts[F("ppm")]  = tsFreq;
+}
@@ -10,6 +10,121 @@
 #define UDP_IN_MAXSIZE 1472
 #define PRESUMED_NETWORK_DELAY 3 //how many ms could it take on avg to reach the receiver? This will be added to transmitted times
 
+// protocol v13: v12 header (without segments) followed by session, revision and changed segment fields only
+#define UDP_V13_HEADER   49 // 41 + session (2) + revision (4) + flags (1) + number of segment records (1)
+#define UDP_V13_SEG_MAX  37 // id, changed fields mask, opacity (1), options (2), colors & CCT (13), effect (7), bounds (8), GSO (4)
+#define UDP_V13_FIELDS   (SEG_DIFFERS_BRI | SEG_DIFFERS_OPT | SEG_DIFFERS_COL | SEG_DIFFERS_FX | SEG_DIFFERS_BOUNDS | SEG_DIFFERS_GSO)
+#define UDP_V13_KEYFRAME 10 // every n-th revision carries all fields of all segments
+#define UDP_V13_KEYFRAME_MS 5000 // as does the first notification this long after the previous key frame
+#define UDP_V13_SENDERS  8  // senders tracked for duplicate/stale detection
+#define WLEDPACKETSIZE_V13 (UDP_V13_HEADER+(MAX_NUM_SEGMENTS*UDP_V13_SEG_MAX))
+
+static byte     syncPacket[WLEDPACKETSIZE_V13 > WLEDPACKETSIZE ? WLEDPACKETSIZE_V13 : WLEDPACKETSIZE]; // last sent notification, retransmitted as is
+static size_t   syncPacketLen = 0;
+static uint16_t syncSession   = 0;  // random per boot, receivers restart revision tracking when it changes
+static uint32_t syncRevision  = 0;
+static uint32_t syncSentSegs  = 0;  // bitmap of segments present in the previous v13 notification
+static unsigned long syncLastKeyframe = 0;
+static Segment::segsnap_t syncSent[MAX_NUM_SEGMENTS]; // segment state as of the previous v13 notification
+
+typedef struct SyncSender {
+  uint32_t ip;
+  uint32_t revision;
+  uint16_t session;
+} syncSender;
+static syncSender syncSenders[UDP_V13_SENDERS];
+static uint8_t    syncSenderNext = 0;
+
+// receive stage: datagrams handled per handleNotifications() call
+#define UDP_RX_RGB       0  // sources, in order of priority
+#define UDP_RX_NOTIFIER  1
+#define UDP_RX_INFO      2
+#define UDP_RX_SOURCES   3
+#define UDP_RX_BATCH     16 // max. datagrams per call
+#ifdef ESP8266
+  #define UDP_RX_BUDGET_US 3000 // time budget per call (a datagram in progress is always finished)
+#else
+  #define UDP_RX_BUDGET_US 5000
+#endif
+
+static uint8_t  udpRxBuf[UDP_IN_MAXSIZE+1];     // shared receive buffer (+1 for terminating API strings)
+static uint16_t udpRxPending[UDP_RX_SOURCES];   // size of a datagram already parsed (peeked at) but not read
+
+typedef struct UdpRxStats {
+  uint32_t rx[UDP_RX_SOURCES];   // datagrams received
+  uint32_t drop[UDP_RX_SOURCES]; // oversized or superseded realtime frames
+  uint16_t depth;                // datagrams drained by the last call
+  uint16_t peak;                 // max. depth since last reported
+} udpRxStats_t;
+static udpRxStats_t udpRxStats;
+
+// sync notifications are received on the multicast group if one is configured (unicast and broadcast still arrive)
+bool beginSyncUdp()
+{
+  if (!syncMulticastIP[0]) return notifierUdp.begin(udpPort);
+  #ifdef ARDUINO_ARCH_ESP32
+  return notifierUdp.beginMulticast(syncMulticastIP, udpPort);
+  #else
+  return notifierUdp.beginMulticast(Network.localIP(), syncMulticastIP, udpPort);
+  #endif
+}
+
+static void sendSyncPacket()
+{
+  IPAddress dest = syncMulticastIP;
+  if (!dest[0]) dest = ~uint32_t(Network.subnetMask()) | uint32_t(Network.gatewayIP());
+  notifierUdp.beginPacket(dest, udpPort);
+  notifierUdp.write(syncPacket, syncPacketLen);
+  notifierUdp.endPacket();
+}
+
+// append fields of segment i that changed since the previous notification, returns bytes written
+static size_t writeSegmentDelta(byte *p, uint8_t i, Segment &seg, bool keyframe)
+{
+  Segment::segsnap_t &snap = syncSent[i];
+  uint8_t d = keyframe ? UDP_V13_FIELDS : seg.differs(snap) & UDP_V13_FIELDS;
+  seg.snapshot(snap);
+  if (!d) return 0;
+  size_t n = 0;
+  p[n++] = i;
+  p[n++] = d;
+  if (d & SEG_DIFFERS_BRI) p[n++] = seg.opacity;
+  if (d & SEG_DIFFERS_OPT) {
+    p[n++] = seg.options & 0x8E; // mirrored, on, reversed, reverse_y; never selected, freeze, reset & transitional
+    p[n++] = (seg.options >> 8) & 0xFF; //mirror_y, transpose, 2D mapping & sound
+  }
+  if (d & SEG_DIFFERS_COL) {
+    for (size_t c = 0; c < NUM_COLORS; c++) {
+      p[n++] = R(seg.colors[c]);
+      p[n++] = G(seg.colors[c]);
+      p[n++] = B(seg.colors[c]);
+      p[n++] = W(seg.colors[c]);
+    }
+    p[n++] = seg.cct;
+  }
+  if (d & SEG_DIFFERS_FX) {
+    p[n++] = seg.mode;
+    p[n++] = seg.speed;
+    p[n++] = seg.intensity;
+    p[n++] = seg.palette;
+    p[n++] = seg.custom1;
+    p[n++] = seg.custom2;
+    p[n++] = seg.custom3 | (seg.check1<<5) | (seg.check2<<6) | (seg.check3<<7);
+  }
+  if (d & SEG_DIFFERS_BOUNDS) {
+    p[n++] = seg.start >> 8;  p[n++] = seg.start & 0xFF;
+    p[n++] = seg.stop >> 8;   p[n++] = seg.stop & 0xFF;
+    p[n++] = seg.startY >> 8; p[n++] = seg.startY & 0xFF;
+    p[n++] = seg.stopY >> 8;  p[n++] = seg.stopY & 0xFF;
+  }
+  if (d & SEG_DIFFERS_GSO) {
+    p[n++] = seg.grouping;
+    p[n++] = seg.spacing;
+    p[n++] = seg.offset >> 8; p[n++] = seg.offset & 0xFF;
+  }
+  return n;
+}
+
 void notify(byte callMode, bool followUp)
 {
   if (!udpConnected) return;
@@ -26,7 +141,22 @@ void notify(byte callMode, bool followUp)
     case CALL_MODE_ALEXA:         if (!notifyAlexa)  return; break;
     default: return;
   }
-  byte udpOut[WLEDPACKETSIZE];
+  byte *udpOut = syncPacket;
+  uint32_t t = millis() + strip.timebase;
+
+  if (followUp && notifyDelta && syncPacketLen) {
+    // retransmit the same revision (receivers that got it already will drop it), only refresh timing
+    udpOut[24] = followUp;
+    udpOut[25] = (t >> 24) & 0xFF;
+    udpOut[26] = (t >> 16) & 0xFF;
+    udpOut[27] = (t >>  8) & 0xFF;
+    udpOut[28] = (t >>  0) & 0xFF;
+    sendSyncPacket();
+    notificationSentTime = millis();
+    notificationCount++;
+    return;
+  }
+
   Segment& mainseg = strip.getMainSegment();
   udpOut[0] = 0; //0: wled notifier protocol 1: WARLS protocol
   udpOut[1] = callMode;
@@ -45,8 +175,8 @@ void notify(byte callMode, bool followUp)
   //3: supports FX intensity, 24 byte packet 4: supports transitionDelay 5: sup palette
   //6: supports timebase syncing, 29 byte packet 7: supports tertiary color 8: supports sys time sync, 36 byte packet
   //9: supports sync groups, 37 byte packet 10: supports CCT, 39 byte packet 11: per segment options, variable packet length (40+MAX_NUM_SEGMENTS*3)
-  //12: enhanced effct sliders, 2D & mapping options
-  udpOut[11] = 12;
+  //12: enhanced effct sliders, 2D & mapping options 13: changed segment fields only, state revision (no per segment data for older receivers)
+  udpOut[11] = notifyDelta ? 13 : 12;
   col = mainseg.colors[1];
   udpOut[12] = R(col);
   udpOut[13] = G(col);
@@ -63,7 +193,6 @@ void notify(byte callMode, bool followUp)
   udpOut[23] = W(col);
 
   udpOut[24] = followUp;
-  uint32_t t = millis() + strip.timebase;
   udpOut[25] = (t >> 24) & 0xFF;
   udpOut[26] = (t >> 16) & 0xFF;
   udpOut[27] = (t >>  8) & 0xFF;
@@ -89,61 +218,87 @@ void notify(byte callMode, bool followUp)
   udpOut[37] = strip.hasCCTBus() ? 0 : 255; //check this is 0 for the next value to be significant
   udpOut[38] = mainseg.cct;
 
-  udpOut[39] = strip.getActiveSegmentsNum();
   udpOut[40] = UDP_SEG_SIZE; //size of each loop iteration (one segment)
   size_t s = 0, nsegs = strip.getSegmentsNum();
-  for (size_t i = 0; i < nsegs; i++) {
-    Segment &selseg = strip.getSegment(i);
-    if (!selseg.isActive()) continue;
-    uint16_t ofs = 41 + s*UDP_SEG_SIZE; //start of segment offset byte
-    udpOut[0 +ofs] = s;
-    udpOut[1 +ofs] = selseg.start >> 8;
-    udpOut[2 +ofs] = selseg.start & 0xFF;
-    udpOut[3 +ofs] = selseg.stop >> 8;
-    udpOut[4 +ofs] = selseg.stop & 0xFF;
-    udpOut[5 +ofs] = selseg.grouping;
-    udpOut[6 +ofs] = selseg.spacing;
-    udpOut[7 +ofs] = selseg.offset >> 8;
-    udpOut[8 +ofs] = selseg.offset & 0xFF;
-    udpOut[9 +ofs] = selseg.options & 0x8F; //only take into account selected, mirrored, on, reversed, reverse_y (for 2D); ignore freeze, reset, transitional
-    udpOut[10+ofs] = selseg.opacity;
-    udpOut[11+ofs] = selseg.mode;
-    udpOut[12+ofs] = selseg.speed;
-    udpOut[13+ofs] = selseg.intensity;
-    udpOut[14+ofs] = selseg.palette;
-    udpOut[15+ofs] = R(selseg.colors[0]);
-    udpOut[16+ofs] = G(selseg.colors[0]);
-    udpOut[17+ofs] = B(selseg.colors[0]);
-    udpOut[18+ofs] = W(selseg.colors[0]);
-    udpOut[19+ofs] = R(selseg.colors[1]);
-    udpOut[20+ofs] = G(selseg.colors[1]);
-    udpOut[21+ofs] = B(selseg.colors[1]);
-    udpOut[22+ofs] = W(selseg.colors[1]);
-    udpOut[23+ofs] = R(selseg.colors[2]);
-    udpOut[24+ofs] = G(selseg.colors[2]);
-    udpOut[25+ofs] = B(selseg.colors[2]);
-    udpOut[26+ofs] = W(selseg.colors[2]);
-    udpOut[27+ofs] = selseg.cct;
-    udpOut[28+ofs] = (selseg.options>>8) & 0xFF; //mirror_y, transpose, 2D mapping & sound
-    udpOut[29+ofs] = selseg.custom1;
-    udpOut[30+ofs] = selseg.custom2;
-    udpOut[31+ofs] = selseg.custom3 | (selseg.check1<<5) | (selseg.check2<<6) | (selseg.check3<<7);
-    udpOut[32+ofs] = selseg.startY >> 8;
-    udpOut[33+ofs] = selseg.startY & 0xFF;
-    udpOut[34+ofs] = selseg.stopY >> 8;
-    udpOut[35+ofs] = selseg.stopY & 0xFF;
-    ++s;
+
+  if (notifyDelta) {
+    if (!syncSession) syncSession = random16(1, 65535);
+    syncRevision++;
+    uint32_t segs = 0;
+    for (size_t i = 0; i < nsegs; i++) if (strip.getSegment(i).isActive()) segs |= 1UL << i;
+    // infrequent changes would otherwise leave a receiver that missed a delta out of sync for a long time
+    bool keyframe = (syncRevision % UDP_V13_KEYFRAME) == 1 || segs != syncSentSegs || millis() - syncLastKeyframe > UDP_V13_KEYFRAME_MS;
+    if (keyframe) syncLastKeyframe = millis();
+    syncSentSegs = segs;
+    udpOut[39] = 0; // no v12 segment data
+    udpOut[41] = syncSession >> 8;
+    udpOut[42] = syncSession & 0xFF;
+    udpOut[43] = (syncRevision >> 24) & 0xFF;
+    udpOut[44] = (syncRevision >> 16) & 0xFF;
+    udpOut[45] = (syncRevision >>  8) & 0xFF;
+    udpOut[46] = (syncRevision >>  0) & 0xFF;
+    udpOut[47] = keyframe; // bit 0: all fields of all segments included
+    size_t len = UDP_V13_HEADER;
+    for (size_t i = 0; i < nsegs; i++) {
+      Segment &selseg = strip.getSegment(i);
+      if (!selseg.isActive()) continue;
+      size_t n = writeSegmentDelta(udpOut + len, i, selseg, keyframe);
+      if (n) s++;
+      len += n;
+    }
+    udpOut[48] = s;
+    syncPacketLen = len;
+  } else {
+    udpOut[39] = strip.getActiveSegmentsNum();
+    for (size_t i = 0; i < nsegs; i++) {
+      Segment &selseg = strip.getSegment(i);
+      if (!selseg.isActive()) continue;
+      uint16_t ofs = 41 + s*UDP_SEG_SIZE; //start of segment offset byte
+      udpOut[0 +ofs] = s;
+      udpOut[1 +ofs] = selseg.start >> 8;
+      udpOut[2 +ofs] = selseg.start & 0xFF;
+      udpOut[3 +ofs] = selseg.stop >> 8;
+      udpOut[4 +ofs] = selseg.stop & 0xFF;
+      udpOut[5 +ofs] = selseg.grouping;
+      udpOut[6 +ofs] = selseg.spacing;
+      udpOut[7 +ofs] = selseg.offset >> 8;
+      udpOut[8 +ofs] = selseg.offset & 0xFF;
+      udpOut[9 +ofs] = selseg.options & 0x8F; //only take into account selected, mirrored, on, reversed, reverse_y (for 2D); ignore freeze, reset, transitional
+      udpOut[10+ofs] = selseg.opacity;
+      udpOut[11+ofs] = selseg.mode;
+      udpOut[12+ofs] = selseg.speed;
+      udpOut[13+ofs] = selseg.intensity;
+      udpOut[14+ofs] = selseg.palette;
+      udpOut[15+ofs] = R(selseg.colors[0]);
+      udpOut[16+ofs] = G(selseg.colors[0]);
+      udpOut[17+ofs] = B(selseg.colors[0]);
+      udpOut[18+ofs] = W(selseg.colors[0]);
+      udpOut[19+ofs] = R(selseg.colors[1]);
+      udpOut[20+ofs] = G(selseg.colors[1]);
+      udpOut[21+ofs] = B(selseg.colors[1]);
+      udpOut[22+ofs] = W(selseg.colors[1]);
+      udpOut[23+ofs] = R(selseg.colors[2]);
+      udpOut[24+ofs] = G(selseg.colors[2]);
+      udpOut[25+ofs] = B(selseg.colors[2]);
+      udpOut[26+ofs] = W(selseg.colors[2]);
+      udpOut[27+ofs] = selseg.cct;
+      udpOut[28+ofs] = (selseg.options>>8) & 0xFF; //mirror_y, transpose, 2D mapping & sound
+      udpOut[29+ofs] = selseg.custom1;
+      udpOut[30+ofs] = selseg.custom2;
+      udpOut[31+ofs] = selseg.custom3 | (selseg.check1<<5) | (selseg.check2<<6) | (selseg.check3<<7);
+      udpOut[32+ofs] = selseg.startY >> 8;
+      udpOut[33+ofs] = selseg.startY & 0xFF;
+      udpOut[34+ofs] = selseg.stopY >> 8;
+      udpOut[35+ofs] = selseg.stopY & 0xFF;
+      ++s;
+    }
+    syncPacketLen = WLEDPACKETSIZE;
   }
 
   //uint16_t offs = SEG_OFFSET;
   //next value to be added has index: udpOut[offs + 0]
 
-  IPAddress broadcastIp;
-  broadcastIp = ~uint32_t(Network.subnetMask()) | uint32_t(Network.gatewayIP());
-
-  notifierUdp.beginPacket(broadcastIp, udpPort);
-  notifierUdp.write(udpOut, WLEDPACKETSIZE);
-  notifierUdp.endPacket();
+  sendSyncPacket();
   notificationSentCallMode = callMode;
   notificationSentTime = millis();
   notificationCount = followUp ? notificationCount + 1 : 0;
@@ -164,6 +319,7 @@ void realtimeLock(uint32_t timeoutMs, byte md)
     }
     // clear strip/segment
     for (size_t i = start; i < stop; i++) strip.setPixelColor(i,BLACK);
+    resetJitterBuffer();
     // if WLED was off and using main segment only, freeze non-main segments so they stay off
     if (useMainSegmentOnly && bri == 0) {
       for (size_t s=0; s < strip.getSegmentsNum(); s++) {
@@ -188,6 +344,7 @@ void realtimeLock(uint32_t timeoutMs, byte md)
 
 void exitRealtime() {
   if (!realtimeMode) return;
+  resetJitterBuffer(true);
   if (realtimeOverride == REALTIME_OVERRIDE_ONCE) realtimeOverride = REALTIME_OVERRIDE_NONE;
   strip.setBrightness(scaledBri(bri), true);
   realtimeTimeout = 0; // cancel realtime mode immediately
@@ -210,101 +367,139 @@ void sendTPM2Ack() {
 }
 
 
-void handleNotifications()
+// v13 notifications carry a per boot session and a revision, so retransmissions and
+// packets arriving out of order are dropped instead of being applied again
+static bool isNewSyncRevision(uint32_t ip, const byte *udpIn)
 {
-  IPAddress localIP;
-
-  //send second notification if enabled
-  if(udpConnected && (notificationCount < udpNumRetries) && ((millis()-notificationSentTime) > 250)){
-    notify(notificationSentCallMode,true);
+  uint16_t session  = (udpIn[41] << 8) | udpIn[42];
+  uint32_t revision = (udpIn[43] << 24) | (udpIn[44] << 16) | (udpIn[45] << 8) | udpIn[46];
+  syncSender *s = nullptr;
+  for (size_t i = 0; i < UDP_V13_SENDERS; i++) if (syncSenders[i].ip == ip) s = &syncSenders[i];
+  if (!s) {
+    s = &syncSenders[syncSenderNext];
+    syncSenderNext = (syncSenderNext + 1) % UDP_V13_SENDERS;
+    s->ip = ip;
+  } else if (s->session == session && int32_t(revision - s->revision) <= 0) {
+    DEBUG_PRINTF("UDP sync: dropped revision %u (have %u)\n", revision, s->revision);
+    return false;
   }
+  s->session  = session;
+  s->revision = revision;
+  return true;
+}
 
-  if (e131NewData && millis() - strip.getLastShow() > 15)
-  {
-    e131NewData = false;
-    strip.show();
-  }
-
-  //unlock strip when realtime UDP times out
-  if (realtimeMode && millis() > realtimeTimeout) exitRealtime();
-
-  //receive UDP notifications
-  if (!udpConnected) return;
-
-  bool isSupp = false;
-  size_t packetSize = notifierUdp.parsePacket();
-  if (!packetSize && udp2Connected) {
-    packetSize = notifier2Udp.parsePacket();
-    isSupp = true;
-  }
-
-  //hyperion / raw RGB
-  if (!packetSize && udpRgbConnected) {
-    packetSize = rgbUdp.parsePacket();
-    if (packetSize) {
-      if (!receiveDirect) return;
-      if (packetSize > UDP_IN_MAXSIZE || packetSize < 3) return;
-      realtimeIP = rgbUdp.remoteIP();
-      DEBUG_PRINTLN(rgbUdp.remoteIP());
-      uint8_t lbuf[packetSize];
-      rgbUdp.read(lbuf, packetSize);
-      realtimeLock(realtimeTimeoutMs, REALTIME_MODE_HYPERION);
-      if (realtimeOverride && !(realtimeMode && useMainSegmentOnly)) return;
-      uint16_t id = 0;
-      uint16_t totalLen = strip.getLengthTotal();
-      for (size_t i = 0; i < packetSize -2; i += 3)
-      {
-        setRealtimePixel(id, lbuf[i], lbuf[i+1], lbuf[i+2], 0);
-        id++; if (id >= totalLen) break;
+// apply v13 segment records, only fields present in a record are touched
+static void applySegmentDeltas(const byte *udpIn, size_t len, bool applyEffects, bool applyColors)
+{
+  size_t ofs = UDP_V13_HEADER;
+  for (size_t r = 0; r < udpIn[48]; r++) {
+    if (ofs + 2 > len) return;
+    uint8_t id = udpIn[ofs];
+    uint8_t d  = udpIn[ofs+1];
+    size_t  recLen = 2;
+    if (d & SEG_DIFFERS_BRI)    recLen += 1;
+    if (d & SEG_DIFFERS_OPT)    recLen += 2;
+    if (d & SEG_DIFFERS_COL)    recLen += 4*NUM_COLORS + 1;
+    if (d & SEG_DIFFERS_FX)     recLen += 7;
+    if (d & SEG_DIFFERS_BOUNDS) recLen += 8;
+    if (d & SEG_DIFFERS_GSO)    recLen += 4;
+    if (ofs + recLen > len) return; // truncated packet
+    const byte *p = udpIn + ofs + 2;
+    ofs += recLen;
+
+    if (id >= strip.getSegmentsNum()) continue;
+    Segment& selseg = strip.getSegment(id);
+    if (!selseg.isActive() || !selseg.isSelected()) continue; //do not apply to non selected segments
+
+    if (d & SEG_DIFFERS_BRI) {
+      if (receiveSegmentOptions) selseg.setOpacity(p[0]);
+      p += 1;
+    }
+    if (d & SEG_DIFFERS_OPT) {
+      // when applying synced options ignore selected as it may be used as indicator of which segments to sync
+      if (receiveSegmentOptions) selseg.options = (selseg.options & 0x0071U) | (p[1]<<8) | (p[0] & 0x8E);
+      p += 2;
+    }
+    if (d & SEG_DIFFERS_COL) {
+      if (receiveSegmentOptions && applyColors) {
+        for (size_t c = 0; c < NUM_COLORS; c++) selseg.setColor(c, RGBW32(p[4*c],p[4*c+1],p[4*c+2],p[4*c+3]));
+        selseg.setCCT(p[4*NUM_COLORS]);
       }
-      if (!(realtimeMode && useMainSegmentOnly)) strip.show();
-      return;
+      p += 4*NUM_COLORS + 1;
+    }
+    if (d & SEG_DIFFERS_FX) {
+      if (receiveSegmentOptions && applyEffects) {
+        strip.setMode(id, p[0]);
+        selseg.speed     = p[1];
+        selseg.intensity = p[2];
+        selseg.setPalette(p[3]);
+        selseg.custom1   = p[4];
+        selseg.custom2   = p[5];
+        selseg.custom3   = p[6] & 0x1F;
+        selseg.check1    = (p[6]>>5) & 0x1;
+        selseg.check2    = (p[6]>>6) & 0x1;
+        selseg.check3    = (p[6]>>7) & 0x1;
+      }
+      p += 7;
+    }
+    uint16_t start  = selseg.start,  stop  = selseg.stop;
+    uint16_t startY = selseg.startY, stopY = selseg.stopY;
+    uint16_t offset = selseg.offset;
+    uint8_t  grp    = selseg.grouping, spc = selseg.spacing;
+    if (d & SEG_DIFFERS_BOUNDS) {
+      if (receiveSegmentBounds) {
+        start  = (p[0] << 8) | p[1];
+        stop   = (p[2] << 8) | p[3];
+        startY = (p[4] << 8) | p[5];
+        stopY  = (p[6] << 8) | p[7];
+      }
+      p += 8;
+    }
+    if (d & SEG_DIFFERS_GSO) {
+      if (receiveSegmentOptions) { grp = p[0]; spc = p[1]; }
+      if (receiveSegmentBounds) offset = (p[2] << 8) | p[3];
+      p += 4;
     }
+    if (d & (SEG_DIFFERS_BOUNDS | SEG_DIFFERS_GSO)) selseg.setUp(start, stop, grp, spc, offset, startY, stopY); // no-op if nothing changed
   }
+}
 
+// handles one datagram received on the notifier (isSupp: node info) port
+static void handleUdpPacket(uint8_t *udpIn, size_t len, IPAddress remote, bool isSupp)
+{
   if (!(receiveNotifications || receiveDirect)) return;
 
-  localIP = Network.localIP();
-  //notifier and UDP realtime
-  if (!packetSize || packetSize > UDP_IN_MAXSIZE) return;
-  if (!isSupp && notifierUdp.remoteIP() == localIP) return; //don't process broadcasts we send ourselves
-
-  uint8_t udpIn[packetSize +1];
-  uint16_t len;
-  if (isSupp) len = notifier2Udp.read(udpIn, packetSize);
-  else        len =  notifierUdp.read(udpIn, packetSize);
+  IPAddress localIP = Network.localIP();
+  if (!isSupp && remote == localIP) return; //don't process broadcasts we send ourselves
 
   // WLED nodes info notifications
   if (isSupp && udpIn[0] == 255 && udpIn[1] == 1 && len >= 40) {
-    if (!nodeListEnabled || notifier2Udp.remoteIP() == localIP) return;
-
-    uint8_t unit = udpIn[39];
-    NodesMap::iterator it = Nodes.find(unit);
-    if (it == Nodes.end() && Nodes.size() < WLED_MAX_NODES) { // Create a new element when not present
-      Nodes[unit].age = 0;
-      it = Nodes.find(unit);
-    }
-
-    if (it != Nodes.end()) {
-      for (size_t x = 0; x < 4; x++) {
-        it->second.ip[x] = udpIn[x + 2];
-      }
-      it->second.age = 0; // reset 'age counter'
-      char tmpNodeName[33] = { 0 };
-      memcpy(&tmpNodeName[0], reinterpret_cast<byte *>(&udpIn[6]), 32);
-      tmpNodeName[32]     = 0;
-      it->second.nodeName = tmpNodeName;
-      it->second.nodeName.trim();
-      it->second.nodeType = udpIn[38];
+    if (!nodeListEnabled || remote == localIP) return;
+
+    NodeStruct *node = Nodes.add(IPAddress(udpIn[2], udpIn[3], udpIn[4], udpIn[5]));
+    if (node) {
+      node->lastSeen = millis(); // reset 'age'
+      // copy trimmed name
+      const char *name = reinterpret_cast<const char *>(&udpIn[6]);
+      size_t nameLen = strnlen(name, NODE_NAME_LEN);
+      while (nameLen && isspace(name[nameLen-1])) nameLen--;
+      while (nameLen && isspace(*name)) { name++; nameLen--; }
+      memcpy(node->nodeName, name, nameLen);
+      node->nodeName[nameLen] = 0;
+      node->nodeType = udpIn[38];
       uint32_t build = 0;
       if (len >= 44)
         for (size_t i=0; i<sizeof(uint32_t); i++)
           build |= udpIn[40+i]<<(8*i);
-      it->second.build = build;
+      node->build = build;
+      node->flags = len >= 45 ? udpIn[44] : 0;
     }
     return;
   }
 
+  // effect clock synchronisation requests & replies
+  if (isSupp && remote != localIP && handleTimeSyncPacket(udpIn, len, remote)) return;
+
   //wled notifier, ignore if realtime packets active
   if (udpIn[0] == 0 && !realtimeMode && receiveNotifications)
   {
@@ -321,6 +516,11 @@ void handleNotifications()
       if (!(receiveGroups & 0x01)) return;
     } else if (!(receiveGroups & udpIn[36])) return;
 
+    if (version == 13) {
+      if (len < UDP_V13_HEADER) return;
+      if (!isNewSyncRevision(remote, udpIn)) return;
+    }
+
     bool someSel = (receiveNotificationBrightness || receiveNotificationColor || receiveNotificationEffects);
 
     //apply colors from notification to main segment, only if not syncing full segments
@@ -348,7 +548,10 @@ void handleNotifications()
     if (version < 200)
     {
       if (applyEffects && currentPlaylist >= 0) unloadPlaylist();
-      if (version > 10 && (receiveSegmentOptions || receiveSegmentBounds)) {
+      if (version == 13 && (receiveSegmentOptions || receiveSegmentBounds)) {
+        applySegmentDeltas(udpIn, len, applyEffects, receiveNotificationColor || !someSel);
+        stateChanged = true;
+      } else if (version > 10 && (receiveSegmentOptions || receiveSegmentBounds)) {
         uint8_t numSrcSegs = udpIn[39];
         for (size_t i = 0; i < numSrcSegs; i++) {
           uint16_t ofs = 41 + i*udpIn[40]; //start of segment offset byte
@@ -417,7 +620,7 @@ void handleNotifications()
         stateChanged = true;
       }
 
-      if (applyEffects && version > 5) {
+      if (applyEffects && version > 5 && !timeSyncFollowing()) { // time sync keeps the timebase aligned more precisely
         uint32_t t = (udpIn[25] << 24) | (udpIn[26] << 16) | (udpIn[27] << 8) | (udpIn[28]);
         t += PRESUMED_NETWORK_DELAY; //adjust trivially for network delay
         t -= millis();
@@ -476,7 +679,7 @@ void handleNotifications()
     }
     if (tpmType != 0xda) return; //return if notTPM2.NET data
 
-    realtimeIP = (isSupp) ? notifier2Udp.remoteIP() : notifierUdp.remoteIP();
+    realtimeIP = remote;
     realtimeLock(realtimeTimeoutMs, REALTIME_MODE_TPM2NET);
     if (realtimeOverride && !(realtimeMode && useMainSegmentOnly)) return;
 
@@ -499,7 +702,7 @@ void handleNotifications()
     if (tpmPacketCount == numPackets) //reset packet count and show if all packets were received
     {
       tpmPacketCount = 0;
-      strip.show();
+      realtimeShow();
     }
     return;
   }
@@ -507,9 +710,9 @@ void handleNotifications()
   //UDP realtime: 1 warls 2 drgb 3 drgbw
   if (udpIn[0] > 0 && udpIn[0] < 5)
   {
-    realtimeIP = (isSupp) ? notifier2Udp.remoteIP() : notifierUdp.remoteIP();
+    realtimeIP = remote;
     DEBUG_PRINTLN(realtimeIP);
-    if (packetSize < 2) return;
+    if (len < 2) return;
 
     if (udpIn[1] == 0)
     {
@@ -523,14 +726,14 @@ void handleNotifications()
     uint16_t totalLen = strip.getLengthTotal();
     if (udpIn[0] == 1) //warls
     {
-      for (size_t i = 2; i < packetSize -3; i += 4)
+      for (size_t i = 2; i < len -3; i += 4)
       {
         setRealtimePixel(udpIn[i], udpIn[i+1], udpIn[i+2], udpIn[i+3], 0);
       }
     } else if (udpIn[0] == 2) //drgb
     {
       uint16_t id = 0;
-      for (size_t i = 2; i < packetSize -2; i += 3)
+      for (size_t i = 2; i < len -2; i += 3)
       {
         setRealtimePixel(id, udpIn[i], udpIn[i+1], udpIn[i+2], 0);
 
@@ -539,7 +742,7 @@ void handleNotifications()
     } else if (udpIn[0] == 3) //drgbw
     {
       uint16_t id = 0;
-      for (size_t i = 2; i < packetSize -3; i += 4)
+      for (size_t i = 2; i < len -3; i += 4)
       {
         setRealtimePixel(id, udpIn[i], udpIn[i+1], udpIn[i+2], udpIn[i+3]);
 
@@ -548,7 +751,7 @@ void handleNotifications()
     } else if (udpIn[0] == 4) //dnrgb
     {
       uint16_t id = ((udpIn[3] << 0) & 0xFF) + ((udpIn[2] << 8) & 0xFF00);
-      for (size_t i = 4; i < packetSize -2; i += 3)
+      for (size_t i = 4; i < len -2; i += 3)
       {
         if (id >= totalLen) break;
         setRealtimePixel(id, udpIn[i], udpIn[i+1], udpIn[i+2], 0);
@@ -557,20 +760,35 @@ void handleNotifications()
     } else if (udpIn[0] == 5) //dnrgbw
     {
       uint16_t id = ((udpIn[3] << 0) & 0xFF) + ((udpIn[2] << 8) & 0xFF00);
-      for (size_t i = 4; i < packetSize -2; i += 4)
+      for (size_t i = 4; i < len -2; i += 4)
       {
         if (id >= totalLen) break;
         setRealtimePixel(id, udpIn[i], udpIn[i+1], udpIn[i+2], udpIn[i+3]);
         id++;
       }
     }
-    strip.show();
+    realtimeShow();
+    return;
+  }
+
+  // binary control API over UDP
+  if (udpIn[0] == BINAPI_MAGIC) {
+    uint8_t ack[BINAPI_ACK_LEN];
+    if (handleBinaryControl(udpIn, len, ack)) {
+      notifierUdp.beginPacket(remote, notifierUdp.remotePort());
+      notifierUdp.write(ack, sizeof(ack));
+      notifierUdp.endPacket();
+    }
     return;
   }
 
   // API over UDP
-  udpIn[packetSize] = '\0';
+  udpIn[len] = '\0';
 
+  if (udpIn[0] == '{' && (jsonBufferLock || jsonQueuePending(JSONQ_UDP))) {
+    queueJsonState((const char*)udpIn, len, JSONQ_UDP); // applied from the main loop once the buffer is free
+    return;
+  }
   if (requestJSONBufferLock(18)) {
     if (udpIn[0] >= 'A' && udpIn[0] <= 'Z') { //HTTP API
       String apireq = "win"; apireq += '&'; // reduce flash string usage
@@ -586,6 +804,105 @@ void handleNotifications()
 }
 
 
+// hyperion / raw RGB
+static void handleHyperionPacket(const uint8_t *lbuf, size_t len, IPAddress remote)
+{
+  if (!receiveDirect) return;
+  if (len < 3) return;
+  realtimeIP = remote;
+  DEBUG_PRINTLN(realtimeIP);
+  realtimeLock(realtimeTimeoutMs, REALTIME_MODE_HYPERION);
+  if (realtimeOverride && !(realtimeMode && useMainSegmentOnly)) return;
+  uint16_t id = 0;
+  uint16_t totalLen = strip.getLengthTotal();
+  for (size_t i = 0; i < len -2; i += 3)
+  {
+    setRealtimePixel(id, lbuf[i], lbuf[i+1], lbuf[i+2], 0);
+    id++; if (id >= totalLen) break;
+  }
+  if (!(realtimeMode && useMainSegmentOnly)) realtimeShow();
+}
+
+// reads and handles the next datagram of a source, returns false if none was pending
+// complete realtime frames followed by a newer frame of the same kind are dropped unseen
+static bool receiveUdp(WiFiUDP &udp, uint8_t src)
+{
+  size_t size = udpRxPending[src] ? udpRxPending[src] : udp.parsePacket();
+  udpRxPending[src] = 0;
+  if (!size) return false;
+  for (;;) {
+    udpRxStats.rx[src]++;
+    udpRxStats.depth++;
+    if (size > UDP_IN_MAXSIZE) { // next parsePacket() skips it
+      udpRxStats.drop[src]++;
+      return true;
+    }
+    IPAddress remote = udp.remoteIP();
+    int len = udp.read(udpRxBuf, size);
+    if (len <= 0) return true;
+    // hyperion packets are always whole frames, notifier port only carries them as DRGB & DRGBW
+    bool fullFrame = src == UDP_RX_RGB || (src == UDP_RX_NOTIFIER && receiveDirect && (udpRxBuf[0] == 2 || udpRxBuf[0] == 3));
+    if (fullFrame) {
+      size_t next = udp.parsePacket();
+      if (next && udpRxStats.depth < UDP_RX_BATCH && (src == UDP_RX_RGB || (udp.peek() == udpRxBuf[0] && udp.remoteIP() == remote))) {
+        udpRxStats.drop[src]++; // superseded
+        size = next;
+        continue;
+      }
+      udpRxPending[src] = next; // handled on the next call
+    }
+    if (src == UDP_RX_RGB) handleHyperionPacket(udpRxBuf, len, remote);
+    else                   handleUdpPacket(udpRxBuf, len, remote, src == UDP_RX_INFO);
+    return true;
+  }
+}
+
+void handleNotifications()
+{
+  //send second notification if enabled
+  if(udpConnected && (notificationCount < udpNumRetries) && ((millis()-notificationSentTime) > 250)){
+    notify(notificationSentCallMode,true);
+  }
+
+  handleE131Frames(); // staged frames are shown as soon as they are complete
+  if (e131NewData && (jitterBufferActive() || millis() - strip.getLastShow() > 15))
+  {
+    e131NewData = false;
+    realtimeShow();
+  }
+
+  //unlock strip when realtime UDP times out
+  if (realtimeMode && millis() > realtimeTimeout) exitRealtime();
+
+  //receive UDP notifications
+  if (!udpConnected) return;
+
+  // drain pending datagrams within a time budget: realtime first, node info & time sync last
+  // (info port gets at least one datagram per call so it can't starve)
+  uint32_t start = micros();
+  udpRxStats.depth = 0;
+  if (udpRgbConnected) receiveUdp(rgbUdp, UDP_RX_RGB);
+  while (udpRxStats.depth < UDP_RX_BATCH && micros() - start < UDP_RX_BUDGET_US && receiveUdp(notifierUdp, UDP_RX_NOTIFIER));
+  if (udp2Connected && receiveUdp(notifier2Udp, UDP_RX_INFO))
+    while (udpRxStats.depth < UDP_RX_BATCH && micros() - start < UDP_RX_BUDGET_US && receiveUdp(notifier2Udp, UDP_RX_INFO));
+  if (udpRxStats.depth > udpRxStats.peak) udpRxStats.peak = udpRxStats.depth;
+}
+
+
+// receive queue statistics for /json/info (peak depth is reset on each report)
+void serializeUdpStats(JsonObject root)
+{
+  JsonObject udp = root.createNestedObject(F("udp"));
+  udp[F("q")] = udpRxStats.peak;
+  udpRxStats.peak = 0;
+  JsonArray rx   = udp.createNestedArray(F("rx"));   // hyperion, notifier, node info
+  JsonArray drop = udp.createNestedArray(F("drop"));
+  for (size_t i = 0; i < UDP_RX_SOURCES; i++) {
+    rx.add(udpRxStats.rx[i]);
+    drop.add(udpRxStats.drop[i]);
+  }
+}
+
 void setRealtimePixel(uint16_t i, byte r, byte g, byte b, byte w)
 {
   uint16_t pix = i + arlsOffset;
@@ -599,32 +916,141 @@ void setRealtimePixel(uint16_t i, byte r, byte g, byte b, byte w)
     if (useMainSegmentOnly) {
       Segment &seg = strip.getMainSegment();
       if (pix<seg.length()) seg.setPixelColor(pix, r, g, b, w);
-    } else {
+    } else if (!jitterCapture(pix, RGBW32(r, g, b, w))) {
       strip.setPixelColor(pix, r, g, b, w);
     }
   }
 }
 
 /*********************************************************************************************\
-   Refresh aging for remote units, drop if too old...
+   Node table (see NodeStruct.h)
 \*********************************************************************************************/
-void refreshNodeList()
+WLED_ASYNC_MUX(nodeMux); // guards reallocation and entry moves against get() from async handlers
+
+static NodeStruct* allocNodes(uint16_t slots)
 {
-  for (NodesMap::iterator it = Nodes.begin(); it != Nodes.end();) {
-    bool mustRemove = true;
-
-    if (it->second.ip[0] != 0) {
-      if (it->second.age < 10) {
-        it->second.age++;
-        mustRemove = false;
-        ++it;
-      }
-    }
+  #if defined(ARDUINO_ARCH_ESP32) && defined(BOARD_HAS_PSRAM) && defined(WLED_USE_PSRAM)
+  if (psramFound()) return (NodeStruct*) ps_calloc(slots, sizeof(NodeStruct));
+  #endif
+  return (NodeStruct*) calloc(slots, sizeof(NodeStruct));
+}
 
-    if (mustRemove) {
-      it = Nodes.erase(it);
-    }
+NodeStruct* NodeTable::find(IPAddress ip)
+{
+  uint32_t key = uint32_t(ip);
+  if (!_nodes || !key) return nullptr;
+  for (uint16_t i = home(key, _slots), n = 0; n < _slots; n++) {
+    if (_nodes[i].ip == key) return &_nodes[i];
+    if (!_nodes[i].ip) break;
+    if (++i >= _slots) i = 0;
   }
+  return nullptr;
+}
+
+// doubles the number of slots (up to WLED_NODE_SLOTS) and rehashes all entries
+bool NodeTable::grow()
+{
+  uint16_t slots = _slots ? min(2 * _slots, WLED_NODE_SLOTS) : min(WLED_NODE_SLOTS_MIN, WLED_NODE_SLOTS);
+  if (slots <= _slots) return false;
+  NodeStruct *nodes = allocNodes(slots);
+  if (!nodes) { DEBUG_PRINTLN(F("Node table allocation failed!")); return false; }
+  for (uint16_t i = 0; i < _slots; i++) {
+    if (!_nodes[i].ip) continue;
+    uint16_t j = home(_nodes[i].ip, slots);
+    while (nodes[j].ip) if (++j >= slots) j = 0;
+    nodes[j] = _nodes[i];
+  }
+  NodeStruct *old = _nodes;
+  WLED_ASYNC_LOCK(nodeMux);
+  _nodes = nodes;
+  _slots = slots;
+  WLED_ASYNC_UNLOCK(nodeMux);
+  _cursor = 0;
+  free(old);
+  return true;
+}
+
+NodeStruct* NodeTable::add(IPAddress ip)
+{
+  uint32_t key = uint32_t(ip);
+  if (!key) return nullptr;
+  NodeStruct *node = find(ip);
+  if (node) return node;
+  if (_count >= WLED_MAX_NODES) return nullptr; // full
+  if ((_count + 1) * 5 > _slots * 4) grow();   // keep load below 80%, continue fuller if that fails
+  if (_count >= _slots) return nullptr;
+  uint16_t i = home(key, _slots);
+  while (_nodes[i].ip) if (++i >= _slots) i = 0;
+  memset(&_nodes[i], 0, sizeof(NodeStruct));
+  _nodes[i].ip = key;
+  _nodes[i].lastSeen = millis();
+  _count++;
+  return &_nodes[i];
+}
+
+// backward shift deletion: move entries up whose probe sequence passes the freed slot
+void NodeTable::removeSlot(uint16_t i)
+{
+  WLED_ASYNC_LOCK(nodeMux);
+  uint16_t j = i;
+  for (;;) {
+    if (++j >= _slots) j = 0;
+    if (!_nodes[j].ip) break;
+    uint16_t k = home(_nodes[j].ip, _slots);
+    // entry j stays if its home slot lies cyclically within (i, j]
+    if (i <= j ? (i < k && k <= j) : (i < k || k <= j)) continue;
+    _nodes[i] = _nodes[j];
+    i = j;
+  }
+  memset(&_nodes[i], 0, sizeof(NodeStruct));
+  WLED_ASYNC_UNLOCK(nodeMux);
+  _count--;
+}
+
+void NodeTable::clear()
+{
+  NodeStruct *old = _nodes;
+  WLED_ASYNC_LOCK(nodeMux);
+  _nodes = nullptr;
+  _slots = 0;
+  WLED_ASYNC_UNLOCK(nodeMux);
+  free(old);
+  _count = 0;
+  _cursor = 0;
+}
+
+bool NodeTable::get(uint16_t i, NodeStruct &node)
+{
+  bool found = false;
+  WLED_ASYNC_LOCK(nodeMux);
+  if (_nodes && i < _slots && _nodes[i].ip) {
+    node = _nodes[i];
+    found = true;
+  }
+  WLED_ASYNC_UNLOCK(nodeMux);
+  return found;
+}
+
+void NodeTable::refresh(uint16_t slots)
+{
+  if (!_nodes || !_count) return;
+  uint32_t now = millis();
+  while (slots--) {
+    if (_cursor >= _slots) _cursor = 0;
+    NodeStruct &n = _nodes[_cursor];
+    // a removal may shift the next entry into this slot, check it again on the next step
+    if (n.ip && now - n.lastSeen >= NODE_EXPIRE * NODE_AGE_TICK) removeSlot(_cursor);
+    else _cursor++;
+  }
+}
+
+/*********************************************************************************************\
+   Refresh aging for remote units, drop if too old...
+\*********************************************************************************************/
+void refreshNodeList()
+{
+  if (!nodeListEnabled && Nodes.slots()) Nodes.clear(); // the table is only modified from the main loop
+  Nodes.refresh(NODE_REFRESH_SLOTS);
 }
 
 /*********************************************************************************************\
@@ -645,10 +1071,11 @@ void sendSysInfoUDP()
   // 38: 1 byte node type id
   // 39: 1 byte node id
   // 40: 4 byte version ID
-  // 44 bytes total
+  // 44: 1 byte flags (NODE_FLAG_*)
+  // 45 bytes total
 
   // send my info to the world...
-  uint8_t data[44] = {0};
+  uint8_t data[45] = {0};
   data[0] = 255;
   data[1] = 1;
 
@@ -675,6 +1102,7 @@ void sendSysInfoUDP()
   uint32_t build = VERSION;
   for (size_t i=0; i<sizeof(uint32_t); i++)
     data[40+i] = (build>>(8*i)) & 0xFF;
+  if (timeSyncEnabled) data[44] |= NODE_FLAG_TIMESYNC;
 
   IPAddress broadcastIP(255, 255, 255, 255);
   notifier2Udp.beginPacket(broadcastIP, udpPort2);
@@ -705,81 +1133,139 @@ void sendSysInfoUDP()
 // 1440 channels per packet
 #define DDP_CHANNELS_PER_PACKET 1440 // 480 leds
 
-//
-// Send real time UDP updates to the specified client
-//
-// type   - protocol type (0=DDP, 1=E1.31, 2=ArtNet)
-// client - the IP address to send to
-// length - the number of pixels
-// buffer - a buffer of at least length*4 bytes long
-// isRGBW - true if the buffer contains 4 components per pixel
+#define E131_HEADER_LEN 126
+#define E131_SYNC_PACKET_LEN 49
+#define ART_NET_DMX_HEADER_LEN 18
+#define ART_NET_SYNC_LEN 14
+
+// large enough for the biggest packet of any protocol (DDP: 10+1440, E1.31: 126+512, Art-Net: 18+512)
+#define NET_OUT_BUFFER_SIZE (DDP_HEADER_LEN + DDP_CHANNELS_PER_PACKET)
 
 static       size_t sequenceNumber = 0; // this needs to be shared across all outputs
+static       uint8_t e131Sequence = 0;
 static const size_t ART_NET_HEADER_SIZE = 12;
 static const byte   ART_NET_HEADER[] PROGMEM = {0x41,0x72,0x74,0x2d,0x4e,0x65,0x74,0x00,0x00,0x50,0x00,0x0e};
+static const byte   ART_NET_SYNC[]   PROGMEM = {0x41,0x72,0x74,0x2d,0x4e,0x65,0x74,0x00,0x00,0x52,0x00,0x0e,0x00,0x00};
+static const byte   E131_ACN_ID[]    PROGMEM = {0x00,0x10,0x00,0x00,0x41,0x53,0x43,0x2d,0x45,0x31,0x2e,0x31,0x37,0x00,0x00,0x00}; // preamble, postamble, "ASC-E1.17"
+
+static WiFiUDP netOutUdp;                      // persistent socket shared by all network busses
+static byte    netOutBuffer[NET_OUT_BUFFER_SIZE]; // packet assembly buffer
+
+// copies channel data into the packet buffer, applying brightness in a single pass
+static void fillChannels(byte *dst, const byte *src, size_t len, uint8_t bri)
+{
+  if (bri == 255) {
+    memcpy(dst, src, len);
+    return;
+  }
+  for (size_t i = 0; i < len; i++) dst[i] = scale8(src[i], bri);
+}
+
+// channel data for DMX based protocols; channels before startChannel in the first universe are sent as 0
+static size_t fillDmxChannels(byte *dst, const byte *src, size_t srcLen, size_t &srcPos, size_t dmxStart, size_t dmxLen, uint8_t bri)
+{
+  memset(dst, 0, dmxStart);
+  size_t n = min(dmxLen - dmxStart, srcLen - srcPos);
+  fillChannels(dst + dmxStart, src + srcPos, n, bri);
+  srcPos += n;
+  return dmxStart + n;
+}
+
+static void writeE131Header(byte *p, uint16_t universe, size_t channels, uint16_t syncUniverse)
+{
+  memcpy_P(p, E131_ACN_ID, sizeof(E131_ACN_ID));
+  // root layer
+  uint16_t len = E131_HEADER_LEN - 16 + channels;
+  p[16] = 0x70 | (len >> 8); p[17] = len;
+  p[18] = 0; p[19] = 0; p[20] = 0; p[21] = 0x04;               // VECTOR_ROOT_E131_DATA
+  memcpy(p + 22, "WLED", 4);                                    // CID, stable per device
+  memcpy(p + 26, escapedMac.c_str(), min((size_t)12, escapedMac.length()));
+  // framing layer
+  len = E131_HEADER_LEN - 38 + channels;
+  p[38] = 0x70 | (len >> 8); p[39] = len;
+  p[40] = 0; p[41] = 0; p[42] = 0; p[43] = 0x02;               // VECTOR_E131_DATA_PACKET
+  memset(p + 44, 0, 64);
+  strlcpy((char*)p + 44, serverDescription, 64);                // source name
+  p[108] = 100;                                                 // priority
+  p[109] = syncUniverse >> 8; p[110] = syncUniverse;
+  p[111] = e131Sequence;
+  p[112] = 0;                                                   // options
+  p[113] = universe >> 8; p[114] = universe;
+  // DMP layer
+  len = E131_HEADER_LEN - 115 + channels;
+  p[115] = 0x70 | (len >> 8); p[116] = len;
+  p[117] = 0x02;                                                // VECTOR_DMP_SET_PROPERTY
+  p[118] = 0xa1;                                                // address & data type
+  p[119] = 0; p[120] = 0;                                       // first property address
+  p[121] = 0; p[122] = 1;                                       // address increment
+  p[123] = (channels + 1) >> 8; p[124] = channels + 1;          // property value count (incl. start code)
+  p[125] = 0;                                                   // DMX start code
+}
 
-uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, uint8_t *buffer, uint8_t bri, bool isRGBW)  {
+//
+// Send real time UDP updates to the specified client
+//
+// type         - protocol type (0=DDP, 1=E1.31, 2=ArtNet)
+// client       - the IP address to send to
+// length       - the number of pixels
+// buffer       - a buffer of at least length*4 bytes long
+// isRGBW       - true if the buffer contains 4 components per pixel
+// universe     - first E1.31/Art-Net universe (0 = protocol default)
+// startChannel - 0-based DDP data offset or DMX channel offset within the first universe
+// deferLatch   - data is latched by realtimeBroadcastSync() (no DDP push flag, E1.31 sync address set)
+
+uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, uint8_t *buffer, uint8_t bri, bool isRGBW, uint16_t universe, uint16_t startChannel, bool deferLatch)  {
   if (!(apActive || interfacesInited) || !client[0] || !length) return 1;  // network not initialised or dummy/unset IP address  031522 ajn added check for ap
 
-  WiFiUDP ddpUdp;
+  const size_t channelCount = length * (isRGBW? 4:3); // 1 channel for every R,G,B,(W?) value
 
   switch (type) {
     case 0: // DDP
     {
       // calculate the number of UDP packets we need to send
-      size_t channelCount = length * (isRGBW? 4:3); // 1 channel for every R,G,B value
       size_t packetCount = ((channelCount-1) / DDP_CHANNELS_PER_PACKET) +1;
 
-      // there are 3 channels per RGB pixel
-      uint32_t channel = 0; // TODO: allow specifying the start channel
+      uint32_t channel = startChannel;
       // the current position in the buffer
       size_t bufferOffset = 0;
 
       for (size_t currentPacket = 0; currentPacket < packetCount; currentPacket++) {
         if (sequenceNumber > 15) sequenceNumber = 0;
 
-        if (!ddpUdp.beginPacket(client, DDP_DEFAULT_PORT)) {  // port defined in ESPAsyncE131.h
-          DEBUG_PRINTLN(F("WiFiUDP.beginPacket returned an error"));
-          return 1; // problem
-        }
-
         // the amount of data is AFTER the header in the current packet
         size_t packetSize = DDP_CHANNELS_PER_PACKET;
 
         uint8_t flags = DDP_FLAGS1_VER1;
         if (currentPacket == (packetCount - 1U)) {
-          // last packet, set the push flag
-          // TODO: determine if we want to send an empty push packet to each destination after sending the pixel data
-          flags = DDP_FLAGS1_VER1 | DDP_FLAGS1_PUSH;
+          // last packet, set the push flag unless a separate push (sync) packet is sent for all outputs
+          if (!deferLatch) flags = DDP_FLAGS1_VER1 | DDP_FLAGS1_PUSH;
           if (channelCount % DDP_CHANNELS_PER_PACKET) {
             packetSize = channelCount % DDP_CHANNELS_PER_PACKET;
           }
         }
 
-        // write the header
-        /*0*/ddpUdp.write(flags);
-        /*1*/ddpUdp.write(sequenceNumber++ & 0x0F); // sequence may be unnecessary unless we are sending twice (as requested in Sync settings)
-        /*2*/ddpUdp.write(isRGBW ?  DDP_TYPE_RGBW32 : DDP_TYPE_RGB24);
-        /*3*/ddpUdp.write(DDP_ID_DISPLAY);
+        byte *p = netOutBuffer;
+        /*0*/p[0] = flags;
+        /*1*/p[1] = sequenceNumber++ & 0x0F; // sequence may be unnecessary unless we are sending twice (as requested in Sync settings)
+        /*2*/p[2] = isRGBW ?  DDP_TYPE_RGBW32 : DDP_TYPE_RGB24;
+        /*3*/p[3] = DDP_ID_DISPLAY;
         // data offset in bytes, 32-bit number, MSB first
-        /*4*/ddpUdp.write(0xFF & (channel >> 24));
-        /*5*/ddpUdp.write(0xFF & (channel >> 16));
-        /*6*/ddpUdp.write(0xFF & (channel >>  8));
-        /*7*/ddpUdp.write(0xFF & (channel      ));
+        /*4*/p[4] = 0xFF & (channel >> 24);
+        /*5*/p[5] = 0xFF & (channel >> 16);
+        /*6*/p[6] = 0xFF & (channel >>  8);
+        /*7*/p[7] = 0xFF & (channel      );
         // data length in bytes, 16-bit number, MSB first
-        /*8*/ddpUdp.write(0xFF & (packetSize >> 8));
-        /*9*/ddpUdp.write(0xFF & (packetSize     ));
-
-        // write the colors, the write write(const uint8_t *buffer, size_t size)
-        // function is just a loop internally too
-        for (size_t i = 0; i < packetSize; i += (isRGBW?4:3)) {
-          ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // R
-          ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // G
-          ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // B
-          if (isRGBW) ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // W
-        }
+        /*8*/p[8] = 0xFF & (packetSize >> 8);
+        /*9*/p[9] = 0xFF & (packetSize     );
+        fillChannels(p + DDP_HEADER_LEN, buffer + bufferOffset, packetSize, bri);
+        bufferOffset += packetSize;
 
-        if (!ddpUdp.endPacket()) {
+        if (!netOutUdp.beginPacket(client, DDP_DEFAULT_PORT)) {  // port defined in ESPAsyncE131.h
+          DEBUG_PRINTLN(F("WiFiUDP.beginPacket returned an error"));
+          return 1; // problem
+        }
+        netOutUdp.write(p, DDP_HEADER_LEN + packetSize);
+        if (!netOutUdp.endPacket()) {
           DEBUG_PRINTLN(F("WiFiUDP.endPacket returned an error"));
           return 1; // problem
         }
@@ -789,63 +1275,141 @@ uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, uint8
     } break;
 
     case 1: //E1.31
-    {
-    } break;
-
     case 2: //ArtNet
     {
-      // calculate the number of UDP packets we need to send
-      const size_t channelCount = length * (isRGBW?4:3); // 1 channel for every R,G,B,(W?) value
-      const size_t ARTNET_CHANNELS_PER_PACKET = isRGBW?512:510; // 512/4=128 RGBW LEDs, 510/3=170 RGB LEDs
-      const size_t packetCount = ((channelCount-1)/ARTNET_CHANNELS_PER_PACKET)+1;
-
-      uint32_t channel = 0; 
+      // whole pixels per universe: 512/4=128 RGBW LEDs, 510/3=170 RGB LEDs
+      const size_t dmxLen = isRGBW ? 512 : 510;
+      size_t dmxStart = startChannel % dmxLen;
+      universe = realtimeSyncUniverse(type, isRGBW, universe, startChannel);
       size_t bufferOffset = 0;
 
-      sequenceNumber++;
-
-      for (size_t currentPacket = 0; currentPacket < packetCount; currentPacket++) {
-
-        if (sequenceNumber > 255) sequenceNumber = 0;
-
-        if (!ddpUdp.beginPacket(client, ARTNET_DEFAULT_PORT)) {
-          DEBUG_PRINTLN(F("Art-Net WiFiUDP.beginPacket returned an error"));
-          return 1; // borked
-        }
-
-        size_t packetSize = ARTNET_CHANNELS_PER_PACKET;
-
-        if (currentPacket == (packetCount - 1U)) {
-          // last packet
-          if (channelCount % ARTNET_CHANNELS_PER_PACKET) {
-            packetSize = channelCount % ARTNET_CHANNELS_PER_PACKET;
-          }
+      if (type == 1) e131Sequence++;
+      else if (++sequenceNumber > 255) sequenceNumber = 1; // Art-Net sequence 0 disables reordering
+
+      for (uint16_t uni = universe; bufferOffset < channelCount; uni++, dmxStart = 0) {
+        byte *p = netOutBuffer;
+        size_t packetSize;
+        uint16_t port;
+        if (type == 1) {
+          packetSize = fillDmxChannels(p + E131_HEADER_LEN, buffer, channelCount, bufferOffset, dmxStart, dmxLen, bri);
+          writeE131Header(p, uni, packetSize, deferLatch ? universe : 0);
+          packetSize += E131_HEADER_LEN;
+          port = E131_DEFAULT_PORT;
+        } else {
+          packetSize = fillDmxChannels(p + ART_NET_DMX_HEADER_LEN, buffer, channelCount, bufferOffset, dmxStart, dmxLen, bri);
+          if (packetSize & 1) p[ART_NET_DMX_HEADER_LEN + packetSize++] = 0; // Art-Net requires an even data length
+          memcpy_P(p, ART_NET_HEADER, ART_NET_HEADER_SIZE); // This doesn't change. Hard coded ID, OpCode, and protocol version.
+          p[12] = sequenceNumber & 0xFF; // sequence number. 1..255
+          p[13] = 0x00;                  // physical - more an FYI, not really used for anything. 0..3
+          p[14] = uni & 0xFF;            // SubUni
+          p[15] = (uni >> 8) & 0x7F;     // Net
+          p[16] = 0xFF & (packetSize >> 8); // 16-bit length of channel data, MSB
+          p[17] = 0xFF & (packetSize     ); // 16-bit length of channel data, LSB
+          packetSize += ART_NET_DMX_HEADER_LEN;
+          port = ARTNET_DEFAULT_PORT;
         }
 
-        byte header_buffer[ART_NET_HEADER_SIZE];
-        memcpy_P(header_buffer, ART_NET_HEADER, ART_NET_HEADER_SIZE);
-        ddpUdp.write(header_buffer, ART_NET_HEADER_SIZE); // This doesn't change. Hard coded ID, OpCode, and protocol version.
-        ddpUdp.write(sequenceNumber & 0xFF); // sequence number. 1..255
-        ddpUdp.write(0x00); // physical - more an FYI, not really used for anything. 0..3
-        ddpUdp.write((currentPacket) & 0xFF); // Universe LSB. 1 full packet == 1 full universe, so just use current packet number.
-        ddpUdp.write(0x00); // Universe MSB, unused.
-        ddpUdp.write(0xFF & (packetSize >> 8)); // 16-bit length of channel data, MSB
-        ddpUdp.write(0xFF & (packetSize     )); // 16-bit length of channel data, LSB
-
-        for (size_t i = 0; i < packetSize; i += (isRGBW?4:3)) {
-          ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // R
-          ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // G
-          ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // B
-          if (isRGBW) ddpUdp.write(scale8(buffer[bufferOffset++], bri)); // W
+        if (!netOutUdp.beginPacket(client, port)) {
+          DEBUG_PRINTLN(F("E1.31/Art-Net WiFiUDP.beginPacket returned an error"));
+          return 1; // borked
         }
-
-        if (!ddpUdp.endPacket()) {
-          DEBUG_PRINTLN(F("Art-Net WiFiUDP.endPacket returned an error"));
+        netOutUdp.write(p, packetSize);
+        if (!netOutUdp.endPacket()) {
+          DEBUG_PRINTLN(F("E1.31/Art-Net WiFiUDP.endPacket returned an error"));
           return 1; // borked
         }
-        channel += packetSize;
       }
     } break;
   }
   return 0;
 }
+
+// first universe realtimeBroadcast() sends to, it is also the E1.31 sync address of that data
+uint16_t realtimeSyncUniverse(uint8_t type, bool isRGBW, uint16_t universe, uint16_t startChannel)  {
+  if (type != 1 && type != 2) return 0;
+  if (type == 1 && universe == 0) universe = 1; // E1.31 universes start at 1
+  return universe + startChannel / (isRGBW ? 512 : 510); // whole pixels per universe
+}
+
+// latch data sent with deferLatch: DDP push, E1.31 universe sync or ArtSync
+// universe - E1.31 sync address, from realtimeSyncUniverse()
+// ArtSync is broadcast as the Art-Net specification requires, once per frame is enough for all receivers
+uint8_t realtimeBroadcastSync(uint8_t type, IPAddress client, uint16_t universe)  {
+  if (!(apActive || interfacesInited) || !client[0]) return 1;
+
+  byte *p = netOutBuffer;
+  size_t len;
+  uint16_t port;
+  switch (type) {
+    case 0: // DDP push without data
+      p[0] = DDP_FLAGS1_VER1 | DDP_FLAGS1_PUSH;
+      p[1] = 0;
+      p[2] = 0;
+      p[3] = DDP_ID_DISPLAY;
+      memset(p + 4, 0, 6);
+      len = DDP_SYNCPACKET_LEN;
+      port = DDP_DEFAULT_PORT;
+      break;
+    case 1: // E1.31 synchronization packet
+      memcpy_P(p, E131_ACN_ID, sizeof(E131_ACN_ID));
+      p[16] = 0x70; p[17] = E131_SYNC_PACKET_LEN - 16;
+      p[18] = 0; p[19] = 0; p[20] = 0; p[21] = 0x08;           // VECTOR_ROOT_E131_EXTENDED
+      memcpy(p + 22, "WLED", 4);
+      memcpy(p + 26, escapedMac.c_str(), min((size_t)12, escapedMac.length()));
+      p[38] = 0x70; p[39] = E131_SYNC_PACKET_LEN - 38;
+      p[40] = 0; p[41] = 0; p[42] = 0; p[43] = 0x01;           // VECTOR_E131_EXTENDED_SYNCHRONIZATION
+      p[44] = e131Sequence;
+      p[45] = universe >> 8; p[46] = universe;
+      p[47] = 0; p[48] = 0;                                     // reserved
+      len = E131_SYNC_PACKET_LEN;
+      port = E131_DEFAULT_PORT;
+      break;
+    case 2: // ArtSync
+      memcpy_P(p, ART_NET_SYNC, ART_NET_SYNC_LEN);
+      len = ART_NET_SYNC_LEN;
+      port = ARTNET_DEFAULT_PORT;
+      client = ~uint32_t(Network.subnetMask()) | uint32_t(Network.gatewayIP());
+      break;
+    default:
+      return 1;
+  }
+
+  if (!netOutUdp.beginPacket(client, port)) return 1;
+  netOutUdp.write(p, len);
+  return netOutUdp.endPacket() ? 0 : 1;
+}
+
+// load /netmap.json and add it as a network output map bus, must be called before strip.finalizeInit()
+// {"start":0,"rgbw":false,"spread":0,"map":[{"ip":"192.168.1.50","start":0,"len":500,"proto":0,"ch":0,"uni":0},...]}
+// proto: 0=DDP, 1=E1.31, 2=Art-Net; spread: ms over which packets are distributed (0 = 3/4 of frame time)
+bool loadNetworkOutputMap()
+{
+  if (!WLED_FS.exists(F("/netmap.json"))) return false;
+  if (!requestJSONBufferLock(22)) return false;
+  if (!readObjectFromFile(PSTR("/netmap.json"), nullptr, &doc)) {
+    releaseJSONBufferLock();
+    return false;
+  }
+
+  NetworkOutput outputs[WLED_MAX_NET_OUTPUTS];
+  uint8_t count = 0;
+  for (JsonObject out : doc[F("map")].as<JsonArray>()) {
+    if (count >= WLED_MAX_NET_OUTPUTS) break;
+    NetworkOutput &o = outputs[count];
+    if (!o.ip.fromString(out["ip"] | "") || !o.ip[0]) continue;
+    o.start    = out["start"] | 0;
+    o.len      = out["len"] | 0;
+    o.type     = out[F("proto")] | 0;
+    o.channel  = out["ch"] | 0;
+    o.universe = out[F("uni")] | 0;
+    if (!o.len || o.type > 2) continue;
+    count++;
+  }
+  uint16_t start  = doc["start"] | 0;
+  bool     rgbw   = doc[F("rgbw")] | false;
+  uint16_t spread = doc[F("spread")] | 0;
+  releaseJSONBufferLock();
+
+  DEBUG_PRINTF("Network output map: %u outputs.\n", count);
+  return count && busses.addNetworkMap(start, rgbw, outputs, count, spread) >= 0;
+}
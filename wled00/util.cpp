@@ -431,6 +431,9 @@ um_data_t* simulateSound(uint8_t simulationId)
   static float    volumeSmth;
   static uint16_t volumeRaw;
   static float    my_magnitude;
+  static float    beatBpm;
+  static float    beatPhase;
+  static uint8_t  beatConfidence;
 
   //arrays
   uint8_t *fftResult;
@@ -445,7 +448,7 @@ um_data_t* simulateSound(uint8_t simulationId)
     // NOTE!!!
     // This may change as AudioReactive usermod may change
     um_data = new um_data_t;
-    um_data->u_size = 8;
+    um_data->u_size = 11;
     um_data->u_type = new um_types_t[um_data->u_size];
     um_data->u_data = new void*[um_data->u_size];
     um_data->u_data[0] = &volumeSmth;
@@ -456,6 +459,9 @@ um_data_t* simulateSound(uint8_t simulationId)
     um_data->u_data[5] = &my_magnitude;
     um_data->u_data[6] = &maxVol;
     um_data->u_data[7] = &binNum;
+    um_data->u_data[8] = &beatBpm;
+    um_data->u_data[9] = &beatPhase;
+    um_data->u_data[10] = &beatConfidence;
   } else {
     // get arrays from um_data
     fftResult =  (uint8_t*)um_data->u_data[2];
@@ -466,12 +472,14 @@ um_data_t* simulateSound(uint8_t simulationId)
   switch (simulationId) {
     default:
     case UMS_BeatSin:
+      beatBpm = 120;
       for (int i = 0; i<16; i++)
         fftResult[i] = beatsin8(120 / (i+1), 0, 255);
         // fftResult[i] = (beatsin8(120, 0, 255) + (256/16 * i)) % 256;
         volumeSmth = fftResult[8];
       break;
     case UMS_WeWillRockYou:
+      beatBpm = 150; // a sound every 400ms
       if (ms%2000 < 200) {
         volumeSmth = random8(255);
         for (int i = 0; i<5; i++)
@@ -522,6 +530,9 @@ um_data_t* simulateSound(uint8_t simulationId)
   volumeRaw = volumeSmth;
   my_magnitude = 10000.0f / 8.0f; //no idea if 10000 is a good value for FFT_Magnitude ???
   if (volumeSmth < 1 ) my_magnitude = 0.001f;             // noise gate closed - mute
+  uint16_t beatMs = 60000 / (uint16_t)beatBpm;
+  beatPhase = float(ms % beatMs) / beatMs;
+  beatConfidence = 255;
 
   return um_data;
 }
@@ -60,6 +60,14 @@ void WLED::loop()
   handleSerial();
   handleImprovWifiScan();
   handleNotifications();
+  refreshNodeList();
+  handleJitterBuffer();
+  handleTimeSync();
+  #ifndef WLED_DISABLE_MQTT
+  handleMqtt();
+  #endif
+  handleJsonQueue();
+  handleBinaryQueue();
   handleTransitions();
 #ifdef WLED_ENABLE_DMX
   handleDMX();
@@ -123,6 +131,7 @@ void WLED::loop()
   avgStripMillis += stripMillis;
   if (stripMillis > maxStripMillis) maxStripMillis = stripMillis;
   #endif
+  busses.service(); // paced network output (also in realtime mode)
 
   yield();
 #ifdef ESP8266
@@ -142,8 +151,6 @@ void WLED::loop()
     initMqtt();
     #endif
     yield();
-    // refresh WLED nodes list
-    refreshNodeList();
     if (nodeBroadcastEnabled) sendSysInfoUDP();
     yield();
   }
@@ -175,6 +182,7 @@ void WLED::loop()
       }
       delete busConfigs[i]; busConfigs[i] = nullptr;
     }
+    loadNetworkOutputMap();
     strip.finalizeInit(); // also loads default ledmap if present
     if (aligned) strip.makeAutoSegments();
     else strip.fixInvalidSegments();
@@ -431,8 +439,11 @@ void WLED::setup()
 
   DEBUG_PRINTLN(F("Initializing strip"));
   beginStrip();
+  if (presetToApply == 0) strip.service(); // first frame before the rest of the setup (boot preset is applied in loop)
   DEBUG_PRINT(F("heap ")); DEBUG_PRINTLN(ESP.getFreeHeap());
 
+  deserializeConfigDeferred(); // settings not needed for the LED outputs
+
   DEBUG_PRINTLN(F("Usermods setup"));
   userSetup();
   usermods.setup();
@@ -504,6 +515,7 @@ void WLED::setup()
 void WLED::beginStrip()
 {
   // Initialize NeoPixel Strip and button
+  loadNetworkOutputMap();
   strip.finalizeInit(); // busses created during deserializeConfig()
   strip.makeAutoSegments();
   strip.setBrightness(0);
@@ -550,7 +562,7 @@ void WLED::initAP(bool resetAP)
     DEBUG_PRINTLN(F("Init AP interfaces"));
     server.begin();
     if (udpPort > 0 && udpPort != ntpLocalPort) {
-      udpConnected = notifierUdp.begin(udpPort);
+      udpConnected = beginSyncUdp();
     }
     if (udpRgbPort > 0 && udpRgbPort != ntpLocalPort && udpRgbPort != udpPort) {
       udpRgbConnected = rgbUdp.begin(udpRgbPort);
@@ -768,7 +780,7 @@ void WLED::initInterfaces()
   server.begin();
 
   if (udpPort > 0 && udpPort != ntpLocalPort) {
-    udpConnected = notifierUdp.begin(udpPort);
+    udpConnected = beginSyncUdp();
     if (udpConnected && udpRgbPort != udpPort)
       udpRgbConnected = rgbUdp.begin(udpRgbPort);
     if (udpConnected && udpPort2 != udpPort && udpPort2 != udpRgbPort)
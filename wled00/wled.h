@@ -366,9 +366,10 @@ WLED_GLOBAL bool simplifiedUI          _INIT(false);   // enable simplified UI
 WLED_GLOBAL byte cacheInvalidate       _INIT(0);       // used to invalidate browser cache when switching from regular to simplified UI
 
 // Sync CONFIG
-WLED_GLOBAL NodesMap Nodes;
+WLED_GLOBAL NodeTable Nodes;
 WLED_GLOBAL bool nodeListEnabled _INIT(true);
 WLED_GLOBAL bool nodeBroadcastEnabled _INIT(true);
+WLED_GLOBAL bool timeSyncEnabled _INIT(false);                    // align effect clock (timebase) with other instances
 
 WLED_GLOBAL byte buttonType[WLED_MAX_BUTTONS]  _INIT({BTN_TYPE_PUSH});
 #if defined(IRTYPE) && defined(IRPIN)
@@ -395,6 +396,8 @@ WLED_GLOBAL bool notifyAlexa  _INIT(false);                       // send notifi
 WLED_GLOBAL bool notifyMacro  _INIT(false);                       // send notification for macro
 WLED_GLOBAL bool notifyHue    _INIT(true);                        // send notification if Hue light changes
 WLED_GLOBAL uint8_t udpNumRetries _INIT(0);                       // Number of times a UDP sync message is retransmitted. Increase to increase reliability
+WLED_GLOBAL bool notifyDelta  _INIT(false);                       // send sync protocol v13 (changed segment fields only), older receivers get no segment data
+WLED_GLOBAL IPAddress syncMulticastIP _INIT_N(((0, 0, 0, 0)));    // multicast group for sync notifications (0.0.0.0: subnet broadcast)
 
 WLED_GLOBAL bool alexaEnabled _INIT(false);                       // enable device discovery by Amazon Echo
 WLED_GLOBAL char alexaInvocationName[33] _INIT("Light");          // speech control name of device. Choose something voice-to-text can understand
@@ -402,6 +405,8 @@ WLED_GLOBAL byte alexaNumPresets _INIT(0);                        // number of p
 
 WLED_GLOBAL uint16_t realtimeTimeoutMs _INIT(2500);               // ms timeout of realtime mode before returning to normal mode
 WLED_GLOBAL int arlsOffset _INIT(0);                              // realtime LED offset
+WLED_GLOBAL uint16_t realtimeJitterMs _INIT(0);                   // realtime jitter buffer latency target, 0 = show frames on arrival
+WLED_GLOBAL bool realtimeInterpolate _INIT(false);                // blend between buffered realtime frames
 WLED_GLOBAL bool receiveDirect _INIT(true);                       // receive UDP realtime
 WLED_GLOBAL bool arlsDisableGammaCorrection _INIT(true);          // activate if gamma correction is handled by the source
 WLED_GLOBAL bool arlsForceMaxBri _INIT(false);                    // enable to force max brightness if source has very dark colors that would be black
@@ -424,6 +429,7 @@ WLED_GLOBAL uint16_t DMXSegmentSpacing _INIT(0);                  // Number of v
 WLED_GLOBAL byte e131LastSequenceNumber[E131_MAX_UNIVERSE_COUNT]; // to detect packet loss
 WLED_GLOBAL bool e131Multicast _INIT(false);                      // multicast or unicast
 WLED_GLOBAL bool e131SkipOutOfSequence _INIT(false);              // freeze instead of flickering
+WLED_GLOBAL uint16_t e131FrameTimeout _INIT(50);                  // ms to wait for all universes of a staged frame (0 = write each universe to the strip as it arrives)
 WLED_GLOBAL uint16_t pollReplyCount _INIT(0);                     // count number of replies for ArtPoll node report
 
 // mqtt
@@ -446,6 +452,7 @@ WLED_GLOBAL char mqttPass[65] _INIT("");                   // optional: password
 WLED_GLOBAL char mqttClientID[41] _INIT("");               // override the client ID
 WLED_GLOBAL uint16_t mqttPort _INIT(1883);
 WLED_GLOBAL bool retainMqttMsg _INIT(false);               // retain brightness and color
+WLED_GLOBAL uint16_t mqttDropped _INIT(0);                  // received messages dropped (queue full or out of memory)
 #define WLED_MQTT_CONNECTED (mqtt != nullptr && mqtt->connected())
 #else
 #define WLED_MQTT_CONNECTED false
@@ -809,6 +816,19 @@ WLED_GLOBAL volatile uint8_t jsonBufferLock _INIT(0);
 #endif
 #define WLED_WIFI_CONFIGURED (strlen(clientSSID) >= 1 && strcmp(clientSSID, DEFAULT_CLIENT_SSID) != 0)
 
+// short critical sections for data shared with async network callbacks
+// (AsyncUDP/AsyncTCP run in their own task on ESP32, on ESP8266 they never preempt the main loop)
+// no allocation, logging or other blocking calls while locked
+#ifdef ARDUINO_ARCH_ESP32
+  #define WLED_ASYNC_MUX(m)    static portMUX_TYPE m = portMUX_INITIALIZER_UNLOCKED
+  #define WLED_ASYNC_LOCK(m)   portENTER_CRITICAL(&m)
+  #define WLED_ASYNC_UNLOCK(m) portEXIT_CRITICAL(&m)
+#else
+  #define WLED_ASYNC_MUX(m)    static const bool m = false
+  #define WLED_ASYNC_LOCK(m)   (void)m
+  #define WLED_ASYNC_UNLOCK(m) (void)m
+#endif
+
 #ifndef WLED_AP_SSID_UNIQUE
   #define WLED_SET_AP_SSID() do { \
     strcpy_P(apSSID, PSTR(WLED_AP_SSID)); \
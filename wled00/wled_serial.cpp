@@ -187,7 +187,7 @@ void handleSerial()
         else {
           realtimeLock(realtimeTimeoutMs, REALTIME_MODE_ADALIGHT);
 
-          if (!realtimeOverride) strip.show();
+          if (!realtimeOverride) realtimeShow();
           state = AdaState::Header_A;
         }
         break;
@@ -49,6 +49,11 @@ void handleUpload(AsyncWebServerRequest *request, const String& filename, size_t
       finalname = '/' + finalname; // prepend slash if missing
     }
 
+    // a precompressed variant is served in place of the plain file (and vice versa), drop the stale one
+    String other = finalname.endsWith(".gz") ? finalname.substring(0, finalname.length()-3) : finalname + ".gz";
+    if (WLED_FS.exists(other)) WLED_FS.remove(other);
+
+    invalidateFileETags();
     request->_tempFile = WLED_FS.open(finalname, "w");
     DEBUG_PRINT(F("Uploading "));
     DEBUG_PRINTLN(finalname);
@@ -59,7 +64,8 @@ void handleUpload(AsyncWebServerRequest *request, const String& filename, size_t
   }
   if (final) {
     request->_tempFile.close();
-    if (filename.indexOf(F("cfg.json")) >= 0) { // check for filename with or without slash
+    // a configuration restore reboots, saving the file from the editor (/upload?edit) does not
+    if (filename.indexOf(F("cfg.json")) >= 0 && !request->hasParam(F("edit"))) { // check for filename with or without slash
       doReboot = true;
       request->send(200, "text/plain", F("Configuration restore successful.\nRebooting..."));
     } else {
@@ -79,6 +85,11 @@ void createEditHandler(bool enable) {
       #else
       editHandler = &server.addHandler(new SPIFFSEditor("","",WLED_FS));//http_username,http_password));
       #endif
+      // files saved or deleted by the editor change without passing through WLED
+      editHandler->setFilter([](AsyncWebServerRequest *request) {
+        if (request->method() != HTTP_GET && request->url().startsWith(F("/edit"))) invalidateFileETags();
+        return true;
+      });
     #else
       editHandler = &server.on("/edit", HTTP_GET, [](AsyncWebServerRequest *request){
         serveMessage(request, 501, "Not implemented", F("The FS editor is disabled in this build."), 254);
@@ -175,9 +186,20 @@ void initServer()
 
   AsyncCallbackJsonWebHandler* handler = new AsyncCallbackJsonWebHandler("/json", [](AsyncWebServerRequest *request) {
     bool verboseResponse = false;
-    bool isConfig = false;
-
-    if (!requestJSONBufferLock(14)) return;
+    bool isConfig = request->url().indexOf("cfg") > -1;
+
+    if (!isConfig && (jsonBufferLock || jsonQueuePending(JSONQ_HTTP))) {
+      // busy or older requests waiting, state is applied from the main loop (no verbose response possible)
+      if (queueJsonState((const char*)request->_tempObject, request->contentLength(), JSONQ_HTTP))
+        request->send(202, "application/json", F("{\"success\":true,\"queued\":true}"));
+      else
+        request->send(503, "application/json", F("{\"error\":3}"));
+      return;
+    }
+    if (!requestJSONBufferLock(14)) {
+      request->send(503, "application/json", F("{\"error\":3}"));
+      return;
+    }
 
     DeserializationError error = deserializeJson(doc, (uint8_t*)(request->_tempObject));
     JsonObject root = doc.as<JsonObject>();
@@ -188,8 +210,6 @@ void initServer()
     }
     if (root.containsKey("pin")) checkSettingsPIN(root["pin"].as<const char*>());
 
-    const String& url = request->url();
-    isConfig = url.indexOf("cfg") > -1;
     if (!isConfig) {
       /*
       #ifdef WLED_DEBUG
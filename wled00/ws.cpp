@@ -1,4 +1,5 @@
 #include "wled.h"
+#include <new>
 
 /*
  * WebSockets server for bidirectional communication
@@ -7,19 +8,303 @@
 
 uint16_t wsLiveClientId = 0;
 unsigned long wsLastLiveTime = 0;
+static void setupLiveLedsWs(JsonObject req);
+static void stopLiveLedsWs();
 //uint8_t* wsFrameBuffer = nullptr;
 
 #define WS_LIVE_INTERVAL 40
+#define WS_LIVE_KEYFRAME 50          // live view (v3) frames between key frames
+#define WS_LIVE_SAMPLE_CHUNK 512     // live view (v3) source pixels sampled per handleWs() call
+
+#ifdef ESP8266
+#define MAX_LIVE_LEDS_WS 256U
+#else
+#define MAX_LIVE_LEDS_WS 1024U
+#endif
+#define WS_FULL_STATE_INTERVAL 60000 // ms, full state resync interval for delta clients
+#define WS_MAX_STATE_KEYS 24         // top level state keys tracked for delta updates
+
+/*
+ * Delta state updates
+ * A client sending {"dlt":true} receives a full {"rev":N,"state":{},"info":{}} message followed by
+ * {"rev":N,"state":{}} messages containing only top level state keys and segment fields (grouped by
+ * SEG_DIFFERS_* flags) that changed since the previous broadcast. Segments are identified by "id",
+ * removed segments are sent as {"id":x,"stop":0}. Values are absolute so re-applying them is harmless.
+ * "rev" increments with each non-empty delta; a client seeing a gap should request {"v":true}.
+ * Full snapshots are sent every WS_FULL_STATE_INTERVAL and when realtime mode changes.
+ * Clients that do not subscribe keep receiving full state+info as before.
+ */
+typedef struct WsClientSlot {
+  uint32_t id;
+  bool     delta;
+} wsclient_t;
+
+typedef struct WsSegmentBase {
+  Segment::segsnap_t snap;
+  uint16_t nameHash;
+  bool     active;
+} wssegbase_t;
+
+static wsclient_t    wsClients[DEFAULT_MAX_WS_CLIENTS] = {};
+static uint8_t       wsDeltaClients = 0;
+static uint16_t      wsStateRev = 0;          // revision of the last broadcast state
+static unsigned long wsLastFullState = 0;
+static bool          wsBaseValid = false;
+static byte          wsBaseRealtime = REALTIME_MODE_INACTIVE;
+static wssegbase_t  *wsBaseSegs = nullptr;    // allocated only while delta clients are connected
+static uint8_t       wsBaseKeyCount = 0;
+static struct { uint16_t key, val; } wsBaseKeys[WS_MAX_STATE_KEYS];
+
+// CRC16 (same as crc16() in util.cpp) computed on the fly while serializing
+class HashPrint : public Print {
+  public:
+    uint16_t crc = 0xFFFF;
+    size_t write(uint8_t c) override {
+      uint8_t x = crc >> 8 ^ c;
+      x ^= x>>4;
+      crc = (crc << 8) ^ ((uint16_t)(x << 12)) ^ ((uint16_t)(x <<5)) ^ ((uint16_t)x);
+      return 1;
+    }
+};
+
+static uint16_t hashJson(JsonVariantConst v)
+{
+  HashPrint h;
+  serializeJson(v, h);
+  return h.crc;
+}
+
+// maps segment JSON keys to SEG_DIFFERS_* groups
+static const struct { char key[7]; uint8_t group; } wsSegKeys[] PROGMEM = {
+  {"start", SEG_DIFFERS_BOUNDS}, {"stop", SEG_DIFFERS_BOUNDS}, {"startY", SEG_DIFFERS_BOUNDS}, {"stopY", SEG_DIFFERS_BOUNDS}, {"len", SEG_DIFFERS_BOUNDS},
+  {"grp", SEG_DIFFERS_GSO}, {"spc", SEG_DIFFERS_GSO}, {"of", SEG_DIFFERS_GSO},
+  {"bri", SEG_DIFFERS_BRI},
+  {"on", SEG_DIFFERS_OPT}, {"frz", SEG_DIFFERS_OPT}, {"set", SEG_DIFFERS_OPT}, {"rev", SEG_DIFFERS_OPT}, {"mi", SEG_DIFFERS_OPT},
+  {"rY", SEG_DIFFERS_OPT}, {"mY", SEG_DIFFERS_OPT}, {"tp", SEG_DIFFERS_OPT}, {"si", SEG_DIFFERS_OPT}, {"m12", SEG_DIFFERS_OPT},
+  {"col", SEG_DIFFERS_COL}, {"cct", SEG_DIFFERS_COL},
+  {"fx", SEG_DIFFERS_FX}, {"sx", SEG_DIFFERS_FX}, {"ix", SEG_DIFFERS_FX}, {"pal", SEG_DIFFERS_FX},
+  {"c1", SEG_DIFFERS_FX}, {"c2", SEG_DIFFERS_FX}, {"c3", SEG_DIFFERS_FX}, {"o1", SEG_DIFFERS_FX}, {"o2", SEG_DIFFERS_FX}, {"o3", SEG_DIFFERS_FX},
+  {"sel", SEG_DIFFERS_SEL}
+};
+
+static uint8_t wsSegKeyGroup(const char *key)
+{
+  for (size_t i = 0; i < sizeof(wsSegKeys)/sizeof(wsSegKeys[0]); i++) {
+    if (strcmp_P(key, wsSegKeys[i].key) == 0) return pgm_read_byte(&wsSegKeys[i].group);
+  }
+  return 0;
+}
+
+static void wsTrackClient(uint32_t id, bool add)
+{
+  for (size_t i = 0; i < DEFAULT_MAX_WS_CLIENTS; i++) {
+    if (add && wsClients[i].id == 0) {
+      wsClients[i].id = id;
+      wsClients[i].delta = false;
+      return;
+    }
+    if (!add && wsClients[i].id == id) {
+      if (wsClients[i].delta) wsDeltaClients--;
+      wsClients[i].id = 0;
+      wsClients[i].delta = false;
+      break;
+    }
+  }
+  if (!wsDeltaClients && wsBaseSegs) {
+    delete[] wsBaseSegs;
+    wsBaseSegs = nullptr;
+    wsBaseValid = false;
+  }
+}
+
+static void wsSubscribeDelta(uint32_t id, bool subscribe)
+{
+  for (size_t i = 0; i < DEFAULT_MAX_WS_CLIENTS; i++) {
+    if (wsClients[i].id != id) continue;
+    if (wsClients[i].delta == subscribe) return;
+    if (subscribe && !wsBaseSegs) {
+      wsBaseSegs = new (std::nothrow) wssegbase_t[strip.getMaxSegments()];
+      if (!wsBaseSegs) return; // out of memory, client stays on full updates
+      wsBaseValid = false;
+    }
+    wsClients[i].delta = subscribe;
+    if (subscribe) wsDeltaClients++;
+    else           wsDeltaClients--;
+    break;
+  }
+  if (!wsDeltaClients && wsBaseSegs) {
+    delete[] wsBaseSegs;
+    wsBaseSegs = nullptr;
+    wsBaseValid = false;
+  }
+}
+
+static size_t wsTrackedClients()
+{
+  size_t n = 0;
+  for (size_t i = 0; i < DEFAULT_MAX_WS_CLIENTS; i++) if (wsClients[i].id) n++;
+  return n;
+}
+
+// compares serialized state with the last broadcast state, copies changed values into dst (if not null)
+// and makes the current state the new base; returns true if anything changed
+static bool wsDiffState(JsonObject state, JsonObject dst)
+{
+  bool changed = false;
+
+  // top level keys are compared by hash of their serialized value
+  uint8_t keyCount = 0;
+  struct { uint16_t key, val; } keys[WS_MAX_STATE_KEYS];
+  for (JsonPair kv : state) {
+    const char *key = kv.key().c_str();
+    if (strcmp_P(key, PSTR("seg")) == 0) continue;
+    uint16_t kh = crc16((const unsigned char*)key, strlen(key));
+    uint16_t vh = hashJson(kv.value());
+    bool same = false;
+    if (wsBaseValid && strcmp_P(key, PSTR("error")) != 0) {
+      for (size_t i = 0; i < wsBaseKeyCount; i++) if (wsBaseKeys[i].key == kh) { same = (wsBaseKeys[i].val == vh); break; }
+    }
+    if (keyCount < WS_MAX_STATE_KEYS) {
+      keys[keyCount].key = kh;
+      keys[keyCount].val = vh;
+      keyCount++;
+    }
+    if (!same) {
+      dst[kv.key()] = kv.value();
+      changed = true;
+    }
+  }
+  memcpy(wsBaseKeys, keys, sizeof(keys[0]) * keyCount);
+  wsBaseKeyCount = keyCount;
+
+  // segments are compared field-group wise using segment snapshots
+  JsonArray segs = state["seg"];
+  JsonArray dsegs;
+  JsonArray::iterator it = segs.begin();
+  for (size_t s = 0; s < strip.getMaxSegments(); s++) {
+    wssegbase_t &base = wsBaseSegs[s];
+    bool active = s < strip.getSegmentsNum() && strip.getSegment(s).isActive();
+    if (!active) {
+      if (wsBaseValid && base.active) {
+        if (dsegs.isNull()) dsegs = dst.createNestedArray("seg");
+        JsonObject seg0 = dsegs.createNestedObject();
+        seg0["id"] = s;
+        seg0["stop"] = 0;
+        changed = true;
+      }
+      base.active = false;
+      continue;
+    }
+    JsonObject src = (it != segs.end()) ? it->as<JsonObject>() : JsonObject();
+    ++it;
+
+    Segment &sg = strip.getSegment(s);
+    uint16_t nameHash = sg.name ? crc16((const unsigned char*)sg.name, strlen(sg.name)) : 0;
+    uint8_t d = 0xFF; // whole segment
+    if (wsBaseValid && base.active) d = sg.differs(base.snap);
+    bool nameChanged = (nameHash != base.nameHash) || !wsBaseValid || !base.active;
+    if (d || nameChanged) {
+      if (dsegs.isNull()) dsegs = dst.createNestedArray("seg");
+      JsonObject seg0 = dsegs.createNestedObject();
+      seg0["id"] = s;
+      for (JsonPair kv : src) {
+        if (wsSegKeyGroup(kv.key().c_str()) & d) seg0[kv.key()] = kv.value();
+      }
+      if (nameChanged) {
+        if (sg.name) seg0["n"] = src["n"];
+        else         seg0["n"] = "";
+      }
+      changed = true;
+    }
+    sg.snapshot(base.snap);
+    base.nameHash = nameHash;
+    base.active = true;
+  }
+
+  wsBaseValid = true;
+  wsBaseRealtime = realtimeMode;
+  return changed;
+}
+
+// serializes JSON into a new (locked) WS message buffer, disconnects all clients if out of memory
+static AsyncWebSocketMessageBuffer * wsJsonBuffer(JsonVariantConst src)
+{
+  size_t len = measureJson(src);
+  DEBUG_PRINTF("JSON buffer size: %u for WS request (%u).\n", doc.memoryUsage(), len);
+
+  size_t heap1 = ESP.getFreeHeap();
+  DEBUG_PRINT(F("heap ")); DEBUG_PRINTLN(ESP.getFreeHeap());
+  #ifdef ESP8266
+  if (len>heap1) {
+    DEBUG_PRINTLN(F("Out of memory (WS)!"));
+    return nullptr;
+  }
+  #endif
+  AsyncWebSocketMessageBuffer * buffer = ws.makeBuffer(len); // will not allocate correct memory sometimes on ESP8266
+  #ifdef ESP8266
+  size_t heap2 = ESP.getFreeHeap();
+  DEBUG_PRINT(F("heap ")); DEBUG_PRINTLN(ESP.getFreeHeap());
+  #else
+  size_t heap2 = 0; // ESP32 variants do not have the same issue and will work without checking heap allocation
+  #endif
+  if (!buffer || heap1-heap2<len) {
+    DEBUG_PRINTLN(F("WS buffer allocation failed."));
+    ws.closeAll(1013); //code 1013 = temporary overload, try again later
+    ws.cleanupClients(0); //disconnect all clients to release memory
+    ws._cleanBuffers();
+    return nullptr; //out of memory
+  }
+
+  buffer->lock();
+  serializeJson(src, (char *)buffer->get(), len);
+  return buffer;
+}
+
+// applies a JSON message of websocket client id (JSON buffer locked, called directly or from the JSON queue),
+// returns the individual response the client needs
+uint8_t applyWsJson(uint32_t id, JsonObject root)
+{
+  bool verboseResponse = false;
+  bool subscribed = false;
+  if (root["v"] && root.size() == 1) {
+    //if the received value is just "{"v":true}", send only to this client
+    verboseResponse = true;
+  } else if (root.containsKey("lv")) {
+    if (root["lv"].is<JsonObject>()) {
+      wsLiveClientId = id;
+      setupLiveLedsWs(root["lv"]);
+    } else {
+      wsLiveClientId = root["lv"] ? id : 0;
+      stopLiveLedsWs();
+    }
+  } else if (root.containsKey("dlt")) {
+    wsSubscribeDelta(id, root["dlt"].as<bool>());
+    verboseResponse = subscribed = true;
+  } else {
+    verboseResponse = deserializeState(root);
+  }
+
+  // individual client response only needed if no WS broadcast soon (or new delta client needs a base state)
+  if (interfaceUpdateCallMode && !subscribed) return WS_RESPONSE_NONE;
+  // force broadcast in 500ms after updating client
+  //lastInterfaceUpdate = millis() - (INTERFACE_UPDATE_COOLDOWN -500); // ESP8266 does not like this
+  return verboseResponse ? WS_RESPONSE_STATE : WS_RESPONSE_ACK;
+}
 
 void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data, size_t len)
 {
   if(type == WS_EVT_CONNECT){
     //client connected
     DEBUG_PRINTLN(F("WS client connected."));
+    wsTrackClient(client->id(), true);
     sendDataWs(client);
   } else if(type == WS_EVT_DISCONNECT){
     //client disconnected
-    if (client->id() == wsLiveClientId) wsLiveClientId = 0;
+    if (client->id() == wsLiveClientId) {
+      wsLiveClientId = 0;
+      stopLiveLedsWs();
+    }
+    wsTrackClient(client->id(), false);
     DEBUG_PRINTLN(F("WS client disconnected."));
   } else if(type == WS_EVT_DATA){
     // data packet
@@ -35,7 +320,12 @@ void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventTyp
           return;
         }
 
-        bool verboseResponse = false;
+        if ((jsonBufferLock || jsonQueuePending(JSONQ_WS)) && len > 0 && data[0] == '{') {
+          // busy or older requests waiting, applied from the main loop in order of arrival
+          if (queueJsonState((const char*)data, len, JSONQ_WS, client->id())) client->text(F("{\"success\":true,\"queued\":true}"));
+          else client->text(F("{\"error\":3}"));
+          return;
+        }
         if (!requestJSONBufferLock(11)) return;
 
         DeserializationError error = deserializeJson(doc, data, len);
@@ -44,27 +334,22 @@ void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventTyp
           releaseJSONBufferLock();
           return;
         }
-        if (root["v"] && root.size() == 1) {
-          //if the received value is just "{"v":true}", send only to this client
-          verboseResponse = true;
-        } else if (root.containsKey("lv")) {
-          wsLiveClientId = root["lv"] ? client->id() : 0;
-        } else {
-          verboseResponse = deserializeState(root);
-        }
+        uint8_t response = applyWsJson(client->id(), root);
         releaseJSONBufferLock(); // will clean fileDoc
 
-        if (!interfaceUpdateCallMode) { // individual client response only needed if no WS broadcast soon
-          if (verboseResponse) {
-            sendDataWs(client);
-          } else {
-            // we have to send something back otherwise WS connection closes
-            client->text(F("{\"success\":true}"));
-          }
-          // force broadcast in 500ms after updating client
-          //lastInterfaceUpdate = millis() - (INTERFACE_UPDATE_COOLDOWN -500); // ESP8266 does not like this
+        if (response == WS_RESPONSE_STATE) {
+          sendDataWs(client);
+        } else if (response == WS_RESPONSE_ACK) {
+          // we have to send something back otherwise WS connection closes
+          client->text(F("{\"success\":true}"));
         }
       }
+      else if (info->opcode == WS_BINARY && len > 0 && data[0] == BINAPI_MAGIC)
+      {
+        // binary control API, no JSON involved (see binapi.cpp), applied by the main loop
+        uint8_t ack[BINAPI_ACK_LEN];
+        if (!queueBinaryControl(data, len, client->id()) && binaryControlBusy(data, len, ack)) client->binary(ack, sizeof(ack));
+      }
     } else {
       //message is comprised of multiple frames or the frame is split into multiple packets
       //if(info->index == 0){
@@ -103,50 +388,70 @@ void sendDataWs(AsyncWebSocketClient * client)
 
   if (!requestJSONBufferLock(12)) return;
 
-  JsonObject state = doc.createNestedObject("state");
-  serializeState(state);
-  JsonObject info  = doc.createNestedObject("info");
-  serializeInfo(info);
+  // untracked clients (client table full) only understand full updates
+  bool full = client || !wsDeltaClients || !wsBaseValid || realtimeMode != wsBaseRealtime
+           || wsTrackedClients() < ws.count() || millis() - wsLastFullState > WS_FULL_STATE_INTERVAL;
 
-  size_t len = measureJson(doc);
-  DEBUG_PRINTF("JSON buffer size: %u for WS request (%u).\n", doc.memoryUsage(), len);
+  JsonObject msg = doc.createNestedObject("f");
+  JsonObject state = msg.createNestedObject("state");
+  serializeState(state);
 
-  size_t heap1 = ESP.getFreeHeap();
-  DEBUG_PRINT(F("heap ")); DEBUG_PRINTLN(ESP.getFreeHeap());
-  #ifdef ESP8266
-  if (len>heap1) {
-    DEBUG_PRINTLN(F("Out of memory (WS)!"));
-    return;
-  }
-  #endif
-  buffer = ws.makeBuffer(len); // will not allocate correct memory sometimes on ESP8266
-  #ifdef ESP8266
-  size_t heap2 = ESP.getFreeHeap();
-  DEBUG_PRINT(F("heap ")); DEBUG_PRINTLN(ESP.getFreeHeap());
-  #else
-  size_t heap2 = 0; // ESP32 variants do not have the same issue and will work without checking heap allocation
-  #endif
-  if (!buffer || heap1-heap2<len) {
-    releaseJSONBufferLock();
-    DEBUG_PRINTLN(F("WS buffer allocation failed."));
-    ws.closeAll(1013); //code 1013 = temporary overload, try again later
-    ws.cleanupClients(0); //disconnect all clients to release memory
-    ws._cleanBuffers();
-    return; //out of memory
+  JsonObject delta;
+  if (wsDeltaClients && (!client || !wsBaseValid)) {
+    // a single client response only becomes the base if there is none yet
+    JsonObject dstate;
+    if (!full) {
+      delta = doc.createNestedObject("d");
+      delta["rev"] = wsStateRev;
+      dstate = delta.createNestedObject("state");
+    }
+    if (wsDiffState(state, dstate)) wsStateRev++;
+    if (!delta.isNull()) delta["rev"] = wsStateRev;
+    if (full && !client) wsLastFullState = millis();
   }
+  if (wsDeltaClients) msg["rev"] = wsStateRev;
 
-  buffer->lock();
-  serializeJson(doc, (char *)buffer->get(), len);
+  if (full || ws.count() > wsDeltaClients) {
+    JsonObject info = msg.createNestedObject("info");
+    serializeInfo(info);
 
-  DEBUG_PRINT(F("Sending WS data "));
-  if (client) {
-    client->text(buffer);
-    DEBUG_PRINTLN(F("to a single client."));
-  } else {
-    ws.textAll(buffer);
-    DEBUG_PRINTLN(F("to multiple clients."));
+    buffer = wsJsonBuffer(msg);
+    if (!buffer) {
+      releaseJSONBufferLock();
+      return;
+    }
+    DEBUG_PRINT(F("Sending WS data "));
+    if (client) {
+      client->text(buffer);
+      DEBUG_PRINTLN(F("to a single client."));
+    } else if (full) {
+      ws.textAll(buffer);
+      DEBUG_PRINTLN(F("to multiple clients."));
+    } else {
+      for (size_t i = 0; i < DEFAULT_MAX_WS_CLIENTS; i++) {
+        if (!wsClients[i].id || wsClients[i].delta) continue;
+        AsyncWebSocketClient * wsc = ws.client(wsClients[i].id);
+        if (wsc) wsc->text(buffer);
+      }
+      DEBUG_PRINTLN(F("to full update clients."));
+    }
+    buffer->unlock();
+  }
+
+  if (!delta.isNull()) {
+    buffer = wsJsonBuffer(delta);
+    if (!buffer) {
+      releaseJSONBufferLock();
+      return;
+    }
+    for (size_t i = 0; i < DEFAULT_MAX_WS_CLIENTS; i++) {
+      if (!wsClients[i].id || !wsClients[i].delta) continue;
+      AsyncWebSocketClient * wsc = ws.client(wsClients[i].id);
+      if (wsc) wsc->text(buffer);
+    }
+    DEBUG_PRINTLN(F("Sending WS delta to delta clients."));
+    buffer->unlock();
   }
-  buffer->unlock();
   ws._cleanBuffers();
 
   releaseJSONBufferLock();
@@ -158,11 +463,6 @@ bool sendLiveLedsWs(uint32_t wsClient)
   if (!wsc || wsc->queueLength() > 0) return false; //only send if queue free
 
   size_t used = strip.getLengthTotal();
-#ifdef ESP8266
-  const size_t MAX_LIVE_LEDS_WS = 256U;
-#else
-  const size_t MAX_LIVE_LEDS_WS = 1024U;
-#endif
   size_t n = ((used -1)/MAX_LIVE_LEDS_WS) +1; //only serve every n'th LED if count over MAX_LIVE_LEDS_WS
   size_t pos = (strip.isMatrix ? 4 : 2);  // start of data
   size_t bufSize = pos + (used/n)*3;
@@ -212,8 +512,213 @@ bool sendLiveLedsWs(uint32_t wsClient)
   return true;
 }
 
+/*
+ * Live view v3: area averaged, frame differenced binary stream
+ * requested with {"lv":{"w":<width>,"h":<height>,"fps":<fps>}} (all optional)
+ * message: 'L', 3, flags, seq, w (16 bit LE), h (16 bit LE), payload
+ * flags bit 0 clear: key frame, payload is w*h RGB triplets
+ * flags bit 0 set:   delta frame, payload is RLE of (frame XOR previous frame):
+ *                    control byte c < 128 is followed by c+1 literal bytes, c >= 128 means (c&0x7F)+1 zero bytes
+ * Source pixels are sampled in chunks over several loop iterations so large setups do not stall the loop.
+ */
+static struct {
+  uint16_t w, h;              // output resolution
+  uint16_t srcW, srcH;        // source dimensions
+  uint16_t reqW, reqH;        // client requested resolution (0 = max.)
+  uint16_t interval;          // ms between frames, 0 if v3 live view is not active
+  unsigned long lastFrame;
+  uint16_t x, y;              // next source pixel to sample
+  uint8_t  seq;
+  uint8_t  sinceKey;          // frames since last key frame
+  bool     sampling;
+  bool     ready;             // a complete frame is waiting to be sent
+  uint32_t *acc;              // R,G,B sums per output pixel, reused as RLE scratch buffer
+  uint16_t *cnt;              // source pixels per output pixel
+  uint8_t  *prev;             // last frame sent
+  uint8_t  *cur;              // frame being sent
+} wsLive = {};
+
+static void freeLiveLedsWs()
+{
+  delete[] wsLive.acc;  wsLive.acc  = nullptr;
+  delete[] wsLive.cnt;  wsLive.cnt  = nullptr;
+  delete[] wsLive.prev; wsLive.prev = nullptr;
+  delete[] wsLive.cur;  wsLive.cur  = nullptr;
+  wsLive.w = wsLive.h = 0;
+  wsLive.sampling = wsLive.ready = false;
+}
+
+static void stopLiveLedsWs()
+{
+  freeLiveLedsWs();
+  wsLive.interval = 0;
+}
+
+static void setupLiveLedsWs(JsonObject req)
+{
+  freeLiveLedsWs();
+  wsLive.reqW = req["w"] | 0;
+  wsLive.reqH = req["h"] | 0;
+  uint8_t fps = constrain((int)(req["fps"] | (1000/WS_LIVE_INTERVAL)), 1, 1000/WS_LIVE_INTERVAL);
+  wsLive.interval = 1000 / fps;
+  wsLive.srcW = wsLive.srcH = 0; // force (re)allocation on first frame
+}
+
+// (re)computes output geometry and allocates buffers if source dimensions changed
+static bool configureLiveLedsWs()
+{
+  uint16_t srcW = strip.getLengthTotal();
+  uint16_t srcH = 1;
+  #ifndef WLED_DISABLE_2D
+  if (strip.isMatrix) {
+    srcW = Segment::maxWidth;
+    srcH = Segment::maxHeight;
+  }
+  #endif
+  if (srcW == wsLive.srcW && srcH == wsLive.srcH && wsLive.acc) return true;
+
+  freeLiveLedsWs();
+  wsLive.srcW = srcW;
+  wsLive.srcH = srcH;
+  uint16_t w = wsLive.reqW ? min(wsLive.reqW, srcW) : srcW;
+  uint16_t h = wsLive.reqH ? min(wsLive.reqH, srcH) : srcH;
+  if (srcH == 1) w = min((size_t)w, (size_t)MAX_LIVE_LEDS_WS);
+  while ((size_t)w * h > MAX_LIVE_LEDS_WS) { w = (w+1)/2; h = (h+1)/2; }
+  if (!w || !h) return false;
+
+  size_t n = (size_t)w * h;
+  wsLive.acc  = new (std::nothrow) uint32_t[n*3];
+  wsLive.cnt  = new (std::nothrow) uint16_t[n];
+  wsLive.prev = new (std::nothrow) uint8_t[n*3];
+  wsLive.cur  = new (std::nothrow) uint8_t[n*3];
+  if (!wsLive.acc || !wsLive.cnt || !wsLive.prev || !wsLive.cur) {
+    freeLiveLedsWs();
+    return false;
+  }
+  wsLive.w = w;
+  wsLive.h = h;
+  wsLive.sinceKey = WS_LIVE_KEYFRAME; // next frame is a key frame
+  DEBUG_PRINTF("Live view %ux%u -> %ux%u\n", srcW, srcH, w, h);
+  return true;
+}
+
+// samples up to WS_LIVE_SAMPLE_CHUNK source pixels, returns true when the frame is complete
+static bool sampleLiveLedsWs()
+{
+  size_t n = (size_t)wsLive.w * wsLive.h;
+  if (!wsLive.sampling) {
+    memset(wsLive.acc, 0, n*3*sizeof(uint32_t));
+    memset(wsLive.cnt, 0, n*sizeof(uint16_t));
+    wsLive.x = wsLive.y = 0;
+    wsLive.sampling = true;
+  }
+
+  for (size_t i = 0; i < WS_LIVE_SAMPLE_CHUNK; i++) {
+    if (wsLive.y >= wsLive.srcH) break;
+    size_t o = (size_t)(wsLive.y * wsLive.h / wsLive.srcH) * wsLive.w + (wsLive.x * wsLive.w / wsLive.srcW);
+    uint32_t c = strip.getPixelColor(wsLive.y * wsLive.srcW + wsLive.x);
+    uint8_t w = W(c);
+    wsLive.acc[o*3  ] += qadd8(w, R(c)); // add white channel to RGB channels as a simple RGBW -> RGB map
+    wsLive.acc[o*3+1] += qadd8(w, G(c));
+    wsLive.acc[o*3+2] += qadd8(w, B(c));
+    wsLive.cnt[o]++;
+    if (++wsLive.x >= wsLive.srcW) { wsLive.x = 0; wsLive.y++; }
+  }
+  if (wsLive.y < wsLive.srcH) return false;
+
+  uint8_t bri = strip.getBrightness();
+  for (size_t o = 0; o < n; o++) {
+    uint16_t cnt = wsLive.cnt[o] ? wsLive.cnt[o] : 1;
+    wsLive.cur[o*3  ] = scale8(wsLive.acc[o*3  ] / cnt, bri);
+    wsLive.cur[o*3+1] = scale8(wsLive.acc[o*3+1] / cnt, bri);
+    wsLive.cur[o*3+2] = scale8(wsLive.acc[o*3+2] / cnt, bri);
+  }
+  wsLive.sampling = false;
+  return true;
+}
+
+// RLE encodes cur XOR prev into dst, returns encoded length or 0 if larger than maxLen
+static size_t encodeLiveDeltaWs(uint8_t *dst, size_t maxLen, size_t len, bool &changed)
+{
+  size_t out = 0;
+  changed = false;
+  size_t i = 0;
+  while (i < len) {
+    size_t run = 0;
+    while (i + run < len && run < 128 && wsLive.cur[i+run] == wsLive.prev[i+run]) run++;
+    if (run) {
+      if (out + 1 > maxLen) return 0;
+      dst[out++] = 0x80 | (run - 1);
+      i += run;
+      continue;
+    }
+    // literal run until two unchanged bytes in a row (a single one is cheaper to keep literal)
+    size_t lit = 0;
+    while (i + lit < len && lit < 128) {
+      if (wsLive.cur[i+lit] == wsLive.prev[i+lit] && i+lit+1 < len && wsLive.cur[i+lit+1] == wsLive.prev[i+lit+1]) break;
+      lit++;
+    }
+    if (out + 1 + lit > maxLen) return 0;
+    changed = true;
+    dst[out++] = lit - 1;
+    for (size_t j = 0; j < lit; j++, i++) dst[out++] = wsLive.cur[i] ^ wsLive.prev[i];
+  }
+  return out;
+}
+
+static bool sendLiveLedsAreaWs(AsyncWebSocketClient * wsc)
+{
+  size_t len = (size_t)wsLive.w * wsLive.h * 3;
+  const size_t hdr = 8;
+  bool key = wsLive.sinceKey >= WS_LIVE_KEYFRAME;
+  size_t payload = len;
+  uint8_t *scratch = (uint8_t*)wsLive.acc; // accumulator is free until the next frame is sampled
+  if (!key) {
+    bool changed;
+    payload = encodeLiveDeltaWs(scratch, len, len, changed);
+    if (payload && !changed) return true; // nothing to send
+    if (!payload) {
+      key = true; // delta not smaller than key frame
+      payload = len;
+    }
+  }
+
+  AsyncWebSocketMessageBuffer * wsBuf = ws.makeBuffer(hdr + payload);
+  if (!wsBuf) return false; //out of memory
+  uint8_t* buffer = wsBuf->get();
+  buffer[0] = 'L';
+  buffer[1] = 3; //version
+  buffer[2] = key ? 0 : 1;
+  buffer[3] = wsLive.seq++;
+  buffer[4] = wsLive.w & 0xFF;
+  buffer[5] = wsLive.w >> 8;
+  buffer[6] = wsLive.h & 0xFF;
+  buffer[7] = wsLive.h >> 8;
+  memcpy(buffer + hdr, key ? wsLive.cur : scratch, payload);
+  wsc->binary(wsBuf);
+
+  memcpy(wsLive.prev, wsLive.cur, len);
+  wsLive.sinceKey = key ? 0 : wsLive.sinceKey + 1;
+  return true;
+}
+
+static void handleLiveLedsAreaWs()
+{
+  AsyncWebSocketClient * wsc = ws.client(wsLiveClientId);
+  if (!wsc) return;
+  if (!wsLive.sampling && !wsLive.ready) {
+    if (millis() - wsLive.lastFrame < wsLive.interval) return;
+    wsLive.lastFrame = millis();
+    if (!configureLiveLedsWs()) return;
+  }
+  if (!wsLive.ready) wsLive.ready = sampleLiveLedsWs();
+  if (!wsLive.ready || wsc->queueLength() > 0) return; //only send if queue free, retry on next loop
+  if (sendLiveLedsAreaWs(wsc)) wsLive.ready = false;
+}
+
 void handleWs()
 {
+  if (wsLiveClientId && wsLive.interval) handleLiveLedsAreaWs();
   if (millis() - wsLastLiveTime > WS_LIVE_INTERVAL)
   {
     #ifdef ESP8266
@@ -222,7 +727,7 @@ void handleWs()
     ws.cleanupClients();
     #endif
     bool success = true;
-    if (wsLiveClientId) success = sendLiveLedsWs(wsLiveClientId);
+    if (wsLiveClientId && !wsLive.interval) success = sendLiveLedsWs(wsLiveClientId);
     wsLastLiveTime = millis();
     if (!success) wsLastLiveTime -= 20; //try again in 20ms if failed due to non-empty WS queue
   }
@@ -231,4 +736,5 @@ void handleWs()
 #else
 void handleWs() {}
 void sendDataWs(AsyncWebSocketClient * client) {}
+uint8_t applyWsJson(uint32_t id, JsonObject root) { return WS_RESPONSE_NONE; }
 #endif
\ No newline at end of file
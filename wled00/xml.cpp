@@ -356,10 +356,11 @@ void getSettingsJS(byte subPage, char* dest)
     sappend('v',SET_F("FR"),strip.getTargetFps());
     sappend('v',SET_F("AW"),Bus::getGlobalAWMode());
     sappend('c',SET_F("LD"),useGlobalLedBuffer);
+    sappend('c',SET_F("NS"),BusNetwork::getSyncOutput());
 
     for (uint8_t s=0; s < busses.getNumBusses(); s++) {
       Bus* bus = busses.getBus(s);
-      if (bus == nullptr) continue;
+      if (bus == nullptr || bus->getType() == TYPE_NET_MAP) continue; // network output map is not user configurable
       char lp[4] = "L0"; lp[2] = 48+s; lp[3] = 0; //ascii 0-9 //strip data pin
       char lc[4] = "LC"; lc[2] = 48+s; lc[3] = 0; //strip length
       char co[4] = "CO"; co[2] = 48+s; co[3] = 0; //strip color order
@@ -371,6 +372,8 @@ void getSettingsJS(byte subPage, char* dest)
       char aw[4] = "AW"; aw[2] = 48+s; aw[3] = 0; //auto white mode
       char wo[4] = "WO"; wo[2] = 48+s; wo[3] = 0; //swap channels
       char sp[4] = "SP"; sp[2] = 48+s; sp[3] = 0; //bus clock speed
+      char un[4] = "UN"; un[2] = 48+s; un[3] = 0; //network bus universe
+      char uc[4] = "UC"; uc[2] = 48+s; uc[3] = 0; //network bus start channel
       oappend(SET_F("addLEDs(1);"));
       uint8_t pins[5];
       uint8_t nPins = bus->getPins(pins);
@@ -408,6 +411,8 @@ void getSettingsJS(byte subPage, char* dest)
         }
       }
       sappend('v',sp,speed);
+      sappend('v',un,bus->getUniverse());
+      sappend('v',uc,bus->getStartChannel());
     }
     sappend('v',SET_F("MA"),strip.ablMilliampsMax);
     sappend('v',SET_F("LA"),strip.milliampsPerLed);
@@ -494,9 +499,15 @@ void getSettingsJS(byte subPage, char* dest)
     sappend('c',SET_F("SH"),notifyHue);
     sappend('c',SET_F("SM"),notifyMacro);
     sappend('v',SET_F("UR"),udpNumRetries);
+    sappend('c',SET_F("SV"),notifyDelta);
+    sappend('v',SET_F("UM0"),syncMulticastIP[0]);
+    sappend('v',SET_F("UM1"),syncMulticastIP[1]);
+    sappend('v',SET_F("UM2"),syncMulticastIP[2]);
+    sappend('v',SET_F("UM3"),syncMulticastIP[3]);
 
     sappend('c',SET_F("NL"),nodeListEnabled);
     sappend('c',SET_F("NB"),nodeBroadcastEnabled);
+    sappend('c',SET_F("TS"),timeSyncEnabled);
 
     sappend('c',SET_F("RD"),receiveDirect);
     sappend('c',SET_F("MO"),useMainSegmentOnly);
@@ -512,6 +523,8 @@ void getSettingsJS(byte subPage, char* dest)
     sappend('c',SET_F("FB"),arlsForceMaxBri);
     sappend('c',SET_F("RG"),arlsDisableGammaCorrection);
     sappend('v',SET_F("WO"),arlsOffset);
+    sappend('v',SET_F("JB"),realtimeJitterMs);
+    sappend('c',SET_F("JI"),realtimeInterpolate);
     sappend('c',SET_F("AL"),alexaEnabled);
     sappends('s',SET_F("AI"),alexaInvocationName);
     sappend('c',SET_F("SA"),notifyAlexa);